@@ -1,6 +1,7 @@
 #include "clip_command.h"
 #include "../utils/logger.h"
 #include "../utils/clip_algorithms.h"
+#include "../core/item_registry.h"
 #include <QApplication>
 
 ClipCommand::ClipCommand(QGraphicsScene* scene, 
@@ -25,6 +26,16 @@ ClipCommand::ClipCommand(QGraphicsScene* scene,
     }
 }
 
+ClipCommand::ClipCommand(QGraphicsScene* scene,
+                         GraphicItem* item,
+                         const QPainterPath& clipPath,
+                         const QPainterPath& resultPath)
+    : ClipCommand(scene, item, clipPath)
+{
+    m_resultPath = resultPath;
+    m_hasResult = true;
+}
+
 ClipCommand::~ClipCommand()
 {
     Logger::debug("ClipCommand: 销毁裁剪命令");
@@ -42,8 +53,13 @@ void ClipCommand::execute()
     // 调用图形项的裁剪方法
     bool clipResult = false;
     if (auto *graphicItem = dynamic_cast<GraphicItem*>(m_item)) {
-        // 直接调用图形项的clip方法，已经实现了自定义算法的支持
-        clipResult = graphicItem->clip(m_clipPath);
+        if (m_hasResult) {
+            // 批量裁剪时结果已在工作线程算好，直接应用
+            clipResult = graphicItem->applyClipResult(m_resultPath);
+        } else {
+            // 直接调用图形项的clip方法，已经实现了自定义算法的支持
+            clipResult = graphicItem->clip(m_clipPath);
+        }
     }
     
     if (!clipResult) {
@@ -67,7 +83,7 @@ void ClipCommand::undo()
     }
     
     // 检查图形项是否在场景中，避免操作已删除的项目
-    if (!m_item->scene() || m_item->scene() != m_scene) {
+    if (!ItemRegistry::isInScene(m_item, m_scene)) {
         Logger::warning("ClipCommand::undo: 图形项不在当前场景中，可能已被删除");
         m_executed = false;
         return;
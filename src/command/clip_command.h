@@ -26,6 +26,18 @@ public:
                GraphicItem* item,
                const QPainterPath& clipPath);
     
+    /**
+     * @brief 使用预先计算好的裁剪结果构造命令
+     * @param scene 场景指针
+     * @param item 要裁剪的图形项
+     * @param clipPath 裁剪路径
+     * @param resultPath 已算好的裁剪结果（场景坐标），执行和重做时直接应用
+     */
+    ClipCommand(QGraphicsScene* scene,
+               GraphicItem* item,
+               const QPainterPath& clipPath,
+               const QPainterPath& resultPath);
+    
     /**
      * @brief 析构函数
      */
@@ -58,6 +70,8 @@ private:
     GraphicItem* m_item;                 // 要裁剪的图形项
     QPainterPath m_clipPath;             // 裁剪路径
     bool m_executed = false;             // 命令是否已执行
+    QPainterPath m_resultPath;           // 预先计算的裁剪结果
+    bool m_hasResult = false;            // 是否使用预先计算的结果
     
     // 保存原始图形数据用于撤销
     std::vector<QPointF> m_originalPoints;
@@ -1,2 +1,13 @@
 #include "command.h"
-// 纯虚基类无需实现 
\ No newline at end of file
+#include <QSet>
+
+bool Command::sameItems(const QList<QGraphicsItem*>& a, const QList<QGraphicsItem*>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    if (a == b) {
+        return true;
+    }
+    return QSet<QGraphicsItem*>(a.begin(), a.end()) == QSet<QGraphicsItem*>(b.begin(), b.end());
+}
@@ -3,11 +3,23 @@
 
 #include <QString>
 #include <QDataStream>
+#include <QList>
 
 class GraphicManager;
+class QGraphicsItem;
 
 class Command {
 public:
+    // 合并编号：编号相同的命令才会尝试合并
+    enum MergeId {
+        NoMerge = -1,
+        MoveItemMerge = 1,      // 单个图形项的移动
+        MoveSelectionMerge,     // 选择区域的移动
+        StyleChangeMerge,       // 样式变更
+        RotateMerge,            // 旋转
+        ScaleMerge              // 缩放
+    };
+    
     virtual ~Command() = default;
     virtual void execute() = 0;
     virtual void undo() = 0;
@@ -17,6 +29,23 @@ public:
     
     // 获取命令类型，用于图标显示或分组
     virtual QString getType() const = 0;
+    
+    // 合并编号，NoMerge表示不参与合并
+    virtual int mergeId() const { return NoMerge; }
+    
+    /**
+     * @brief 把紧接着执行的同类命令并入本命令
+     * 
+     * 调用时两条命令都已执行，合并成功后other会被删除，
+     * 本命令的undo()需要撤销两者的效果，execute()需要重做两者的效果。
+     * @param other 后执行的命令，mergeId()与本命令相同
+     * @return 是否合并成功
+     */
+    virtual bool mergeWith(const Command* other) { Q_UNUSED(other); return false; }
+
+protected:
+    // 判断两组图形项是否相同（忽略顺序）
+    static bool sameItems(const QList<QGraphicsItem*>& a, const QList<QGraphicsItem*>& b);
 };
 
-#endif // COMMAND_H
\ No newline at end of file
+#endif // COMMAND_H
@@ -19,6 +19,7 @@ CommandManager::CommandManager()
 {
     Logger::info("CommandManager: 初始化");
     m_lastActionTimer.start();
+    m_mergeTimer.start();
 }
 
 CommandManager::~CommandManager()
@@ -71,6 +72,7 @@ void CommandManager::commitCommandGroup()
     
     m_undoStack.push(groupCommand);
     trimUndoStack();
+    m_mergeCandidate = nullptr;
     
     qDeleteAll(m_redoStack);
     m_redoStack.clear();
@@ -95,11 +97,20 @@ void CommandManager::executeCommand(Command* command)
         QWriteLocker locker(&m_lock);
         
         command->execute();
-        m_undoStack.push(command);
-        trimUndoStack();
         
-        qDeleteAll(m_redoStack);
-        m_redoStack.clear();
+        if (Command* merged = tryMerge(command)) {
+            delete command;
+            command = merged;
+        } else {
+            m_undoStack.push(command);
+            trimUndoStack();
+            
+            qDeleteAll(m_redoStack);
+            m_redoStack.clear();
+            
+            m_mergeCandidate = command;
+        }
+        m_mergeTimer.restart();
         
         Logger::debug(QString("CommandManager: 撤销栈大小: %1, 重做栈大小: %2")
                      .arg(m_undoStack.size())
@@ -109,6 +120,35 @@ void CommandManager::executeCommand(Command* command)
     emit commandExecuted(command);
 }
 
+Command* CommandManager::tryMerge(Command* command)
+{
+    // 分组中的命令由commitCommandGroup统一压栈，不参与合并
+    if (m_grouping || m_mergeInterval <= 0 || command->mergeId() == Command::NoMerge) {
+        return nullptr;
+    }
+    if (m_undoStack.isEmpty() || m_undoStack.top() != m_mergeCandidate || !m_redoStack.isEmpty()) {
+        return nullptr;
+    }
+    if (m_mergeTimer.elapsed() > m_mergeInterval) {
+        return nullptr;
+    }
+    
+    Command* top = m_undoStack.top();
+    if (top->mergeId() != command->mergeId() || !top->mergeWith(command)) {
+        return nullptr;
+    }
+    
+    Logger::debug(QString("CommandManager: 命令 '%1' 已合并到栈顶命令").arg(command->getDescription()));
+    return top;
+}
+
+void CommandManager::setMergeInterval(int milliseconds)
+{
+    QWriteLocker locker(&m_lock);
+    m_mergeInterval = milliseconds;
+    m_mergeCandidate = nullptr;
+}
+
 void CommandManager::undo()
 {
     if (m_lastActionTimer.elapsed() < m_debounceInterval) {
@@ -127,6 +167,7 @@ void CommandManager::undo()
         }
         
         m_lastActionTimer.restart();
+        m_mergeCandidate = nullptr;
         command = m_undoStack.pop();
         
         QString lastCmdDesc = command->getDescription();
@@ -164,6 +205,7 @@ void CommandManager::redo()
         }
         
         m_lastActionTimer.restart();
+        m_mergeCandidate = nullptr;
         command = m_redoStack.pop();
         command->execute();
         m_undoStack.push(command);
@@ -180,6 +222,7 @@ void CommandManager::clear()
         m_undoStack.clear();
         qDeleteAll(m_redoStack);
         m_redoStack.clear();
+        m_mergeCandidate = nullptr;
     }
     
     emit stackCleared();
@@ -219,6 +262,10 @@ void CommandManager::setMaxStackSize(int size)
 void CommandManager::trimUndoStack()
 {
     while (m_undoStack.size() > m_maxStackSize) {
-        delete m_undoStack.takeFirst();
+        Command* oldest = m_undoStack.takeFirst();
+        if (oldest == m_mergeCandidate) {
+            m_mergeCandidate = nullptr;
+        }
+        delete oldest;
     }
 } 
\ No newline at end of file
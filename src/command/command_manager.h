@@ -19,7 +19,7 @@ public:
 
     ~CommandManager();
     
-    // 执行命令并将其放入撤销栈
+    // 执行命令并将其放入撤销栈；与栈顶刚执行的同类命令在合并时间窗口内时合并为一条记录
     void executeCommand(Command* command);
     
     // 撤销最近的命令
@@ -42,6 +42,10 @@ public:
     // 设置最大堆栈大小
     void setMaxStackSize(int size);
     
+    // 命令合并的时间窗口（毫秒），0表示禁用合并
+    void setMergeInterval(int milliseconds);
+    int mergeInterval() const { return m_mergeInterval; }
+    
     // 命令分组控制 - 防止连续命令被合并
     void beginCommandGroup();
     void endCommandGroup();
@@ -86,6 +90,14 @@ private:
     QElapsedTimer m_lastActionTimer;
     const int m_debounceInterval = 100; // 毫秒
     
+    // 命令合并：只与最近一次执行并压栈的命令合并，撤销、重做等操作后重新开始
+    Command* m_mergeCandidate = nullptr;
+    QElapsedTimer m_mergeTimer;
+    int m_mergeInterval = 1000; // 毫秒
+    
+    // 尝试把刚执行的命令并入栈顶命令，成功时返回栈顶命令
+    Command* tryMerge(Command* command);
+    
     // 修剪堆栈大小
     void trimUndoStack();
 };
@@ -1,5 +1,6 @@
 #include "connection_command.h"
 #include "../core/connection_manager.h"
+#include "../core/item_registry.h"
 #include "../utils/logger.h"
 #include <QApplication>
 #include <QDataStream>
@@ -33,7 +34,8 @@ ConnectionCommand::~ConnectionCommand()
 
 void ConnectionCommand::execute()
 {
-    if (m_executed || !m_connectionManager || !m_fromItem || !m_toItem) {
+    if (m_executed || !m_connectionManager ||
+        !ItemRegistry::isAlive(m_fromItem) || !ItemRegistry::isAlive(m_toItem)) {
         Logger::warning("ConnectionCommand::execute: 命令已执行或参数无效");
         return;
     }
@@ -62,14 +64,8 @@ void ConnectionCommand::execute()
         return;
     }
     
-    QList<ConnectionManager::Connection> connections = m_connectionManager->getAllConnections();
-    for (const auto& conn : connections) {
-        if (conn.fromItem == m_fromItem && conn.fromPointIndex == m_fromPointIndex &&
-            conn.toItem == m_toItem && conn.toPointIndex == m_toPointIndex) {
-            m_connector = conn.connector;
-            break;
-        }
-    }
+    m_connector = m_connectionManager->findConnector(m_fromItem, m_fromPointIndex,
+                                                     m_toItem, m_toPointIndex);
     
     if (!m_connector) {
         Logger::error("ConnectionCommand::execute: 找不到创建的连接器");
@@ -90,7 +86,7 @@ void ConnectionCommand::undo()
         return;
     }
     
-    if (!m_fromItem || !m_toItem) {
+    if (!ItemRegistry::isAlive(m_fromItem) || !ItemRegistry::isAlive(m_toItem)) {
         Logger::warning("ConnectionCommand::undo: 连接的流程图元素无效");
         m_executed = false;
         return;
@@ -116,8 +112,8 @@ void ConnectionCommand::undo()
 
 QString ConnectionCommand::getDescription() const
 {
-    QString fromText = m_fromItem ? m_fromItem->getText() : "未知元素";
-    QString toText = m_toItem ? m_toItem->getText() : "未知元素";
+    QString fromText = ItemRegistry::isAlive(m_fromItem) ? m_fromItem->getText() : "未知元素";
+    QString toText = ItemRegistry::isAlive(m_toItem) ? m_toItem->getText() : "未知元素";
     if (fromText.length() > 20) {
         fromText = fromText.left(17) + "...";
     }
@@ -1,5 +1,6 @@
 #include "connection_delete_command.h"
 #include "../core/connection_manager.h"
+#include "../core/item_registry.h"
 #include "../utils/logger.h"
 #include <QApplication>
 
@@ -76,7 +77,8 @@ void ConnectionDeleteCommand::execute()
 
 void ConnectionDeleteCommand::undo()
 {
-    if (!m_executed || !m_connectionManager || !m_fromItem || !m_toItem) {
+    if (!m_executed || !m_connectionManager ||
+        !ItemRegistry::isAlive(m_fromItem) || !ItemRegistry::isAlive(m_toItem)) {
         Logger::debug("ConnectionDeleteCommand::undo: 命令未执行或参数无效");
         return;
     }
@@ -97,19 +99,13 @@ void ConnectionDeleteCommand::undo()
         }
         
         // 查找重新创建的连接器
-        QList<ConnectionManager::Connection> connections = m_connectionManager->getAllConnections();
-        for (const auto& conn : connections) {
-            if (conn.fromItem == m_fromItem && conn.fromPointIndex == m_fromPointIndex &&
-                conn.toItem == m_toItem && conn.toPointIndex == m_toPointIndex) {
-                m_connector = conn.connector;
-                
-                // 恢复连接器的视觉属性
-                if (m_connector) {
-                    m_connector->setPen(m_pen);
-                    m_connector->setBrush(m_brush);
-                }
-                break;
-            }
+        m_connector = m_connectionManager->findConnector(m_fromItem, m_fromPointIndex,
+                                                         m_toItem, m_toPointIndex);
+        
+        // 恢复连接器的视觉属性
+        if (m_connector) {
+            m_connector->setPen(m_pen);
+            m_connector->setBrush(m_brush);
         }
         
         if (!m_connector) {
@@ -133,8 +129,8 @@ void ConnectionDeleteCommand::undo()
 
 QString ConnectionDeleteCommand::getDescription() const
 {
-    QString fromText = m_fromItem ? m_fromItem->getText() : "未知元素";
-    QString toText = m_toItem ? m_toItem->getText() : "未知元素";
+    QString fromText = ItemRegistry::isAlive(m_fromItem) ? m_fromItem->getText() : "未知元素";
+    QString toText = ItemRegistry::isAlive(m_toItem) ? m_toItem->getText() : "未知元素";
     
     // 如果文本太长，截断显示
     if (fromText.length() > 20) {
@@ -157,18 +153,16 @@ void ConnectionDeleteCommand::saveConnectionInfo()
     if (!m_connectionManager || !m_connector) return;
     
     // 从连接管理器中查找对应的连接信息
-    QList<ConnectionManager::Connection> connections = m_connectionManager->getAllConnections();
-    for (const auto& conn : connections) {
-        if (conn.connector == m_connector) {
-            m_fromItem = conn.fromItem;
-            m_fromPointIndex = conn.fromPointIndex;
-            m_toItem = conn.toItem;
-            m_toPointIndex = conn.toPointIndex;
-            
-            Logger::debug(QString("ConnectionDeleteCommand::saveConnectionInfo: 保存连接信息 - 从点%1到点%2")
-                .arg(m_fromPointIndex).arg(m_toPointIndex));
-            return;
-        }
+    const ConnectionManager::Connection conn = m_connectionManager->connectionFor(m_connector);
+    if (conn.connector) {
+        m_fromItem = conn.fromItem;
+        m_fromPointIndex = conn.fromPointIndex;
+        m_toItem = conn.toItem;
+        m_toPointIndex = conn.toPointIndex;
+        
+        Logger::debug(QString("ConnectionDeleteCommand::saveConnectionInfo: 保存连接信息 - 从点%1到点%2")
+            .arg(m_fromPointIndex).arg(m_toPointIndex));
+        return;
     }
     
     Logger::warning("ConnectionDeleteCommand::saveConnectionInfo: 在连接管理器中找不到对应的连接信息");
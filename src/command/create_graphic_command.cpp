@@ -3,6 +3,7 @@
 #include "../utils/logger.h"
 #include "../core/graphics_item_factory.h"
 #include "../core/graphic_item.h"
+#include "../core/item_registry.h"
 #include <QGraphicsScene>
 #include <QApplication>
 #include <QTimer>
@@ -138,7 +139,7 @@ void CreateGraphicCommand::undo()
         return;
     }
     
-    if (!m_createdItem->scene() || m_createdItem->scene() != scene) {
+    if (!ItemRegistry::isInScene(m_createdItem, scene)) {
         Logger::warning("CreateGraphicCommand::undo: 图形项不在当前场景中，可能已被删除");
         m_executed = false;
         return;
@@ -2,16 +2,22 @@
 #include "../ui/draw_area.h"
 #include "../utils/logger.h"
 #include "../utils/graphics_utils.h"
+#include "../core/graphic_item.h"
+#include "../core/spatial_index.h"
 #include <QGraphicsScene>
+#include <QGraphicsPathItem>
+#include <QPainterPathStroker>
 #include <QPainter>
 #include <QImage>
 #include <QStack>
+#include <QSet>
 #include <QPoint>
 
-FillCommand::FillCommand(DrawArea* drawArea, const QPointF& position, const QColor& color)
+FillCommand::FillCommand(DrawArea* drawArea, const QPointF& position, const QColor& color, FillMode mode)
     : m_drawArea(drawArea),
       m_position(position),
-      m_color(color)
+      m_color(color),
+      m_mode(mode)
 {
     Logger::debug(QString("FillCommand: 创建填充命令 - 位置: (%1, %2), 颜色: %3")
         .arg(position.x()).arg(position.y())
@@ -20,7 +26,12 @@ FillCommand::FillCommand(DrawArea* drawArea, const QPointF& position, const QCol
 
 FillCommand::~FillCommand()
 {
-    // 注意：不删除fillItem，因为它属于场景
+    // 仍在场景中的填充项属于场景（场景清空时会被删除，不能再访问）；
+    // 已撤销的填充项由命令负责释放
+    if (m_ownsFillItem) {
+        delete m_fillItem;
+    }
+    m_fillItem = nullptr;
     Logger::debug("FillCommand: 销毁填充命令");
 }
 
@@ -30,8 +41,13 @@ void FillCommand::execute()
         return;
     }
     
-    // 执行填充操作
-    doFill();
+    // 重做时直接恢复之前的填充结果，无需重新计算
+    if (m_fillItem) {
+        m_drawArea->scene()->addItem(m_fillItem);
+        m_ownsFillItem = false;
+    } else {
+        doFill();
+    }
     
     m_executed = true;
     Logger::info(QString("FillCommand: 执行填充命令 - 填充了 %1 个像素")
@@ -46,12 +62,148 @@ void FillCommand::undo()
     
     // 从场景中移除填充项
     m_drawArea->scene()->removeItem(m_fillItem);
+    m_ownsFillItem = true;
     m_executed = false;
     
     Logger::info("FillCommand: 撤销填充命令");
 }
 
 void FillCommand::doFill()
+{
+    // 位图结果已在别处计算好（异步填充），直接加入场景并释放中间图像
+    if (m_hasRasterResult) {
+        applyRasterResult(m_rasterResult);
+        m_rasterResult = RasterResult();
+        m_hasRasterResult = false;
+        return;
+    }
+    
+    // 矢量填充无法确定闭合区域时回退到位图填充
+    if (m_mode == VectorFill && doVectorFill()) {
+        return;
+    }
+    doRasterFill();
+}
+
+QPainterPath FillCommand::closedOutlineOf(QGraphicsItem* item, bool* isOpenPath)
+{
+    if (isOpenPath) {
+        *isOpenPath = false;
+    }
+    
+    GraphicItem* graphicItem = dynamic_cast<GraphicItem*>(item);
+    if (!graphicItem || !graphicItem->isVisible()) {
+        return QPainterPath();
+    }
+    
+    // 直线、曲线和连接线没有内部区域
+    switch (graphicItem->getGraphicType()) {
+        case GraphicItem::LINE:
+        case GraphicItem::BEZIER:
+        case GraphicItem::FLOWCHART_CONNECTOR:
+            if (isOpenPath) {
+                *isOpenPath = true;
+            }
+            return QPainterPath();
+        default:
+            break;
+    }
+    
+    QPainterPath outline = graphicItem->toPath();
+    if (outline.isEmpty()) {
+        return QPainterPath();
+    }
+    outline.setFillRule(Qt::WindingFill);
+    return graphicItem->sceneTransform().map(outline);
+}
+
+QPainterPath FillCommand::computeVectorRegion(DrawArea* drawArea, const QPointF& position)
+{
+    if (!drawArea) {
+        return QPainterPath();
+    }
+    SpatialIndex* index = drawArea->getSpatialIndex();
+    if (!drawArea->scene() || !index) {
+        return QPainterPath();
+    }
+    
+    // 外边界：所有包含填充点的闭合轮廓的交集（重叠图形的边都会限制填充区域）
+    QPainterPath region;
+    QSet<QGraphicsItem*> boundaryItems;
+    for (QGraphicsItem* item : index->items(QRectF(position, QSizeF(0, 0)))) {
+        QPainterPath outline = closedOutlineOf(item);
+        if (outline.isEmpty() || !outline.contains(position)) {
+            continue;
+        }
+        region = boundaryItems.isEmpty() ? outline : region.intersected(outline);
+        boundaryItems.insert(item);
+    }
+    
+    if (boundaryItems.isEmpty()) {
+        Logger::debug("FillCommand::computeVectorRegion: 填充点不在任何闭合图形内，回退到位图填充");
+        return QPainterPath();
+    }
+    
+    // 扣除区域内不包含填充点的其他闭合图形
+    const QRectF regionBounds = region.boundingRect();
+    int obstacleCount = 0;
+    for (QGraphicsItem* item : index->items(regionBounds)) {
+        if (boundaryItems.contains(item)) {
+            continue;
+        }
+        
+        bool isOpenPath = false;
+        QPainterPath outline = closedOutlineOf(item, &isOpenPath);
+        
+        // 穿过区域的开放路径会把区域切分开，矢量方式无法精确处理
+        if (isOpenPath) {
+            const QPainterPath stroke = item->sceneTransform().map(item->shape());
+            if (stroke.intersects(region)) {
+                Logger::debug("FillCommand::computeVectorRegion: 区域内有开放路径，回退到位图填充");
+                return QPainterPath();
+            }
+            continue;
+        }
+        
+        if (outline.isEmpty() || outline.contains(position) || !outline.intersects(region)) {
+            continue;
+        }
+        region = region.subtracted(outline);
+        ++obstacleCount;
+    }
+    
+    if (region.isEmpty() || !region.contains(position)) {
+        return QPainterPath();
+    }
+    
+    Logger::debug(QString("FillCommand::computeVectorRegion: 边界区域 %1x%2（%3 个边界图形），扣除 %4 个图形")
+                  .arg(regionBounds.width()).arg(regionBounds.height())
+                  .arg(boundaryItems.size()).arg(obstacleCount));
+    return region.simplified();
+}
+
+bool FillCommand::doVectorFill()
+{
+    QPainterPath region = m_vectorRegion.isEmpty()
+        ? computeVectorRegion(m_drawArea, m_position)
+        : m_vectorRegion;
+    if (region.isEmpty()) {
+        return false;
+    }
+    
+    // 创建与分辨率无关的矢量填充项
+    QGraphicsPathItem* pathItem = new QGraphicsPathItem(region);
+    pathItem->setBrush(m_color);
+    pathItem->setPen(Qt::NoPen);
+    pathItem->setZValue(-1);  // 置于图形下方
+    m_drawArea->scene()->addItem(pathItem);
+    m_fillItem = pathItem;
+    
+    Logger::debug("FillCommand::doVectorFill: 矢量填充完成");
+    return true;
+}
+
+void FillCommand::doRasterFill()
 {
     // 获取场景矩形
     QRectF sceneRect = m_drawArea->scene()->sceneRect();
@@ -59,49 +211,77 @@ void FillCommand::doFill()
     // 使用GraphicsUtils渲染场景到图像，禁用抗锯齿以获得更清晰的边界
     QImage image = GraphicsUtils::renderSceneToImage(m_drawArea->scene(), true);
     
+    applyRasterResult(computeRasterFill(image, sceneRect, m_position, m_color));
+}
+
+void FillCommand::setRasterResult(const RasterResult& result)
+{
+    m_rasterResult = result;
+    m_hasRasterResult = true;
+}
+
+FillCommand::RasterResult FillCommand::computeRasterFill(const QImage& sceneImage, const QRectF& sceneRect,
+                                                         const QPointF& position, const QColor& color,
+                                                         const std::atomic<bool>* cancelFlag)
+{
+    RasterResult result;
+    result.origin = sceneRect.topLeft();
+    
     // 将场景坐标转换为图像坐标
-    QPoint imagePoint = GraphicsUtils::sceneToImageCoordinates(m_position, sceneRect);
+    QPoint imagePoint = GraphicsUtils::sceneToImageCoordinates(position, sceneRect);
     
     // 检查图像坐标是否在有效范围内
-    if (!GraphicsUtils::isPointInImageBounds(imagePoint, image.width(), image.height())) {
+    if (!GraphicsUtils::isPointInImageBounds(imagePoint, sceneImage.width(), sceneImage.height())) {
         Logger::debug("FillCommand: 填充点不在有效图像范围内");
-        return;
+        return result;
     }
     
     // 获取目标颜色（种子点的颜色）
-    QColor targetColor = image.pixelColor(imagePoint);
+    QColor targetColor = sceneImage.pixelColor(imagePoint);
     
     // 如果目标颜色与填充颜色相同，则无需填充
-    if (targetColor == m_color) {
+    if (targetColor == color) {
         Logger::debug("FillCommand: 目标颜色与填充颜色相同，无需填充");
-        return;
+        return result;
     }
     
     // 创建一个副本用于填充，保留原始图像
-    QImage fillImage = image;
+    QImage fillImage = sceneImage;
     
     // 使用GraphicsUtils中的填充方法执行填充算法
-    m_filledPixelsCount = GraphicsUtils::fillImageRegion(fillImage, imagePoint, targetColor, m_color);
+    QRect bounds;
+    const int filled = GraphicsUtils::fillImageRegion(fillImage, imagePoint, targetColor, color, cancelFlag, &bounds);
+    if (filled <= 0 || (cancelFlag && cancelFlag->load())) {
+        return result;
+    }
     
-    if (m_filledPixelsCount > 0) {
-        // 使用GraphicsUtils创建填充结果图层
-        QImage resultImage = GraphicsUtils::createFillResultLayer(image, fillImage, m_color);
-        
-        // 创建填充结果的图像项
-        QPixmap fillResult = QPixmap::fromImage(resultImage);
-        m_fillItem = new QGraphicsPixmapItem(fillResult);
-        m_fillItem->setPos(sceneRect.topLeft());  // 与场景左上角对齐
-        
-        // 确保填充操作位于合适的Z轴位置
-        m_fillItem->setZValue(-1);  // 置于图形下方
-        
-        // 添加到场景
-        m_drawArea->scene()->addItem(m_fillItem);
-        
-        Logger::debug(QString("FillCommand: 填充完成，填充了 %1 个像素").arg(m_filledPixelsCount));
-    } else {
+    // 只保留填充包围盒内的行程编码掩码，不再保存覆盖整个场景的图层
+    result.mask = FillMaskItem::encode(sceneImage, fillImage, bounds);
+    result.origin = sceneRect.topLeft() + QPointF(bounds.topLeft());
+    result.filledPixels = filled;
+    return result;
+}
+
+void FillCommand::applyRasterResult(const RasterResult& result)
+{
+    m_filledPixelsCount = result.filledPixels;
+    if (m_filledPixelsCount <= 0 || result.mask.isEmpty()) {
         Logger::debug("FillCommand: 未填充任何像素");
+        return;
     }
+    
+    // 创建填充结果图元，可见部分在绘制时才栅格化
+    FillMaskItem* maskItem = new FillMaskItem(result.mask, m_color);
+    maskItem->setPos(result.origin);  // 与填充包围盒左上角对齐
+    
+    // 确保填充操作位于合适的Z轴位置
+    maskItem->setZValue(-1);  // 置于图形下方
+    m_fillItem = maskItem;
+    
+    // 添加到场景
+    m_drawArea->scene()->addItem(m_fillItem);
+    
+    Logger::debug(QString("FillCommand: 填充完成，填充了 %1 个像素").arg(m_filledPixelsCount));
 }
 
 QString FillCommand::getDescription() const
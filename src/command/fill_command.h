@@ -5,6 +5,11 @@
 #include <QPointF>
 #include <QColor>
 #include <QGraphicsPixmapItem>
+#include <QPainterPath>
+#include <QImage>
+#include <QRectF>
+#include <atomic>
+#include "../core/fill_mask_item.h"
 
 class DrawArea;
 
@@ -15,13 +20,32 @@ class DrawArea;
  */
 class FillCommand : public Command {
 public:
+    /**
+     * @brief 填充模式
+     */
+    enum FillMode {
+        RasterFill,  // 位图填充：渲染场景后对像素做洪水填充
+        VectorFill   // 矢量填充：由附近图形的轮廓计算闭合区域，失败时回退到位图填充
+    };
+    
+    /**
+     * @brief 位图填充的计算结果
+     */
+    struct RasterResult {
+        FillMaskItem::Mask mask;  // 裁剪到填充包围盒的行程编码掩码
+        QPointF origin;           // 掩码左上角对应的场景坐标
+        int filledPixels = 0;   // 填充的像素数量
+    };
+    
     /**
      * @brief 构造函数
      * @param drawArea 绘图区域
      * @param position 填充的位置
      * @param color 填充的颜色
+     * @param mode 填充模式
      */
-    FillCommand(DrawArea* drawArea, const QPointF& position, const QColor& color);
+    FillCommand(DrawArea* drawArea, const QPointF& position, const QColor& color,
+                FillMode mode = VectorFill);
     
     /**
      * @brief 析构函数
@@ -55,16 +79,61 @@ public:
      */
     void setFilledPixelsCount(int count) { m_filledPixelsCount = count; }
     
+    /**
+     * @brief 设置预先计算好的矢量填充区域，执行时不再重新计算
+     */
+    void setVectorRegion(const QPainterPath& region) { m_vectorRegion = region; }
+    
+    /**
+     * @brief 设置预先计算好的位图填充结果（如在工作线程中计算），执行时不再重新渲染场景
+     */
+    void setRasterResult(const RasterResult& result);
+    
+    /**
+     * @brief 计算矢量填充区域（必须在GUI线程调用）
+     * @return 包含填充点的闭合区域；无法用矢量方式确定时返回空路径
+     */
+    static QPainterPath computeVectorRegion(DrawArea* drawArea, const QPointF& position);
+    
+    /**
+     * @brief 对场景快照执行位图填充，不访问场景，可在工作线程中调用
+     * @param sceneImage 场景渲染结果
+     * @param sceneRect 快照对应的场景矩形
+     * @param position 填充点（场景坐标）
+     * @param color 填充颜色
+     * @param cancelFlag 取消标志，置位后尽快返回空结果
+     */
+    static RasterResult computeRasterFill(const QImage& sceneImage, const QRectF& sceneRect,
+                                          const QPointF& position, const QColor& color,
+                                          const std::atomic<bool>* cancelFlag = nullptr);
+    
 private:
     DrawArea* m_drawArea;
     QPointF m_position;
     QColor m_color;
-    QGraphicsPixmapItem* m_fillItem = nullptr;
+    FillMode m_mode;
+    QGraphicsItem* m_fillItem = nullptr;
+    bool m_ownsFillItem = false;      // 填充项已从场景移除，由命令负责释放
     int m_filledPixelsCount = 0;
     bool m_executed = false;
+    QPainterPath m_vectorRegion;      // 预先计算的矢量区域
+    RasterResult m_rasterResult;      // 预先计算的位图结果
+    bool m_hasRasterResult = false;
     
     // 执行实际的填充算法
     void doFill();
+    
+    // 矢量填充：成功创建填充区域时返回true
+    bool doVectorFill();
+    
+    // 位图填充
+    void doRasterFill();
+    
+    // 将位图填充结果作为掩码图元加入场景
+    void applyRasterResult(const RasterResult& result);
+    
+    // 获取图形在场景坐标中的闭合轮廓，开放路径（直线、曲线、连接线）返回空路径
+    static QPainterPath closedOutlineOf(QGraphicsItem* item, bool* isOpenPath = nullptr);
 };
 
 #endif // FILL_COMMAND_H 
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "layout_command.h"
+#include "../core/connection_manager.h"
+#include "../core/flowchart_base_item.h"
+#include "../core/flowchart_connector_item.h"
+#include "../core/item_registry.h"
+#include "../utils/logger.h"
+#include <QElapsedTimer>
+#include <QHash>
+
+LayoutCommand::LayoutCommand(ConnectionManager* connectionManager, const QList<FlowchartBaseItem*>& items,
+                             const QList<QPointF>& oldPositions, const QList<QPointF>& newPositions)
+    : m_connectionManager(connectionManager)
+    , m_items(items)
+    , m_oldPositions(oldPositions)
+    , m_newPositions(newPositions)
+{
+}
+
+LayoutCommand* LayoutCommand::createLayeredLayout(ConnectionManager* connectionManager,
+                                                  const QList<FlowchartBaseItem*>& items,
+                                                  const LayeredLayout::Options& options)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // 收集节点（连接器本身不参与布局）
+    QList<FlowchartBaseItem*> nodes;
+    QHash<FlowchartBaseItem*, int> nodeIndex;
+    std::vector<QSizeF> sizes;
+    QRectF originalBounds;
+    for (FlowchartBaseItem* item : items) {
+        if (!ItemRegistry::isAlive(item) || dynamic_cast<FlowchartConnectorItem*>(item) || nodeIndex.contains(item)) {
+            continue;
+        }
+        const QRectF bounds = item->sceneBoundingRect();
+        nodeIndex.insert(item, nodes.size());
+        nodes.append(item);
+        sizes.push_back(bounds.size());
+        originalBounds = originalBounds.united(bounds);
+    }
+    if (nodes.size() < 2) {
+        return nullptr;
+    }
+
+    // 只保留两端都参与布局的连接
+    std::vector<std::pair<int, int>> edges;
+    if (connectionManager) {
+        const QList<ConnectionManager::Connection> connections = connectionManager->getAllConnections();
+        edges.reserve(connections.size());
+        for (const ConnectionManager::Connection& connection : connections) {
+            auto from = nodeIndex.constFind(connection.fromItem);
+            auto to = nodeIndex.constFind(connection.toItem);
+            if (from != nodeIndex.constEnd() && to != nodeIndex.constEnd()) {
+                edges.push_back({from.value(), to.value()});
+            }
+        }
+    }
+
+    const LayeredLayout::Result layout = LayeredLayout::compute(sizes, edges, options);
+
+    // 布局结果的左上角对齐原来元素范围的左上角，按中心的偏移换算成元素位置
+    QList<QPointF> oldPositions;
+    QList<QPointF> newPositions;
+    oldPositions.reserve(nodes.size());
+    newPositions.reserve(nodes.size());
+    for (int i = 0; i < nodes.size(); ++i) {
+        FlowchartBaseItem* item = nodes[i];
+        const QPointF target = originalBounds.topLeft() + layout.centers[i];
+        oldPositions.append(item->pos());
+        newPositions.append(item->pos() + target - item->sceneBoundingRect().center());
+    }
+
+    Logger::info(QString("LayoutCommand: 分层布局 %1 个元素、%2 条连接，%3 层，%4 个虚拟节点，%5 处交叉，反转 %6 条边，耗时 %7 ms")
+                 .arg(nodes.size()).arg(edges.size()).arg(layout.layerCount).arg(layout.dummyNodes)
+                 .arg(layout.crossings).arg(layout.reversedEdges).arg(timer.elapsed()));
+
+    return new LayoutCommand(connectionManager, nodes, oldPositions, newPositions);
+}
+
+void LayoutCommand::execute()
+{
+    if (m_executed) {
+        return;
+    }
+    applyPositions(m_newPositions);
+    m_executed = true;
+}
+
+void LayoutCommand::undo()
+{
+    if (!m_executed) {
+        return;
+    }
+    applyPositions(m_oldPositions);
+    m_executed = false;
+}
+
+QString LayoutCommand::getDescription() const
+{
+    return QString("自动布局 %1 个元素").arg(m_items.size());
+}
+
+QString LayoutCommand::getType() const
+{
+    return "layout";
+}
+
+void LayoutCommand::applyPositions(const QList<QPointF>& positions)
+{
+    for (int i = 0; i < m_items.size(); ++i) {
+        FlowchartBaseItem* item = m_items[i];
+        if (!ItemRegistry::isAlive(item)) {
+            continue;
+        }
+        item->setPos(positions[i]);
+        
+        // 连接器在下一帧统一重建，每条只重建一次
+        if (m_connectionManager) {
+            m_connectionManager->markItemDirty(item);
+        }
+    }
+}
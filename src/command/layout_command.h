@@ -0,0 +1,52 @@
+#ifndef LAYOUT_COMMAND_H
+#define LAYOUT_COMMAND_H
+
+#include "command.h"
+#include "../utils/layered_layout.h"
+#include <QList>
+#include <QPointF>
+
+class ConnectionManager;
+class FlowchartBaseItem;
+
+/**
+ * @brief 自动布局命令 - 一次移动多个流程图元素，作为一个撤销步骤
+ *
+ * 创建时计算好每个元素的新旧位置，execute/undo只做位置切换，
+ * 并通知连接管理器在下一帧统一重建相关连接器。
+ */
+class LayoutCommand : public Command {
+public:
+    /**
+     * @brief 按连接关系对流程图元素做分层布局
+     * @param connectionManager 提供元素之间的连接，布局后刷新连接器
+     * @param items 参与布局的元素，连接器会被忽略
+     * @param options 布局参数
+     * @return 布局命令；可布局的元素少于两个时返回nullptr
+     */
+    static LayoutCommand* createLayeredLayout(ConnectionManager* connectionManager,
+                                              const QList<FlowchartBaseItem*>& items,
+                                              const LayeredLayout::Options& options = LayeredLayout::Options());
+
+    ~LayoutCommand() override = default;
+
+    void execute() override;
+    void undo() override;
+    QString getDescription() const override;
+    QString getType() const override;
+
+private:
+    LayoutCommand(ConnectionManager* connectionManager, const QList<FlowchartBaseItem*>& items,
+                  const QList<QPointF>& oldPositions, const QList<QPointF>& newPositions);
+
+    // 设置元素位置，跳过已销毁的元素
+    void applyPositions(const QList<QPointF>& positions);
+
+    ConnectionManager* m_connectionManager;
+    QList<FlowchartBaseItem*> m_items;
+    QList<QPointF> m_oldPositions;
+    QList<QPointF> m_newPositions;
+    bool m_executed = false;
+};
+
+#endif // LAYOUT_COMMAND_H
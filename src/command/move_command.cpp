@@ -23,6 +23,15 @@ QString MoveCommand::getDescription() const {
             .arg(m_offset.x()).arg(m_offset.y());
 }
 
+bool MoveCommand::mergeWith(const Command* other) {
+    const MoveCommand* move = static_cast<const MoveCommand*>(other);
+    if (!m_graphic || move->m_graphic != m_graphic) {
+        return false;
+    }
+    m_offset += move->m_offset;
+    return true;
+}
+
 QString MoveCommand::getType() const {
     return "transform";
 }
\ No newline at end of file
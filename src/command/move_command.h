@@ -14,6 +14,10 @@ public:
     
     QString getDescription() const override;
     QString getType() const override;
+    
+    // 同一图形项的连续移动合并为一次
+    int mergeId() const override { return MoveItemMerge; }
+    bool mergeWith(const Command* other) override;
 
 private:
     GraphicItem* m_graphic;
@@ -29,6 +29,7 @@ void SelectionCommand::execute()
             for (QGraphicsItem* item : m_items) {
                 item->moveBy(m_offset.x(), m_offset.y());
             }
+            markConnectionsDirty();
             break;
             
         case DeleteSelection:
@@ -77,6 +78,7 @@ void SelectionCommand::undo()
                         Logger::warning("SelectionCommand::undo: 项目不在当前场景中，无法移动");
                     }
                 }
+                markConnectionsDirty();
                 break;
                 
             case DeleteSelection:
@@ -129,6 +131,22 @@ QString SelectionCommand::getType() const
     }
 }
 
+int SelectionCommand::mergeId() const
+{
+    return m_type == MoveSelection ? MoveSelectionMerge : NoMerge;
+}
+
+bool SelectionCommand::mergeWith(const Command* other)
+{
+    const SelectionCommand* command = static_cast<const SelectionCommand*>(other);
+    if (command->m_type != MoveSelection || command->m_drawArea != m_drawArea ||
+        !sameItems(command->m_items, m_items)) {
+        return false;
+    }
+    m_offset += command->m_offset;
+    return true;
+}
+
 void SelectionCommand::setMoveInfo(const QList<QGraphicsItem*>& items, const QPointF& offset)
 {
     m_items = items;
@@ -141,6 +159,21 @@ void SelectionCommand::setDeleteInfo(const QList<QGraphicsItem*>& items)
 }
 
 
+void SelectionCommand::markConnectionsDirty()
+{
+    ConnectionManager* connectionManager = m_drawArea ? m_drawArea->getConnectionManager() : nullptr;
+    if (!connectionManager) {
+        return;
+    }
+    
+    // 连接线由ConnectionManager在下一帧批量重建
+    for (QGraphicsItem* item : m_items) {
+        if (FlowchartBaseItem* flowchartItem = dynamic_cast<FlowchartBaseItem*>(item)) {
+            connectionManager->markItemDirty(flowchartItem);
+        }
+    }
+}
+
 void SelectionCommand::saveItemStates()
 {
     m_itemStates.clear();
@@ -36,6 +36,10 @@ public:
     // 获取命令类型 (实现自Command基类)
     virtual QString getType() const override;
     
+    // 同一组图形项的连续移动合并为一次，删除操作不合并
+    int mergeId() const override;
+    bool mergeWith(const Command* other) override;
+    
     // 设置移动选择区域的信息
     void setMoveInfo(const QList<QGraphicsItem*>& items, const QPointF& offset);
     
@@ -64,6 +68,9 @@ private:
     // 保存图形项的状态
     void saveItemStates();
     
+    // 移动后标记流程图元素的连接需要更新
+    void markConnectionsDirty();
+    
     // 恢复图形项的状态
     void restoreItemStates();
 };
@@ -183,6 +183,27 @@ void StyleChangeCommand::undo()
         .arg(successCount));
 }
 
+bool StyleChangeCommand::mergeWith(const Command* other)
+{
+    const StyleChangeCommand* command = static_cast<const StyleChangeCommand*>(other);
+    if (command->m_drawArea != m_drawArea || command->m_propertyType != m_propertyType ||
+        command->m_itemStates.size() != m_itemStates.size() || !m_executed) {
+        return false;
+    }
+    for (int i = 0; i < m_itemStates.size(); ++i) {
+        if (command->m_itemStates[i].item != m_itemStates[i].item) {
+            return false;
+        }
+    }
+    
+    m_newPen = command->m_newPen;
+    m_newBrush = command->m_newBrush;
+    m_newPenWidth = command->m_newPenWidth;
+    m_newPenColor = command->m_newPenColor;
+    m_newBrushColor = command->m_newBrushColor;
+    return true;
+}
+
 void StyleChangeCommand::setNewPen(const QPen& pen)
 {
     m_newPen = pen;
@@ -62,6 +62,15 @@ public:
      */
     QString getType() const override;
     
+    /**
+     * @brief 合并对同一组图形项同一属性的连续修改
+     * 
+     * 保留本命令记录的原样式，新值取后一条命令的值，
+     * 用于滑块等连续调整时只留下一条撤销记录
+     */
+    int mergeId() const override { return StyleChangeMerge; }
+    bool mergeWith(const Command* other) override;
+    
     /**
      * @brief 设置新的画笔
      */
@@ -2,6 +2,7 @@
 #include "../core/graphic_item.h"
 #include "../utils/logger.h"
 #include <QTransform>
+#include <QLineF>
 
 // 私有构造函数
 TransformCommand::TransformCommand(QList<QGraphicsItem*> items, TransformType type)
@@ -119,6 +120,33 @@ QString TransformCommand::getType() const
     }
 }
 
+int TransformCommand::mergeId() const
+{
+    if (m_transformType == TransformType::Rotate) {
+        return RotateMerge;
+    } else if (m_transformType == TransformType::Scale) {
+        return ScaleMerge;
+    }
+    return NoMerge;
+}
+
+bool TransformCommand::mergeWith(const Command* other)
+{
+    const TransformCommand* command = static_cast<const TransformCommand*>(other);
+    if (command->m_transformType != m_transformType || !sameItems(command->m_items, m_items) ||
+        QLineF(command->m_center, m_center).length() > 0.01) {
+        return false;
+    }
+    
+    // 绕同一中心的旋转角度相加、缩放倍数相乘，原始状态保留本命令记录的
+    if (m_transformType == TransformType::Rotate) {
+        m_angle += command->m_angle;
+    } else {
+        m_factor *= command->m_factor;
+    }
+    return true;
+}
+
 // 保存所有项的原始状态
 void TransformCommand::saveOriginalStates()
 {
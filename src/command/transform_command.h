@@ -27,6 +27,10 @@ public:
     void undo() override;
     QString getDescription() const override;
     QString getType() const override;
+    
+    // 绕同一中心对同一组图形项的连续旋转/缩放合并为一次，翻转不合并
+    int mergeId() const override;
+    bool mergeWith(const Command* other) override;
 
 private:
     // 私有构造函数，只能通过工厂方法创建
@@ -1,5 +1,8 @@
 #include "bezier_graphic_item.h"
 #include <QPainter>
+#include <QLineF>
+#include <QPainterPathStroker>
+#include <QStyleOptionGraphicsItem>
 #include <cmath>
 
 BezierGraphicItem::BezierGraphicItem(const std::vector<QPointF>& controlPoints)
@@ -47,6 +50,102 @@ std::vector<QPointF> BezierGraphicItem::getDrawPoints() const
     return m_controlPoints;
 }
 
+QList<QPolygonF> BezierGraphicItem::simplifiedOutline(qreal pixelSize) const
+{
+    if (m_controlPoints.size() < 2) {
+        return {};
+    }
+    
+    // 低细节层次下按一个屏幕像素的容差展平即可
+    return {flattenedCurve(quantizeTolerance(pixelSize))};
+}
+
+void BezierGraphicItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    auto strategy = std::dynamic_pointer_cast<BezierDrawStrategy>(m_drawStrategy);
+    
+    // 低细节层次、自定义路径或替换过绘制策略时走通用流程
+    if (!strategy || m_useCustomPath || detailLevel(painter, option, widget) != DetailFull) {
+        GraphicItem::paint(painter, option, widget);
+        return;
+    }
+    
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->setPen(m_pen);
+    painter->setBrush(m_brush);
+    
+    // 三次曲线与缩放无关，由光栅化器（或SVG生成器）原生处理
+    strategy->drawPath(painter, cubicPath());
+    
+    if (isSelected()) {
+        drawSelectionHandles(painter);
+    }
+}
+
+QPainterPath BezierGraphicItem::toPath() const
+{
+    return cubicPath();
+}
+
+QPainterPath BezierGraphicItem::shape() const
+{
+    // 命中测试使用描边后的曲线，画笔宽度变化时重新生成
+    const qreal width = qMax(m_pen.widthF(), MIN_HIT_WIDTH);
+    return cachedShape(width, [this, width]() {
+        QPainterPathStroker stroker;
+        stroker.setWidth(width);
+        return stroker.createStroke(cubicPath());
+    });
+}
+
+const QPainterPath& BezierGraphicItem::cubicPath() const
+{
+    if (m_cubicPath.isEmpty() && m_controlPoints.size() >= 2) {
+        m_cubicPath = BezierDrawStrategy::toCubicPath(m_controlPoints, CUBIC_FIT_TOLERANCE);
+    }
+    return m_cubicPath;
+}
+
+const QPolygonF& BezierGraphicItem::flattenedCurve(qreal tolerance) const
+{
+    if (m_flattenTolerance != tolerance) {
+        m_flattened = BezierDrawStrategy::flatten(m_controlPoints, tolerance);
+        m_flattenTolerance = tolerance;
+    }
+    return m_flattened;
+}
+
+void BezierGraphicItem::restoreFromPoints(const std::vector<QPointF>& points)
+{
+    if (points.size() < 2) {
+        return;
+    }
+    
+    // 点集已是相对于图形项原点的坐标，位置由调用方恢复
+    prepareGeometryChange();
+    m_controlPoints = points;
+    invalidateCurveCache();
+    markSpatialIndexDirty();
+    update();
+}
+
+void BezierGraphicItem::invalidateCurveCache()
+{
+    m_cubicPath = QPainterPath();
+    m_flattenTolerance = -1.0;
+    m_flattened.clear();
+    invalidateShapeCache();
+}
+
+qreal BezierGraphicItem::quantizeTolerance(qreal tolerance)
+{
+    if (tolerance <= 0) {
+        return BezierDrawStrategy::DEFAULT_FLATNESS;
+    }
+    return std::exp2(std::floor(std::log2(tolerance)));
+}
+
 void BezierGraphicItem::setControlPoints(const std::vector<QPointF>& controlPoints)
 {
     // 确保至少有两个控制点
@@ -105,6 +204,10 @@ void BezierGraphicItem::updateGeometry()
         }
     }
     
+    // 控制点已变化，曲线缓存失效
+    invalidateCurveCache();
+    
     // 更新包围矩形
     prepareGeometryChange();
+    markSpatialIndexDirty();
 }
@@ -13,6 +13,9 @@ public:
     
     // 实现GraphicItem的虚函数
     QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+    QPainterPath shape() const override;
+    QPainterPath toPath() const override;
     GraphicType getGraphicType() const override { return BEZIER; }
     
     // Bezier曲线特有的方法
@@ -27,12 +30,48 @@ public:
     // 设置特定控制点
     void setControlPoint(int index, const QPointF& point);
     
+    /**
+     * @brief 获取曲线的分段三次Bezier表示（局部坐标），控制点不变时直接返回缓存
+     * 
+     * 绘制、SVG导出、toPath和命中测试都使用这一表示
+     */
+    const QPainterPath& cubicPath() const;
+    
+    /**
+     * @brief 获取展平后的曲线折线（局部坐标），控制点和容差不变时直接返回缓存
+     * @param tolerance 折线到曲线的最大允许偏差
+     */
+    const QPolygonF& flattenedCurve(qreal tolerance = BezierDrawStrategy::DEFAULT_FLATNESS) const;
+    
+    // 从点集合恢复控制点（局部坐标，用于反序列化和撤销）
+    void restoreFromPoints(const std::vector<QPointF>& points) override;
+    
 protected:
     // 提供绘制点集合
     std::vector<QPointF> getDrawPoints() const override;
     
+    // 低细节层次下的简化轮廓
+    QList<QPolygonF> simplifiedOutline(qreal pixelSize) const override;
+    
 private:
     std::vector<QPointF> m_controlPoints; // 控制点集合（相对于图形项坐标系）
+    
+    // 曲线缓存，只在控制点变化时失效
+    mutable QPainterPath m_cubicPath;         // 分段三次曲线
+    mutable qreal m_flattenTolerance = -1.0;  // 负值表示折线缓存无效
+    mutable QPolygonF m_flattened;            // 低细节层次使用的折线
+    
+    // 三次曲线拟合的容差（局部坐标），放大数十倍后仍不可见
+    static constexpr qreal CUBIC_FIT_TOLERANCE = 0.05;
+    
+    // 命中区域的最小宽度，细线也便于选中
+    static constexpr qreal MIN_HIT_WIDTH = 8.0;
+    
+    // 将折线容差向下取整到2的幂，缩放时只在跨过档位时重新展平
+    static qreal quantizeTolerance(qreal tolerance);
+    
+    void invalidateCurveCache();
+    
     // 更新图形项的位置和绑定矩形
     void updateGeometry();
 };
@@ -1,4 +1,5 @@
 #include "circle_graphic_item.h"
+#include <cmath>
 
 CircleGraphicItem::CircleGraphicItem(const QPointF& center, double radius)
 {
@@ -31,6 +32,29 @@ std::vector<QPointF> CircleGraphicItem::getDrawPoints() const
     return {QPointF(0, 0), QPointF(m_radius, 0)};
 }
 
+QPainterPath CircleGraphicItem::toPath() const
+{
+    // 圆形路径（相对于图形项坐标系）
+    QPainterPath path;
+    path.addEllipse(QPointF(0, 0), m_radius, m_radius);
+    return path;
+}
+
+QList<QPolygonF> CircleGraphicItem::simplifiedOutline(qreal pixelSize) const
+{
+    // 按屏幕上的周长确定分段数，每段约4个像素
+    const qreal circumference = 2.0 * M_PI * m_radius;
+    const int segments = qBound(8, static_cast<int>(circumference / (4.0 * pixelSize)), 64);
+    
+    QPolygonF polygon;
+    polygon.reserve(segments + 1);
+    for (int i = 0; i <= segments; ++i) {
+        const qreal angle = 2.0 * M_PI * i / segments;
+        polygon << QPointF(m_radius * std::cos(angle), m_radius * std::sin(angle));
+    }
+    return {polygon};
+}
+
 QPointF CircleGraphicItem::getCenter() const
 {
     // 返回全局坐标系中的中心点
@@ -46,5 +70,6 @@ void CircleGraphicItem::setCenter(const QPointF& center)
 void CircleGraphicItem::setRadius(double radius)
 {
     m_radius = std::max(1.0, radius); // 确保半径至少为1
+    markSpatialIndexDirty();
     update(); // 更新显示
 } 
\ No newline at end of file
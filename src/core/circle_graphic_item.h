@@ -20,10 +20,16 @@ public:
     double getRadius() const { return m_radius; }
     void setRadius(double radius);
     
+    // 获取图形的路径表示
+    QPainterPath toPath() const override;
+    
 protected:
     // 提供绘制点集合
     std::vector<QPointF> getDrawPoints() const override;
     
+    // 低细节层次下的简化轮廓
+    QList<QPolygonF> simplifiedOutline(qreal pixelSize) const override;
+    
 private:
     double m_radius; // 半径
 };
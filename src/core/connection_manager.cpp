@@ -3,9 +3,13 @@
 #include "flowchart_decision_item.h"
 #include "flowchart_start_end_item.h"
 #include "flowchart_io_item.h"
+#include "item_registry.h"
+#include "connection_point_overlay.h"
 #include "../utils/logger.h"
 #include <QGraphicsScene>
 #include <QtMath>
+#include <cmath>
+#include <limits>
 #include <QApplication>
 
 ConnectionManager::ConnectionManager(QGraphicsScene* scene, QObject* parent)
@@ -16,6 +20,8 @@ ConnectionManager::ConnectionManager(QGraphicsScene* scene, QObject* parent)
     , m_hasHighlight(false)
     , m_snapTolerance(20.0)
     , m_connectionPointSize(8.0)
+    , m_gridCellSize(20.0)
+    , m_router(scene)
 {
     // 初始化更新定时器
     m_updateTimer = new QTimer(this);
@@ -44,12 +50,7 @@ void ConnectionManager::registerFlowchartItem(FlowchartBaseItem* item)
     }
     
     // 计算连接点，但使用延迟机制避免频繁重复计算
-    if (!m_itemsToUpdate.contains(item)) {
-        m_itemsToUpdate.append(item);
-        if (!m_updateTimer->isActive()) {
-            m_updateTimer->start();
-        }
-    }
+    markItemDirty(item);
     
     Logger::debug(QString("已注册流程图元素: %1").arg(item->getGraphicType()));
 }
@@ -60,8 +61,18 @@ void ConnectionManager::unregisterFlowchartItem(FlowchartBaseItem* item)
     
     // 移除所有相关连接
     removeAllConnectionsFor(item);
+    m_itemsToUpdate.remove(item);
+    
+    // 元素让出的空间可能让经过附近的折线连接器有更短的路径
+    if (!dynamic_cast<FlowchartConnectorItem*>(item)) {
+        invalidateRoutesAround(m_lastItemBounds.value(item), QRectF());
+        if (!m_dirtyConnectors.isEmpty() && !m_updateTimer->isActive()) {
+            m_updateTimer->start();
+        }
+    }
     
     // 移除连接点和缓存数据
+    unindexConnectionPoints(item);
     m_connectionPoints.remove(item);
     m_lastItemBounds.remove(item);
     m_lastConnectionCount.remove(item);
@@ -84,9 +95,8 @@ void ConnectionManager::calculateConnectionPoints(FlowchartBaseItem* item)
         return;
     }
     
-    // 优化：使用item->scene()而不是m_scene->items().contains(item)
-    // 这样避免了遍历整个场景的开销
-    if (!item->scene() || item->scene() != m_scene) {
+    // 通过存活登记表判断，避免遍历整个场景，也不会解引用已析构的元素
+    if (!ItemRegistry::isInScene(item, m_scene)) {
         Logger::warning("ConnectionManager::calculateConnectionPoints: 元素不在场景中，跳过计算");
         return;
     }
@@ -115,9 +125,7 @@ void ConnectionManager::calculateConnectionPoints(FlowchartBaseItem* item)
         if (boundingRect.isEmpty()) {
             Logger::debug("ConnectionManager::calculateConnectionPoints: 图形项边界为空，延迟计算");
             // 重新安排计算
-            if (!m_itemsToUpdate.contains(item)) {
-                m_itemsToUpdate.append(item);
-            }
+            m_itemsToUpdate.insert(item);
             if (!m_updateTimer->isActive()) {
                 m_updateTimer->setInterval(100); // 再次延迟
                 m_updateTimer->start();
@@ -139,7 +147,9 @@ void ConnectionManager::calculateConnectionPoints(FlowchartBaseItem* item)
             points.append(point);
         }
         
+        unindexConnectionPoints(item);
         m_connectionPoints[item] = points;
+        indexConnectionPoints(item);
         
         // 更新缓存
         m_lastItemBounds[item] = currentBounds;
@@ -157,6 +167,7 @@ void ConnectionManager::calculateConnectionPoints(FlowchartBaseItem* item)
     catch (const std::exception& e) {
         Logger::error(QString("ConnectionManager::calculateConnectionPoints: 异常 - %1").arg(e.what()));
         // 如果计算失败，从管理器中移除该项目
+        unindexConnectionPoints(item);
         m_connectionPoints.remove(item);
         m_lastItemBounds.remove(item);
         m_lastConnectionCount.remove(item);
@@ -164,6 +175,7 @@ void ConnectionManager::calculateConnectionPoints(FlowchartBaseItem* item)
     catch (...) {
         Logger::error("ConnectionManager::calculateConnectionPoints: 未知异常");
         // 如果计算失败，从管理器中移除该项目
+        unindexConnectionPoints(item);
         m_connectionPoints.remove(item);
         m_lastItemBounds.remove(item);
         m_lastConnectionCount.remove(item);
@@ -193,14 +205,8 @@ void ConnectionManager::updateConnectionPoints(FlowchartBaseItem* item)
     // 重新计算连接点
     calculateConnectionPoints(item);
     
-    // 安排更新（使用防重复机制）
-    if (!m_itemsToUpdate.contains(item)) {
-        m_itemsToUpdate.append(item);
-    }
-    
-    if (!m_updateTimer->isActive()) {
-        m_updateTimer->start();
-    }
+    // 安排下一帧重建相关连接器
+    markItemDirty(item);
 }
 
 void ConnectionManager::showConnectionPoints(FlowchartBaseItem* item)
@@ -217,6 +223,7 @@ void ConnectionManager::showConnectionPoints(FlowchartBaseItem* item)
     
     // 确保连接点是最新的
     updateConnectionPoints(item);
+    notifyOverlay();
     
     // 触发场景更新
     if (m_scene) {
@@ -239,6 +246,7 @@ void ConnectionManager::hideConnectionPoints()
     m_connectionPointsVisible = false;
     m_currentVisibleItem = nullptr;
     clearHighlight();
+    notifyOverlay();
     
     // 触发场景更新
     if (m_scene) {
@@ -264,43 +272,218 @@ void ConnectionManager::setConnectionPointsVisible(bool visible)
 
 QPointF ConnectionManager::findNearestConnectionPoint(const QPointF& scenePos, FlowchartBaseItem* excludeItem)
 {
-    double minDistance = std::numeric_limits<double>::max();
-    QPointF nearestPoint = scenePos;
+    ConnectionPoint* point = nearestConnectionPoint(scenePos, m_snapTolerance, excludeItem);
+    return point ? point->scenePos : scenePos;
+}
+
+ConnectionManager::ConnectionPoint* ConnectionManager::findConnectionPointAt(const QPointF& scenePos, double tolerance)
+{
+    return nearestConnectionPoint(scenePos, tolerance, nullptr);
+}
+
+bool ConnectionManager::isNearConnectionPoint(const QPointF& scenePos, double tolerance)
+{
+    return findConnectionPointAt(scenePos, tolerance) != nullptr;
+}
+
+void ConnectionManager::setSnapTolerance(double tolerance)
+{
+    m_snapTolerance = tolerance;
     
-    for (auto it = m_connectionPoints.begin(); it != m_connectionPoints.end(); ++it) {
-        FlowchartBaseItem* item = it.key();
-        if (item == excludeItem) continue;
-        
-        const QList<ConnectionPoint>& points = it.value();
-        for (const ConnectionPoint& point : points) {
-            double distance = QLineF(scenePos, point.scenePos).length();
-            if (distance < minDistance && distance <= m_snapTolerance) {
-                minDistance = distance;
-                nearestPoint = point.scenePos;
+    // 网格单元与吸附容差一致时，一次吸附查询只需检查3x3个单元
+    const double cellSize = qMax(1.0, tolerance);
+    if (!qFuzzyCompare(cellSize, m_gridCellSize)) {
+        m_gridCellSize = cellSize;
+        rebuildPointGrid();
+    }
+}
+
+ConnectionManager::ConnectionPoint* ConnectionManager::nearestConnectionPoint(const QPointF& scenePos, double tolerance,
+                                                                              FlowchartBaseItem* excludeItem)
+{
+    if (tolerance < 0 || m_pointGrid.isEmpty()) {
+        return nullptr;
+    }
+    
+    const QPoint center = gridCellOf(scenePos);
+    const int range = qMax(1, static_cast<int>(std::ceil(tolerance / m_gridCellSize)));
+    const double toleranceSq = tolerance * tolerance;
+    
+    double minDistanceSq = std::numeric_limits<double>::max();
+    ConnectionPoint* nearest = nullptr;
+    
+    for (int cy = center.y() - range; cy <= center.y() + range; ++cy) {
+        for (int cx = center.x() - range; cx <= center.x() + range; ++cx) {
+            auto cell = m_pointGrid.constFind(gridKey(cx, cy));
+            if (cell == m_pointGrid.constEnd()) {
+                continue;
+            }
+            for (const GridEntry& entry : cell.value()) {
+                if (entry.item == excludeItem) {
+                    continue;
+                }
+                auto points = m_connectionPoints.find(entry.item);
+                if (points == m_connectionPoints.end() || entry.index < 0 || entry.index >= points->size()) {
+                    continue;
+                }
+                ConnectionPoint& point = (*points)[entry.index];
+                const QPointF d = point.scenePos - scenePos;
+                const double distanceSq = d.x() * d.x() + d.y() * d.y();
+                if (distanceSq <= toleranceSq && distanceSq < minDistanceSq) {
+                    minDistanceSq = distanceSq;
+                    nearest = &point;
+                }
             }
         }
     }
     
-    return nearestPoint;
+    return nearest;
 }
 
-ConnectionManager::ConnectionPoint* ConnectionManager::findConnectionPointAt(const QPointF& scenePos, double tolerance)
+QPoint ConnectionManager::gridCellOf(const QPointF& scenePos) const
 {
-    for (auto it = m_connectionPoints.begin(); it != m_connectionPoints.end(); ++it) {
-        QList<ConnectionPoint>& points = it.value();
-        for (ConnectionPoint& point : points) {
-            double distance = QLineF(scenePos, point.scenePos).length();
-            if (distance <= tolerance) {
-                return &point;
+    return QPoint(static_cast<int>(std::floor(scenePos.x() / m_gridCellSize)),
+                  static_cast<int>(std::floor(scenePos.y() / m_gridCellSize)));
+}
+
+quint64 ConnectionManager::gridKey(int cellX, int cellY)
+{
+    return (static_cast<quint64>(static_cast<quint32>(cellX)) << 32) | static_cast<quint32>(cellY);
+}
+
+void ConnectionManager::indexConnectionPoints(FlowchartBaseItem* item)
+{
+    auto points = m_connectionPoints.constFind(item);
+    if (points == m_connectionPoints.constEnd()) {
+        return;
+    }
+    
+    for (const ConnectionPoint& point : points.value()) {
+        const QPoint cell = gridCellOf(point.scenePos);
+        m_pointGrid[gridKey(cell.x(), cell.y())].append({item, point.index});
+    }
+    markPointBoundsDirty();
+}
+
+void ConnectionManager::unindexConnectionPoints(FlowchartBaseItem* item)
+{
+    auto points = m_connectionPoints.constFind(item);
+    if (points == m_connectionPoints.constEnd()) {
+        return;
+    }
+    
+    // 按登记时的位置找到所在单元，只使用指针值，图形项已销毁时也安全
+    for (const ConnectionPoint& point : points.value()) {
+        const QPoint cell = gridCellOf(point.scenePos);
+        auto it = m_pointGrid.find(gridKey(cell.x(), cell.y()));
+        if (it == m_pointGrid.end()) {
+            continue;
+        }
+        it->removeIf([item](const GridEntry& entry) { return entry.item == item; });
+        if (it->isEmpty()) {
+            m_pointGrid.erase(it);
+        }
+    }
+    markPointBoundsDirty();
+}
+
+void ConnectionManager::rebuildPointGrid()
+{
+    m_pointGrid.clear();
+    for (auto it = m_connectionPoints.constBegin(); it != m_connectionPoints.constEnd(); ++it) {
+        indexConnectionPoints(it.key());
+    }
+}
+
+void ConnectionManager::visitConnectionPoints(const QRectF& rect,
+                                              const std::function<void(const ConnectionPoint&)>& visitor) const
+{
+    if (m_pointGrid.isEmpty() || rect.isEmpty()) {
+        return;
+    }
+    
+    auto visitEntries = [&](const QList<GridEntry>& entries) {
+        for (const GridEntry& entry : entries) {
+            auto points = m_connectionPoints.constFind(entry.item);
+            if (points == m_connectionPoints.constEnd() || entry.index < 0 || entry.index >= points->size()) {
+                continue;
+            }
+            const ConnectionPoint& point = points->at(entry.index);
+            if (rect.contains(point.scenePos)) {
+                visitor(point);
+            }
+        }
+    };
+    
+    const QPoint first = gridCellOf(rect.topLeft());
+    const QPoint last = gridCellOf(rect.bottomRight());
+    const qint64 cellCount = static_cast<qint64>(last.x() - first.x() + 1) * (last.y() - first.y() + 1);
+    
+    // 矩形覆盖的单元比非空单元还多时（例如缩小到全局视图），直接遍历非空单元
+    if (cellCount > m_pointGrid.size()) {
+        for (auto cell = m_pointGrid.constBegin(); cell != m_pointGrid.constEnd(); ++cell) {
+            visitEntries(cell.value());
+        }
+        return;
+    }
+    
+    for (int cy = first.y(); cy <= last.y(); ++cy) {
+        for (int cx = first.x(); cx <= last.x(); ++cx) {
+            auto cell = m_pointGrid.constFind(gridKey(cx, cy));
+            if (cell != m_pointGrid.constEnd()) {
+                visitEntries(cell.value());
             }
         }
     }
-    return nullptr;
 }
 
-bool ConnectionManager::isNearConnectionPoint(const QPointF& scenePos, double tolerance)
+QRectF ConnectionManager::connectionPointsBounds() const
 {
-    return findConnectionPointAt(scenePos, tolerance) != nullptr;
+    if (!m_pointBoundsDirty) {
+        return m_pointBounds;
+    }
+    
+    qreal left = std::numeric_limits<qreal>::max();
+    qreal top = std::numeric_limits<qreal>::max();
+    qreal right = std::numeric_limits<qreal>::lowest();
+    qreal bottom = std::numeric_limits<qreal>::lowest();
+    bool hasPoints = false;
+    for (auto it = m_connectionPoints.constBegin(); it != m_connectionPoints.constEnd(); ++it) {
+        for (const ConnectionPoint& point : it.value()) {
+            left = qMin(left, point.scenePos.x());
+            top = qMin(top, point.scenePos.y());
+            right = qMax(right, point.scenePos.x());
+            bottom = qMax(bottom, point.scenePos.y());
+            hasPoints = true;
+        }
+    }
+    
+    m_pointBounds = hasPoints ? QRectF(QPointF(left, top), QPointF(right, bottom)) : QRectF();
+    m_pointBoundsDirty = false;
+    return m_pointBounds;
+}
+
+void ConnectionManager::markPointBoundsDirty()
+{
+    m_pointBoundsDirty = true;
+    if (hasOverlay() && !m_updateTimer->isActive()) {
+        m_updateTimer->start();
+    }
+}
+
+void ConnectionManager::notifyOverlay()
+{
+    if (hasOverlay()) {
+        m_overlay->updateOverlay();
+    }
+}
+
+bool ConnectionManager::hasOverlay()
+{
+    if (m_overlay && !ItemRegistry::isAlive(m_overlay)) {
+        m_overlay = nullptr;
+    }
+    return m_overlay != nullptr;
 }
 
 bool ConnectionManager::createConnection(FlowchartBaseItem* fromItem, int fromPointIndex, 
@@ -314,7 +497,7 @@ bool ConnectionManager::createConnection(FlowchartBaseItem* fromItem, int fromPo
     }
     
     // 验证元素是否在场景中
-    if (!m_scene || !m_scene->items().contains(fromItem) || !m_scene->items().contains(toItem)) {
+    if (!ItemRegistry::isInScene(fromItem, m_scene) || !ItemRegistry::isInScene(toItem, m_scene)) {
         Logger::warning("连接的元素不在场景中");
         return false;
     }
@@ -352,13 +535,15 @@ bool ConnectionManager::createConnection(FlowchartBaseItem* fromItem, int fromPo
     }
     
     // 记录连接关系
-    Connection connection(fromItem, fromPointIndex, toItem, toPointIndex, connector);
-    m_connections.append(connection);
+    addConnectionRecord(Connection(fromItem, fromPointIndex, toItem, toPointIndex, connector));
     
     // 标记连接点为已占用
     m_connectionPoints[fromItem][fromPointIndex].isOccupied = true;
     m_connectionPoints[toItem][toPointIndex].isOccupied = true;
     
+    // 折线连接器需要立即路由，否则在端点移动前一直显示为直线
+    rebuildConnector(connector);
+    
     // 发射信号
     emit connectionCreated(fromItem, toItem, connector);
     
@@ -371,35 +556,31 @@ void ConnectionManager::removeConnection(FlowchartConnectorItem* connector)
     if (!connector) return;
     
     // 查找并移除连接记录
-    for (int i = 0; i < m_connections.size(); ++i) {
-        if (m_connections[i].connector == connector) {
-            Connection& conn = m_connections[i];
-            
-            // 释放连接点
-            if (m_connectionPoints.contains(conn.fromItem) && 
-                conn.fromPointIndex >= 0 && conn.fromPointIndex < m_connectionPoints[conn.fromItem].size()) {
-                m_connectionPoints[conn.fromItem][conn.fromPointIndex].isOccupied = false;
-            }
-            
-            if (m_connectionPoints.contains(conn.toItem) && 
-                conn.toPointIndex >= 0 && conn.toPointIndex < m_connectionPoints[conn.toItem].size()) {
-                m_connectionPoints[conn.toItem][conn.toPointIndex].isOccupied = false;
-            }
-            
-            // 从场景移除连接器
-            if (m_scene && m_scene->items().contains(connector)) {
-                m_scene->removeItem(connector);
-            }
-            
-            // 移除连接记录
-            m_connections.removeAt(i);
-            
-            // 发射信号
-            emit connectionRemoved(connector);
-            
-            Logger::info("移除了一个连接");
-            break;
+    const Connection conn = connectionFor(connector);
+    if (conn.connector) {
+        // 释放连接点
+        if (m_connectionPoints.contains(conn.fromItem) && 
+            conn.fromPointIndex >= 0 && conn.fromPointIndex < m_connectionPoints[conn.fromItem].size()) {
+            m_connectionPoints[conn.fromItem][conn.fromPointIndex].isOccupied = false;
         }
+        
+        if (m_connectionPoints.contains(conn.toItem) && 
+            conn.toPointIndex >= 0 && conn.toPointIndex < m_connectionPoints[conn.toItem].size()) {
+            m_connectionPoints[conn.toItem][conn.toPointIndex].isOccupied = false;
+        }
+        
+        // 从场景移除连接器
+        if (ItemRegistry::isInScene(connector, m_scene)) {
+            m_scene->removeItem(connector);
+        }
+        
+        // 移除连接记录
+        takeConnectionRecord(connector);
+        
+        // 发射信号
+        emit connectionRemoved(connector);
+        
+        Logger::info("移除了一个连接");
     }
     
     // 删除连接器对象
@@ -410,14 +591,8 @@ void ConnectionManager::removeAllConnectionsFor(FlowchartBaseItem* item)
 {
     if (!item) return;
     
-    QList<FlowchartConnectorItem*> connectorsToRemove;
-    
-    for (const Connection& conn : m_connections) {
-        if (conn.fromItem == item || conn.toItem == item) {
-            connectorsToRemove.append(conn.connector);
-        }
-    }
-    
+    // removeConnection会修改邻接表，先取出副本
+    const QList<FlowchartConnectorItem*> connectorsToRemove = connectorsOf(item);
     for (FlowchartConnectorItem* connector : connectorsToRemove) {
         removeConnection(connector);
     }
@@ -428,7 +603,7 @@ void ConnectionManager::updateConnections(FlowchartBaseItem* item)
     if (!item || !m_scene) return;
     
     // 检查元素是否仍在场景中
-    if (!m_scene->items().contains(item)) {
+    if (!ItemRegistry::isInScene(item, m_scene)) {
         Logger::warning("ConnectionManager::updateConnections: 元素不在场景中，跳过更新");
         return;
     }
@@ -438,56 +613,105 @@ void ConnectionManager::updateConnections(FlowchartBaseItem* item)
         updateConnectionPoints(item);
     }
     
-    // 批量收集需要更新的连接器，避免重复更新
-    QSet<FlowchartConnectorItem*> connectorsToUpdate;
-    
-    // 使用迭代器安全地遍历和移除无效连接
-    auto it = m_connections.begin();
-    while (it != m_connections.end()) {
-        Connection& conn = *it;
+    // 只遍历该元素自身的边；移除无效连接会修改邻接表，先取出副本
+    const QList<FlowchartConnectorItem*> connectors = connectorsOf(item);
+    for (FlowchartConnectorItem* connector : connectors) {
+        const Connection conn = connectionFor(connector);
+        if (!conn.connector) {
+            continue;
+        }
         
-        if (conn.fromItem == item || conn.toItem == item) {
-            // 简化的安全检查：先检查场景包含，再检查scene()
-            bool fromValid = conn.fromItem && m_scene->items().contains(conn.fromItem) && 
-                            conn.fromItem->scene() == m_scene;
-            bool toValid = conn.toItem && m_scene->items().contains(conn.toItem) && 
-                          conn.toItem->scene() == m_scene;
-            
-            if (!fromValid || !toValid) {
-                // 移除无效连接
-                if (conn.connector && m_scene->items().contains(conn.connector)) {
-                    m_scene->removeItem(conn.connector);
-                    delete conn.connector;
-                }
-                it = m_connections.erase(it);
-                continue;
-            }
-            
-            // 获取连接点位置并更新连接器
-            if (conn.fromItem && m_connectionPoints.contains(conn.fromItem) && 
-                conn.fromPointIndex >= 0 && conn.fromPointIndex < m_connectionPoints[conn.fromItem].size() &&
-                conn.toItem && m_connectionPoints.contains(conn.toItem) && 
-                conn.toPointIndex >= 0 && conn.toPointIndex < m_connectionPoints[conn.toItem].size() &&
-                conn.connector) {
-                connectorsToUpdate.insert(conn.connector);
+        // 两端元素必须仍然存活且位于本场景中
+        bool fromValid = ItemRegistry::isInScene(conn.fromItem, m_scene);
+        bool toValid = ItemRegistry::isInScene(conn.toItem, m_scene);
+        
+        if (!fromValid || !toValid) {
+            // 移除无效连接
+            takeConnectionRecord(connector);
+            if (ItemRegistry::isInScene(connector, m_scene)) {
+                m_scene->removeItem(connector);
+                delete connector;
             }
+            continue;
         }
         
-        ++it;
+        // 按连接点位置更新连接器
+        rebuildConnector(connector);
     }
+}
+
+void ConnectionManager::markItemDirty(FlowchartBaseItem* item)
+{
+    if (!item) return;
     
-    // 批量更新连接器
-    for (FlowchartConnectorItem* connector : connectorsToUpdate) {
-        for (const Connection& conn : m_connections) {
-            if (conn.connector == connector) {
-                QPointF startPos = m_connectionPoints[conn.fromItem][conn.fromPointIndex].scenePos;
-                QPointF endPos = m_connectionPoints[conn.toItem][conn.toPointIndex].scenePos;
-                
-                connector->setStartPoint(startPos);
-                connector->setEndPoint(endPos);
-                break;
-            }
+    m_itemsToUpdate.insert(item);
+    if (!m_updateTimer->isActive()) {
+        m_updateTimer->start();
+    }
+}
+
+void ConnectionManager::markConnectorsDirty(FlowchartBaseItem* item)
+{
+    auto it = m_adjacency.constFind(item);
+    if (it == m_adjacency.constEnd()) {
+        return;
+    }
+    
+    for (FlowchartConnectorItem* connector : it.value().outgoing) {
+        m_dirtyConnectors.insert(connector);
+    }
+    for (FlowchartConnectorItem* connector : it.value().incoming) {
+        m_dirtyConnectors.insert(connector);
+    }
+}
+
+void ConnectionManager::rebuildConnector(FlowchartConnectorItem* connector)
+{
+    const Connection conn = connectionFor(connector);
+    if (!conn.connector) {
+        return;
+    }
+    
+    auto fromIt = m_connectionPoints.constFind(conn.fromItem);
+    auto toIt = m_connectionPoints.constFind(conn.toItem);
+    if (fromIt == m_connectionPoints.constEnd() || toIt == m_connectionPoints.constEnd()) {
+        return;
+    }
+    
+    const QList<ConnectionPoint>& fromPoints = fromIt.value();
+    const QList<ConnectionPoint>& toPoints = toIt.value();
+    if (conn.fromPointIndex < 0 || conn.fromPointIndex >= fromPoints.size() ||
+        conn.toPointIndex < 0 || conn.toPointIndex >= toPoints.size()) {
+        return;
+    }
+    
+    const QPointF start = fromPoints[conn.fromPointIndex].scenePos;
+    const QPointF end = toPoints[conn.toPointIndex].scenePos;
+    
+    // 没有手动控制点的折线连接器使用避障路由，端点未变且路由未失效时直接复用缓存
+    if (connector->getConnectorType() == FlowchartConnectorItem::Polyline &&
+        connector->getControlPoints().isEmpty()) {
+        QList<QPointF> route;
+        if (const QList<QPointF>* cached = m_router.cachedRoute(connector, start, end)) {
+            route = *cached;
+        } else {
+            route = m_router.route(start, conn.fromItem, end, conn.toItem);
+            m_router.storeRoute(connector, route);
         }
+        connector->setEndpoints(start, end, route.mid(1, route.size() - 2));
+        return;
+    }
+    
+    connector->setEndpoints(start, end);
+}
+
+void ConnectionManager::invalidateRoutesAround(const QRectF& oldBounds, const QRectF& newBounds)
+{
+    for (FlowchartConnectorItem* connector : m_router.invalidateRoutes(oldBounds)) {
+        m_dirtyConnectors.insert(connector);
+    }
+    for (FlowchartConnectorItem* connector : m_router.invalidateRoutes(newBounds)) {
+        m_dirtyConnectors.insert(connector);
     }
 }
 
@@ -519,9 +743,29 @@ bool ConnectionManager::isConnected(FlowchartBaseItem* fromItem, FlowchartBaseIt
         return false;
     }
     
-    for (const Connection& conn : m_connections) {
-        if ((conn.fromItem == fromItem && conn.toItem == toItem) ||
-            (conn.fromItem == toItem && conn.toItem == fromItem)) {
+    // 从度数较小的一端查找，代价为O(min(度数))
+    auto fromIt = m_adjacency.constFind(fromItem);
+    auto toIt = m_adjacency.constFind(toItem);
+    if (fromIt == m_adjacency.constEnd() || toIt == m_adjacency.constEnd()) {
+        return false;
+    }
+    
+    const Adjacency& fromAdj = fromIt.value();
+    const Adjacency& toAdj = toIt.value();
+    FlowchartBaseItem* other = toItem;
+    const Adjacency* adj = &fromAdj;
+    if (toAdj.outgoing.size() + toAdj.incoming.size() < fromAdj.outgoing.size() + fromAdj.incoming.size()) {
+        other = fromItem;
+        adj = &toAdj;
+    }
+    
+    for (FlowchartConnectorItem* connector : adj->outgoing) {
+        if (m_connections[m_connectionIndex.value(connector)].toItem == other) {
+            return true;
+        }
+    }
+    for (FlowchartConnectorItem* connector : adj->incoming) {
+        if (m_connections[m_connectionIndex.value(connector)].fromItem == other) {
             return true;
         }
     }
@@ -536,14 +780,123 @@ QList<ConnectionManager::Connection> ConnectionManager::getConnectionsFor(Flowch
         return result;
     }
     
-    for (const Connection& conn : m_connections) {
-        if (conn.fromItem == item || conn.toItem == item) {
-            result.append(conn);
-        }
+    const QList<FlowchartConnectorItem*> connectors = connectorsOf(item);
+    result.reserve(connectors.size());
+    for (FlowchartConnectorItem* connector : connectors) {
+        result.append(m_connections[m_connectionIndex.value(connector)]);
     }
     return result;
 }
 
+bool ConnectionManager::hasConnections(FlowchartBaseItem* item) const
+{
+    return m_adjacency.contains(item);
+}
+
+ConnectionManager::Connection ConnectionManager::connectionFor(FlowchartConnectorItem* connector) const
+{
+    auto it = m_connectionIndex.constFind(connector);
+    if (it == m_connectionIndex.constEnd()) {
+        return Connection();
+    }
+    return m_connections[it.value()];
+}
+
+FlowchartConnectorItem* ConnectionManager::findConnector(FlowchartBaseItem* fromItem, int fromPointIndex,
+                                                         FlowchartBaseItem* toItem, int toPointIndex) const
+{
+    auto it = m_adjacency.constFind(fromItem);
+    if (it == m_adjacency.constEnd()) {
+        return nullptr;
+    }
+    
+    for (FlowchartConnectorItem* connector : it.value().outgoing) {
+        const Connection& conn = m_connections[m_connectionIndex.value(connector)];
+        if (conn.fromPointIndex == fromPointIndex &&
+            conn.toItem == toItem && conn.toPointIndex == toPointIndex) {
+            return connector;
+        }
+    }
+    return nullptr;
+}
+
+void ConnectionManager::addConnectionRecord(const Connection& connection)
+{
+    if (!connection.connector || m_connectionIndex.contains(connection.connector)) {
+        return;
+    }
+    
+    m_connectionIndex.insert(connection.connector, m_connections.size());
+    m_connections.append(connection);
+    m_adjacency[connection.fromItem].outgoing.append(connection.connector);
+    m_adjacency[connection.toItem].incoming.append(connection.connector);
+}
+
+bool ConnectionManager::takeConnectionRecord(FlowchartConnectorItem* connector)
+{
+    auto indexIt = m_connectionIndex.find(connector);
+    if (indexIt == m_connectionIndex.end()) {
+        return false;
+    }
+    
+    const int index = indexIt.value();
+    m_connectionIndex.erase(indexIt);
+    m_dirtyConnectors.remove(connector);
+    m_router.removeRoute(connector);
+    const Connection conn = m_connections[index];
+    
+    // 解除两端元素的邻接关系，没有剩余边的元素不再保留条目
+    auto fromIt = m_adjacency.find(conn.fromItem);
+    if (fromIt != m_adjacency.end()) {
+        fromIt->outgoing.removeOne(connector);
+        if (fromIt->outgoing.isEmpty() && fromIt->incoming.isEmpty()) {
+            m_adjacency.erase(fromIt);
+        }
+    }
+    auto toIt = m_adjacency.find(conn.toItem);
+    if (toIt != m_adjacency.end()) {
+        toIt->incoming.removeOne(connector);
+        if (toIt->outgoing.isEmpty() && toIt->incoming.isEmpty()) {
+            m_adjacency.erase(toIt);
+        }
+    }
+    
+    // 用末尾的连接填补空位，避免移动后续元素
+    const int last = m_connections.size() - 1;
+    if (index != last) {
+        m_connections[index] = m_connections[last];
+        m_connectionIndex[m_connections[index].connector] = index;
+    }
+    m_connections.removeLast();
+    return true;
+}
+
+void ConnectionManager::clearConnectionRecords()
+{
+    m_connections.clear();
+    m_connectionIndex.clear();
+    m_adjacency.clear();
+    m_dirtyConnectors.clear();
+    m_router.clear();
+}
+
+QList<FlowchartConnectorItem*> ConnectionManager::connectorsOf(FlowchartBaseItem* item) const
+{
+    auto it = m_adjacency.constFind(item);
+    if (it == m_adjacency.constEnd()) {
+        return QList<FlowchartConnectorItem*>();
+    }
+    
+    QList<FlowchartConnectorItem*> connectors = it.value().outgoing;
+    for (FlowchartConnectorItem* connector : it.value().incoming) {
+        // 起点和终点是同一元素时只记录一次
+        if (m_connections[m_connectionIndex.value(connector)].fromItem != item) {
+            connectors.append(connector);
+        }
+    }
+    return connectors;
+}
+
 void ConnectionManager::highlightConnectionPoint(const ConnectionPoint& point)
 {
     // 检查是否是同一个连接点，避免重复高亮
@@ -605,10 +958,13 @@ void ConnectionManager::clearAllConnectionPoints()
     
     // 清空数据和缓存
     m_connectionPoints.clear();
-    m_connections.clear();
+    m_pointGrid.clear();
+    m_pointBoundsDirty = true;
+    clearConnectionRecords();
     m_lastItemBounds.clear();
     m_lastConnectionCount.clear();
     hideConnectionPoints();
+    notifyOverlay();
 }
 
 void ConnectionManager::cleanupInvalidItems()
@@ -621,13 +977,14 @@ void ConnectionManager::cleanupInvalidItems()
     for (auto it = m_connectionPoints.begin(); it != m_connectionPoints.end(); ++it) {
         FlowchartBaseItem* item = it.key();
         // 简化检查：指针为空或不在场景中就认为无效
-        if (!item || !m_scene->items().contains(item)) {
+        if (!ItemRegistry::isInScene(item, m_scene)) {
             invalidItems.append(item);
         }
     }
     
     // 移除无效项目和相关缓存
     for (FlowchartBaseItem* item : invalidItems) {
+        unindexConnectionPoints(item);
         m_connectionPoints.remove(item);
         m_lastItemBounds.remove(item);
         m_lastConnectionCount.remove(item);
@@ -641,9 +998,9 @@ void ConnectionManager::cleanupInvalidItems()
     QList<FlowchartConnectorItem*> invalidConnectors;
     
     for (const Connection& conn : m_connections) {
-        bool fromInvalid = !conn.fromItem || !m_scene->items().contains(conn.fromItem);
-        bool toInvalid = !conn.toItem || !m_scene->items().contains(conn.toItem);
-        bool connectorInvalid = !conn.connector || !m_scene->items().contains(conn.connector);
+        bool fromInvalid = !ItemRegistry::isInScene(conn.fromItem, m_scene);
+        bool toInvalid = !ItemRegistry::isInScene(conn.toItem, m_scene);
+        bool connectorInvalid = !ItemRegistry::isInScene(conn.connector, m_scene);
         
         if (fromInvalid || toInvalid || connectorInvalid) {
             invalidConnectors.append(conn.connector);
@@ -654,15 +1011,14 @@ void ConnectionManager::cleanupInvalidItems()
         removeConnection(connector);
     }
     
-    // 清理待更新列表
-    m_itemsToUpdate.removeAll(nullptr);
-    QList<FlowchartBaseItem*> validItemsToUpdate;
-    for (FlowchartBaseItem* item : m_itemsToUpdate) {
-        if (item && m_scene->items().contains(item)) {
-            validItemsToUpdate.append(item);
+    // 清理待更新集合
+    for (auto it = m_itemsToUpdate.begin(); it != m_itemsToUpdate.end(); ) {
+        if (ItemRegistry::isInScene(*it, m_scene)) {
+            ++it;
+        } else {
+            it = m_itemsToUpdate.erase(it);
         }
     }
-    m_itemsToUpdate = validItemsToUpdate;
     
     // 只有在实际清理了内容时才输出日志
     if (invalidItems.size() > 0 || invalidConnectors.size() > 0) {
@@ -679,25 +1035,48 @@ void ConnectionManager::onItemPositionChanged()
 
 void ConnectionManager::onUpdateTimer()
 {
-    // 如果待更新列表为空，直接返回
-    if (m_itemsToUpdate.isEmpty()) {
+    // 如果没有待处理的元素和连接器，只需要把连接点的变化通知覆盖层
+    if (m_itemsToUpdate.isEmpty() && m_dirtyConnectors.isEmpty()) {
+        if (m_pointBoundsDirty) {
+            notifyOverlay();
+        }
         return;
     }
     
-    // 处理待更新的项目，过滤掉无效和重复的项目
-    QSet<FlowchartBaseItem*> uniqueItemsSet; // 使用Set去重
-    QList<FlowchartBaseItem*> validItemsToUpdate;
+    // 取出本帧的脏元素，处理过程中新标记的元素留到下一帧
+    QSet<FlowchartBaseItem*> dirtyItems;
+    dirtyItems.swap(m_itemsToUpdate);
+    
+    // 首次计算连接点的元素每帧限量处理，避免大量元素同时注册时阻塞
+    const int MAX_NEW_ITEMS_PER_BATCH = 5;
+    int newItemCount = 0;
+    bool needsSceneUpdate = false;
     bool hasInvalidItems = false;
     
-    for (FlowchartBaseItem* item : m_itemsToUpdate) {
-        if (item && item->scene() == m_scene) {
-            // 使用Set去重，避免重复处理同一个item
-            if (!uniqueItemsSet.contains(item)) {
-                uniqueItemsSet.insert(item);
-                validItemsToUpdate.append(item);
-            }
-        } else {
+    for (FlowchartBaseItem* item : dirtyItems) {
+        if (!ItemRegistry::isInScene(item, m_scene)) {
             hasInvalidItems = true;
+            continue;
+        }
+        
+        if (!m_connectionPoints.contains(item) || m_connectionPoints[item].isEmpty()) {
+            if (newItemCount >= MAX_NEW_ITEMS_PER_BATCH) {
+                m_itemsToUpdate.insert(item);
+                continue;
+            }
+            needsSceneUpdate = true;
+            ++newItemCount;
+        }
+        
+        // 刷新连接点，并通过邻接表收集受影响的连接器
+        const QRectF oldBounds = m_lastItemBounds.value(item);
+        calculateConnectionPoints(item);
+        markConnectorsDirty(item);
+        
+        // 元素的新旧位置挡住或让出了其他折线连接器的走廊时，重新路由这些连接器
+        const QRectF newBounds = m_lastItemBounds.value(item);
+        if (newBounds != oldBounds && !dynamic_cast<FlowchartConnectorItem*>(item)) {
+            invalidateRoutesAround(oldBounds, newBounds);
         }
     }
     
@@ -706,36 +1085,17 @@ void ConnectionManager::onUpdateTimer()
         cleanupInvalidItems();
     }
     
-    // 批量更新有效的项目，限制每次更新的数量避免阻塞
-    const int MAX_ITEMS_PER_BATCH = 5; // 每批最多处理5个项目
-    int processedCount = 0;
-    bool needsSceneUpdate = false;
-    QList<FlowchartBaseItem*> remainingItems;
-    
-    for (FlowchartBaseItem* item : validItemsToUpdate) {
-        if (processedCount >= MAX_ITEMS_PER_BATCH) {
-            // 超过批处理限制，将剩余项目留到下次处理
-            remainingItems.append(item);
-            continue;
-        }
-        
-        // 检查是否需要计算连接点
-        if (!m_connectionPoints.contains(item) || m_connectionPoints[item].isEmpty()) {
-            calculateConnectionPoints(item);
-            needsSceneUpdate = true;
-            processedCount++;
-        } else {
-            // 只有在连接真正存在时才更新连接
-            QList<Connection> connections = getConnectionsFor(item);
-            if (!connections.isEmpty()) {
-                updateConnections(item);
-                processedCount++;
-            }
-        }
+    // 每个连接器每帧只重建一次，两端同时更新
+    QSet<FlowchartConnectorItem*> dirtyConnectors;
+    dirtyConnectors.swap(m_dirtyConnectors);
+    for (FlowchartConnectorItem* connector : dirtyConnectors) {
+        rebuildConnector(connector);
     }
     
-    // 清空当前待更新列表，设置剩余项目
-    m_itemsToUpdate = remainingItems;
+    // 本帧所有连接点变化后只通知覆盖层一次
+    if (m_pointBoundsDirty) {
+        notifyOverlay();
+    }
     
     // 如果还有剩余项目需要处理，重新启动定时器
     if (!m_itemsToUpdate.isEmpty()) {
@@ -772,14 +1132,13 @@ void ConnectionManager::resolvePendingConnections(const QHash<QUuid, FlowchartBa
                 
                 // 如果连接成功，注册到ConnectionManager
                 if (connector->getStartItem() && connector->getEndItem()) {
-                    Connection connection(
+                    addConnectionRecord(Connection(
                         connector->getStartItem(),
                         connector->getStartPointIndex(),
                         connector->getEndItem(),
                         connector->getEndPointIndex(),
                         connector
-                    );
-                    m_connections.append(connection);
+                    ));
                     
                     // 标记连接点为已占用
                     if (m_connectionPoints.contains(connector->getStartItem()) && 
@@ -794,6 +1153,12 @@ void ConnectionManager::resolvePendingConnections(const QHash<QUuid, FlowchartBa
                         m_connectionPoints[connector->getEndItem()][connector->getEndPointIndex()].isOccupied = true;
                     }
                     
+                    // 加载的元素可能还未计算连接点，交给批量更新在连接点就绪后路由
+                    m_dirtyConnectors.insert(connector);
+                    if (!m_updateTimer->isActive()) {
+                        m_updateTimer->start();
+                    }
+                    
                     Logger::debug(QString("ConnectionManager::resolvePendingConnections: 连接成功 - 从%1到%2")
                         .arg(connector->getStartItem()->id())
                         .arg(connector->getEndItem()->id()));
@@ -860,10 +1225,12 @@ void ConnectionManager::prepareForSceneClear() {
     
     // 清除连接点数据
     m_connectionPoints.clear();
+    m_pointGrid.clear();
+    m_pointBoundsDirty = true;
     Logger::debug("ConnectionManager::prepareForSceneClear: 已清除连接点数据");
 
     // 清除连接关系数据
-    m_connections.clear();
+    clearConnectionRecords();
     Logger::debug("ConnectionManager::prepareForSceneClear: 已清除连接关系数据");
 
     // 重置可视化状态和高亮
@@ -878,6 +1245,7 @@ void ConnectionManager::prepareForSceneClear() {
         m_updateTimer->stop();
     }
     m_itemsToUpdate.clear();
+    m_dirtyConnectors.clear();
     m_lastItemBounds.clear();
     m_lastConnectionCount.clear();
     Logger::debug("ConnectionManager::prepareForSceneClear: 已清除待更新项和缓存");
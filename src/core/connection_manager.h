@@ -6,12 +6,17 @@
 #include <QPointF>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QPoint>
 #include <QTimer>
 #include <QPainter>
 #include <QGraphicsScene>
 #include <QUuid>
+#include <functional>
 #include "flowchart_base_item.h"
 #include "flowchart_connector_item.h"
+#include "orthogonal_router.h"
 
 class ConnectionPointOverlay;
 
@@ -93,6 +98,9 @@ public:
     void updateConnections(FlowchartBaseItem* item);
     void updateAllConnections();
     
+    // 标记元素已移动或需要刷新：下一帧统一刷新其连接点，并且每个受影响的连接器只重建一次
+    void markItemDirty(FlowchartBaseItem* item);
+    
     // 连接验证
     bool canConnect(FlowchartBaseItem* fromItem, FlowchartBaseItem* toItem) const;
     bool isConnected(FlowchartBaseItem* fromItem, FlowchartBaseItem* toItem) const;
@@ -100,6 +108,14 @@ public:
     // 获取连接信息
     QList<Connection> getConnectionsFor(FlowchartBaseItem* item) const;
     QList<Connection> getAllConnections() const { return m_connections; }
+    bool hasConnections(FlowchartBaseItem* item) const;
+    
+    // 查找连接器对应的连接（找不到时返回connector为nullptr的空连接）
+    Connection connectionFor(FlowchartConnectorItem* connector) const;
+    
+    // 按两端元素和连接点查找连接器，只遍历起始元素的出边
+    FlowchartConnectorItem* findConnector(FlowchartBaseItem* fromItem, int fromPointIndex,
+                                          FlowchartBaseItem* toItem, int toPointIndex) const;
     
     // 连接点高亮
     void highlightConnectionPoint(const ConnectionPoint& point);
@@ -108,12 +124,24 @@ public:
     // 用于ConnectionPointOverlay访问连接点数据
     const QMap<FlowchartBaseItem*, QList<ConnectionPoint>>& getConnectionPointsData() const { return m_connectionPoints; }
     
+    // 通过空间哈希访问与矩形相交的连接点（场景坐标），只检查矩形覆盖的网格单元
+    void visitConnectionPoints(const QRectF& rect, const std::function<void(const ConnectionPoint&)>& visitor) const;
+    
+    // 所有连接点位置的包围盒，连接点变化后首次调用时重新计算
+    QRectF connectionPointsBounds() const;
+    
+    // 连接点或可见性变化时通知覆盖层更新边界
+    void setOverlay(ConnectionPointOverlay* overlay) { m_overlay = overlay; }
+    
     // 设置参数
-    void setSnapTolerance(double tolerance) { m_snapTolerance = tolerance; }
+    void setSnapTolerance(double tolerance);
     double getSnapTolerance() const { return m_snapTolerance; }
     
     void setConnectionPointSize(double size) { m_connectionPointSize = size; }
     double getConnectionPointSize() const { return m_connectionPointSize; }
+    
+    // 折线连接器的避障路由器
+    OrthogonalRouter& router() { return m_router; }
 
     // 连接关系解析
     void resolvePendingConnections(const QHash<QUuid, FlowchartBaseItem*>& itemMap);
@@ -138,7 +166,27 @@ private:
     
     // 连接点数据
     QMap<FlowchartBaseItem*, QList<ConnectionPoint>> m_connectionPoints;
+    
+    // 连接点空间哈希：按吸附容差大小的网格单元索引连接点，吸附查询只检查附近单元
+    struct GridEntry {
+        FlowchartBaseItem* item;
+        int index;
+    };
+    QHash<quint64, QList<GridEntry>> m_pointGrid;
+    double m_gridCellSize;
+    mutable QRectF m_pointBounds;          // 连接点包围盒缓存
+    mutable bool m_pointBoundsDirty = true;
+    
+    // 连接关系：m_connections保存全部连接（删除时与末尾交换），
+    // m_connectionIndex记录连接器在m_connections中的位置，
+    // m_adjacency记录每个元素的出边/入边，按元素查询时只访问其自身的边
+    struct Adjacency {
+        QList<FlowchartConnectorItem*> outgoing;  // 以该元素为起点的连接器
+        QList<FlowchartConnectorItem*> incoming;  // 以该元素为终点的连接器
+    };
     QList<Connection> m_connections;
+    QHash<FlowchartConnectorItem*, int> m_connectionIndex;
+    QHash<FlowchartBaseItem*, Adjacency> m_adjacency;
     QList<PendingConnection> m_pendingConnections;
     
     // 可视化状态
@@ -155,7 +203,11 @@ private:
     
     // 更新控制
     QTimer* m_updateTimer;
-    QList<FlowchartBaseItem*> m_itemsToUpdate;
+    QSet<FlowchartBaseItem*> m_itemsToUpdate;            // 待刷新的元素
+    QSet<FlowchartConnectorItem*> m_dirtyConnectors;     // 本帧待重建的连接器
+    
+    // 折线连接器路由（缓存每条连接器的路径，元素移动时只重新路由受影响的连接器）
+    OrthogonalRouter m_router;
     
     // 性能优化缓存
     QMap<FlowchartBaseItem*, QRectF> m_lastItemBounds;  // 缓存元素的上次边界矩形
@@ -163,6 +215,38 @@ private:
     
     // 内部方法
     void calculateConnectionPoints(FlowchartBaseItem* item);
+    
+    // 连接点空间哈希维护（必须在m_connectionPoints[item]变化前后成对调用）
+    void indexConnectionPoints(FlowchartBaseItem* item);
+    void unindexConnectionPoints(FlowchartBaseItem* item);
+    void rebuildPointGrid();
+    
+    // 连接点变化后标记包围盒失效，下一帧统一通知覆盖层
+    void markPointBoundsDirty();
+    void notifyOverlay();
+    // 覆盖层可能随QGraphicsScene::clear()被删除，已删除时清空指针并返回false
+    bool hasOverlay();
+    QPoint gridCellOf(const QPointF& scenePos) const;
+    static quint64 gridKey(int cellX, int cellY);
+    
+    // 连接记录维护（同时更新m_connections、m_connectionIndex和m_adjacency）
+    void addConnectionRecord(const Connection& connection);
+    bool takeConnectionRecord(FlowchartConnectorItem* connector);
+    void clearConnectionRecords();
+    QList<FlowchartConnectorItem*> connectorsOf(FlowchartBaseItem* item) const;
+    
+    // 将元素的所有连接器加入本帧待重建集合
+    void markConnectorsDirty(FlowchartBaseItem* item);
+    
+    // 按两端连接点的当前位置重建连接器（起点和终点一次设置）
+    void rebuildConnector(FlowchartConnectorItem* connector);
+    
+    // 元素边界从oldBounds变为newBounds，走廊与其相交的折线连接器需要重新路由
+    void invalidateRoutesAround(const QRectF& oldBounds, const QRectF& newBounds);
+    
+    // 在容差范围内查找最近的连接点，没有则返回nullptr
+    ConnectionPoint* nearestConnectionPoint(const QPointF& scenePos, double tolerance,
+                                            FlowchartBaseItem* excludeItem);
     void drawConnectionPoints(QPainter* painter);
     void drawHighlight(QPainter* painter);
     
@@ -1,12 +1,22 @@
 #include "connection_point_overlay.h"
+#include "item_registry.h"
 #include <QGraphicsScene>
 #include <QStyleOptionGraphicsItem>
+#include <QVarLengthArray>
+#include <QtMath>
+
+// 标记位图在连接点大小之外留出的边框和抗锯齿空间（场景单位）
+static const qreal MARKER_PADDING = 4.0;
+// 标记位图的最大边长，放得很大时由位图缩放补足
+static const int MAX_MARKER_PIXELS = 256;
 
 ConnectionPointOverlay::ConnectionPointOverlay(ConnectionManager* manager)
     : QGraphicsItem()
     , m_connectionManager(manager)
     , m_visible(false)
     , m_hasHighlight(false)
+    , m_markerScale(0.0)
+    , m_markerSize(0.0)
 {
     // 确保覆盖层在最上层
     setZValue(1000);
@@ -24,50 +34,27 @@ ConnectionPointOverlay::ConnectionPointOverlay(ConnectionManager* manager)
     
     // 设置为透明，不接受任何点击
     setOpacity(1.0);
+    
+    // 需要exposedRect只绘制可见区域内的连接点
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    
+    // 登记存活状态，ConnectionManager据此判断覆盖层是否已被场景删除
+    ItemRegistry::add(this);
+}
+
+ConnectionPointOverlay::~ConnectionPointOverlay()
+{
+    ItemRegistry::remove(this);
 }
 
 QRectF ConnectionPointOverlay::boundingRect() const
 {
-    // 只有在真正需要绘制时才返回有效边界
-    if (!m_connectionManager || (!m_visible && !m_hasHighlight)) {
-        return QRectF(); // 返回空矩形，表示不需要绘制
-    }
-    
-    // 计算实际需要的绘制区域
+    // 可见连接点的边界在updateOverlay()中计算，高亮点可能在其之外
+    QRectF bounds = m_pointsBounds;
     if (m_hasHighlight) {
-        // 只为高亮点返回小的边界矩形
-        const double radius = 20.0; // 连接点绘制半径
-        QPointF pos = m_highlightedPoint.scenePos;
-        return QRectF(pos.x() - radius, pos.y() - radius, radius * 2, radius * 2);
+        bounds = bounds.united(highlightRect(m_highlightedPoint.scenePos));
     }
-    
-    if (m_visible && m_connectionManager->isConnectionPointsVisible()) {
-        // 计算所有可见连接点的边界
-        const auto& connectionPointsData = m_connectionManager->getConnectionPointsData();
-        QRectF totalBounds;
-        bool first = true;
-        
-        for (auto it = connectionPointsData.begin(); it != connectionPointsData.end(); ++it) {
-            const QList<ConnectionManager::ConnectionPoint>& points = it.value();
-            for (const ConnectionManager::ConnectionPoint& point : points) {
-                const double radius = 20.0;
-                QRectF pointBounds(point.scenePos.x() - radius, 
-                                  point.scenePos.y() - radius,
-                                  radius * 2, radius * 2);
-                
-                if (first) {
-                    totalBounds = pointBounds;
-                    first = false;
-                } else {
-                    totalBounds = totalBounds.united(pointBounds);
-                }
-            }
-        }
-        
-        return first ? QRectF() : totalBounds;
-    }
-    
-    return QRectF(); // 默认返回空矩形
+    return bounds;
 }
 
 QPainterPath ConnectionPointOverlay::shape() const
@@ -85,7 +72,6 @@ bool ConnectionPointOverlay::contains(const QPointF &point) const
 
 void ConnectionPointOverlay::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    Q_UNUSED(option)
     Q_UNUSED(widget)
     
     if (!m_connectionManager) {
@@ -94,27 +80,39 @@ void ConnectionPointOverlay::paint(QPainter *painter, const QStyleOptionGraphics
     
     painter->setRenderHint(QPainter::Antialiasing, true);
     
-    // 绘制所有可见的连接点
+    // 绘制暴露区域内的连接点
     if (m_connectionManager->isConnectionPointsVisible()) {
-        const auto& connectionPointsData = m_connectionManager->getConnectionPointsData();
+        const QRectF exposed = option ? option->exposedRect : boundingRect();
+        const qreal margin = markerMargin();
+        const QRectF queryRect = exposed.adjusted(-margin, -margin, margin, margin);
+        
+        // 按设备像素渲染标记位图，批量绘制时再缩放回场景单位
+        const qreal deviceScale = qSqrt(qAbs(painter->worldTransform().determinant())) *
+                                  painter->device()->devicePixelRatioF();
+        updateMarkerPixmaps(deviceScale);
+        const QRectF source(QPointF(0, 0), m_markerPixmaps[0].size());
+        const qreal fragmentScale = 1.0 / m_markerScale;
         
-        // 遍历所有注册的流程图元素的连接点
-        for (auto it = connectionPointsData.begin(); it != connectionPointsData.end(); ++it) {
-            const QList<ConnectionManager::ConnectionPoint>& points = it.value();
-            
-            for (const ConnectionManager::ConnectionPoint& point : points) {
-                // 检查是否为高亮点
-                bool isHighlighted = m_hasHighlight && 
-                                   m_highlightedPoint.item == point.item && 
-                                   m_highlightedPoint.index == point.index;
-                
-                drawConnectionPoint(painter, point, isHighlighted);
+        // 分别收集普通和已占用的连接点，高亮点最后单独绘制在上层
+        QVarLengthArray<QPainter::PixmapFragment, 64> fragments[2];
+        m_connectionManager->visitConnectionPoints(queryRect, [&](const ConnectionManager::ConnectionPoint& point) {
+            if (!point.item || isHighlighted(point)) {
+                return;
+            }
+            fragments[point.isOccupied ? 1 : 0].append(
+                QPainter::PixmapFragment::create(point.scenePos, source, fragmentScale, fragmentScale));
+        });
+        
+        painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+        for (int i = 0; i < 2; ++i) {
+            if (!fragments[i].isEmpty()) {
+                painter->drawPixmapFragments(fragments[i].constData(), fragments[i].size(), m_markerPixmaps[i]);
             }
         }
     }
     
-    // 绘制单独的高亮点（如果不在当前可见元素上）
-    if (m_hasHighlight && !m_connectionManager->isConnectionPointsVisible()) {
+    // 绘制高亮点
+    if (m_hasHighlight) {
         drawConnectionPoint(painter, m_highlightedPoint, true);
     }
 }
@@ -123,7 +121,7 @@ void ConnectionPointOverlay::setConnectionPointsVisible(bool visible)
 {
     if (m_visible != visible) {
         m_visible = visible;
-        update();
+        updateOverlay();
     }
 }
 
@@ -136,15 +134,22 @@ void ConnectionPointOverlay::setHighlightedPoint(const ConnectionManager::Connec
         return; // 已经高亮了同一个点，无需更新
     }
     
+    const QRectF oldRect = m_hasHighlight ? highlightRect(m_highlightedPoint.scenePos) : QRectF();
+    const QRectF newRect = highlightRect(point.scenePos);
+    
+    // 高亮点在连接点边界之外时边界会变化，否则覆盖层几何不变
+    if (!m_pointsBounds.contains(newRect) || (m_hasHighlight && !m_pointsBounds.contains(oldRect))) {
+        prepareGeometryChange();
+    }
+    
     m_highlightedPoint = point;
     m_hasHighlight = true;
     
-    // 只更新连接点周围的小区域而不是整个覆盖层
-    const double updateRadius = 20.0; // 连接点更新半径
-    QRectF updateRect(point.scenePos.x() - updateRadius, 
-                     point.scenePos.y() - updateRadius,
-                     updateRadius * 2, updateRadius * 2);
-    update(updateRect);
+    // 只更新新旧高亮点周围的小区域而不是整个覆盖层
+    if (!oldRect.isNull()) {
+        update(oldRect);
+    }
+    update(newRect);
 }
 
 void ConnectionPointOverlay::clearHighlight()
@@ -153,32 +158,90 @@ void ConnectionPointOverlay::clearHighlight()
         return; // 已经没有高亮，无需清除
     }
     
-    // 保存旧的高亮位置用于局部更新
-    QPointF oldHighlightPos = m_highlightedPoint.scenePos;
+    // 保存旧的高亮区域用于局部更新
+    const QRectF oldRect = highlightRect(m_highlightedPoint.scenePos);
+    if (!m_pointsBounds.contains(oldRect)) {
+        prepareGeometryChange();
+    }
     
     m_hasHighlight = false;
     m_highlightedPoint = ConnectionManager::ConnectionPoint(); // 重置为空
     
     // 只更新之前高亮点的区域
-    const double updateRadius = 20.0;
-    QRectF updateRect(oldHighlightPos.x() - updateRadius, 
-                     oldHighlightPos.y() - updateRadius,
-                     updateRadius * 2, updateRadius * 2);
-    update(updateRect);
+    update(oldRect);
 }
 
 void ConnectionPointOverlay::updateOverlay()
 {
+    QRectF bounds;
+    if (m_connectionManager && m_connectionManager->isConnectionPointsVisible() &&
+        !m_connectionManager->getConnectionPointsData().isEmpty()) {
+        const qreal margin = markerMargin();
+        bounds = m_connectionManager->connectionPointsBounds().adjusted(-margin, -margin, margin, margin);
+    }
+    
+    if (bounds != m_pointsBounds) {
+        prepareGeometryChange();
+        m_pointsBounds = bounds;
+    }
     update();
 }
 
+qreal ConnectionPointOverlay::markerMargin() const
+{
+    // 高亮时放大1.5倍并使用3像素边框
+    const double size = m_connectionManager ? m_connectionManager->getConnectionPointSize() : 0.0;
+    return size * 0.75 + 3.0;
+}
+
+QRectF ConnectionPointOverlay::highlightRect(const QPointF& scenePos) const
+{
+    const qreal margin = markerMargin();
+    return QRectF(scenePos.x() - margin, scenePos.y() - margin, margin * 2, margin * 2);
+}
+
+bool ConnectionPointOverlay::isHighlighted(const ConnectionManager::ConnectionPoint& point) const
+{
+    return m_hasHighlight && 
+           m_highlightedPoint.item == point.item && 
+           m_highlightedPoint.index == point.index;
+}
+
+void ConnectionPointOverlay::updateMarkerPixmaps(qreal deviceScale)
+{
+    const double size = m_connectionManager->getConnectionPointSize();
+    const qreal extent = size + MARKER_PADDING;
+    const int pixels = qBound(1, qCeil(extent * deviceScale), MAX_MARKER_PIXELS);
+    const qreal scale = pixels / extent;
+    
+    // 位图边长按整数像素取整，缩放的细微变化不会触发重新渲染
+    if (!m_markerPixmaps[0].isNull() && m_markerPixmaps[0].width() == pixels && m_markerSize == size) {
+        return;
+    }
+    
+    for (int i = 0; i < 2; ++i) {
+        QPixmap pixmap(pixels, pixels);
+        pixmap.fill(Qt::transparent);
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        painter.scale(scale, scale);
+        drawMarker(&painter, QPointF(extent / 2, extent / 2), size, false, i == 1);
+        painter.end();
+        m_markerPixmaps[i] = pixmap;
+    }
+    m_markerScale = scale;
+    m_markerSize = size;
+}
+
 void ConnectionPointOverlay::drawConnectionPoint(QPainter* painter, const ConnectionManager::ConnectionPoint& point, bool highlighted)
 {
     if (!point.item) return;
     
-    QPointF scenePos = point.scenePos;
-    double size = m_connectionManager->getConnectionPointSize();
-    
+    drawMarker(painter, point.scenePos, m_connectionManager->getConnectionPointSize(), highlighted, point.isOccupied);
+}
+
+void ConnectionPointOverlay::drawMarker(QPainter* painter, const QPointF& center, double size, bool highlighted, bool occupied)
+{
     // 设置样式
     if (highlighted) {
         painter->setPen(QPen(QColor(255, 120, 0), 3)); // 橙色高亮边框
@@ -190,15 +253,15 @@ void ConnectionPointOverlay::drawConnectionPoint(QPainter* painter, const Connec
     }
     
     // 绘制圆形连接点
-    QRectF rect(scenePos.x() - size/2, scenePos.y() - size/2, size, size);
+    QRectF rect(center.x() - size/2, center.y() - size/2, size, size);
     painter->drawEllipse(rect);
     
     // 如果连接点被占用，在中心绘制一个小点
-    if (point.isOccupied) {
+    if (occupied) {
         painter->setPen(Qt::NoPen);
         painter->setBrush(QBrush(Qt::red));
         double dotSize = size * 0.3;
-        QRectF dotRect(scenePos.x() - dotSize/2, scenePos.y() - dotSize/2, dotSize, dotSize);
+        QRectF dotRect(center.x() - dotSize/2, center.y() - dotSize/2, dotSize, dotSize);
         painter->drawEllipse(dotRect);
     }
-} 
\ No newline at end of file
+}
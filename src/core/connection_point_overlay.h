@@ -3,18 +3,21 @@
 
 #include <QGraphicsItem>
 #include <QPainter>
+#include <QPixmap>
 #include <QGraphicsScene>
 #include "connection_manager.h"
 
 /**
  * @brief 连接点可视化覆盖层
  * 
- * 负责在场景上层绘制连接点，独立于其他图形元素
+ * 负责在场景上层绘制连接点，独立于其他图形元素。
+ * 绘制时只通过连接管理器的空间哈希查询暴露区域内的连接点，
+ * 普通连接点使用按当前缩放预先渲染的标记位图一次批量绘制。
  */
 class ConnectionPointOverlay : public QGraphicsItem {
 public:
     explicit ConnectionPointOverlay(ConnectionManager* manager);
-    ~ConnectionPointOverlay() override = default;
+    ~ConnectionPointOverlay() override;
     
     // QGraphicsItem接口
     QRectF boundingRect() const override;
@@ -29,7 +32,7 @@ public:
     void setHighlightedPoint(const ConnectionManager::ConnectionPoint& point);
     void clearHighlight();
     
-    // 更新显示
+    // 连接点或其可见性变化后更新边界并重绘
     void updateOverlay();
 
 private:
@@ -38,7 +41,22 @@ private:
     bool m_hasHighlight;
     ConnectionManager::ConnectionPoint m_highlightedPoint;
     
+    // 可见连接点的边界（已包含标记半径），只在updateOverlay()中更新
+    QRectF m_pointsBounds;
+    
+    // 普通/已占用连接点的标记位图，连接点大小或设备缩放变化时重新渲染
+    QPixmap m_markerPixmaps[2];
+    qreal m_markerScale;
+    double m_markerSize;
+    
+    // 标记（含高亮时的放大和边框）超出连接点位置的最大距离
+    qreal markerMargin() const;
+    QRectF highlightRect(const QPointF& scenePos) const;
+    bool isHighlighted(const ConnectionManager::ConnectionPoint& point) const;
+    
+    void updateMarkerPixmaps(qreal deviceScale);
     void drawConnectionPoint(QPainter* painter, const ConnectionManager::ConnectionPoint& point, bool highlighted = false);
+    static void drawMarker(QPainter* painter, const QPointF& center, double size, bool highlighted, bool occupied);
 };
 
 #endif // CONNECTION_POINT_OVERLAY_H 
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "draw_strategy.h"
 #include <cmath>
+#include <algorithm>
 #include <QThread>
 
 void LineDrawStrategy::draw(QPainter* painter, const std::vector<QPointF>& points) {
@@ -107,18 +108,16 @@ void EllipseDrawStrategy::draw(QPainter* painter, const std::vector<QPointF>& po
 void BezierDrawStrategy::draw(QPainter* painter, const std::vector<QPointF>& points) {
     if (points.size() < 2) return;
 
-    // 计算控制点折线总长度
-    double totalPolylineLength = 0.0;
-    for (size_t i = 1; i < points.size(); ++i) {
-        totalPolylineLength += QLineF(points[i-1], points[i]).length();
-    }
+    // 按当前变换把屏幕空间容差换算到局部坐标
+    const qreal scale = std::sqrt(std::abs(painter->worldTransform().determinant()));
+    const qreal tolerance = DEFAULT_FLATNESS / (scale > 0 ? scale : 1.0);
+    
+    // 转换为分段三次曲线，交给Qt的光栅化器原生处理
+    drawPath(painter, toCubicPath(points, tolerance));
+}
 
-    // 动态步长计算
-    const double densityFactor = 5.0;  // 每单位长度5个点
-    const int minSteps = 20;           // 最小步数
-    const int maxSteps = 500;          // 最大步数
-    int numSteps = static_cast<int>(totalPolylineLength * densityFactor);
-    numSteps = std::clamp(numSteps, minSteps, maxSteps);    //clamp限制范围小于min，大于max改为min，max
+void BezierDrawStrategy::drawPath(QPainter* painter, const QPainterPath& path) {
+    if (path.isEmpty()) return;
     
     // 保存原始画笔
     QPen originalPen = painter->pen();
@@ -128,28 +127,159 @@ void BezierDrawStrategy::draw(QPainter* painter, const std::vector<QPointF>& poi
     pen.setColor(m_color);
     pen.setWidthF(m_lineWidth);
     painter->setPen(pen);
+    
+    painter->drawPath(path);
+    
+    // 恢复原始画笔
+    painter->setPen(originalPen);
+}
 
-    // 贝塞尔曲线绘制逻辑
+QPolygonF BezierDrawStrategy::flatten(const std::vector<QPointF>& controlPoints, qreal tolerance) {
+    QPolygonF polyline;
+    if (controlPoints.empty()) {
+        return polyline;
+    }
+    
+    polyline << controlPoints.front();
+    if (controlPoints.size() == 2) {
+        // 两个点退化为直线
+        polyline << controlPoints.back();
+        return polyline;
+    }
+    
+    const qreal minTolerance = 1e-3;
+    const qreal t = std::max(tolerance, minTolerance);
+    flattenRecursive(controlPoints, t * t, 0, polyline);
+    return polyline;
+}
+
+void BezierDrawStrategy::flattenRecursive(const std::vector<QPointF>& controlPoints, qreal toleranceSq,
+                                          int depth, QPolygonF& out) {
+    const size_t n = controlPoints.size();
+    const QPointF first = controlPoints.front();
+    const QPointF last = controlPoints.back();
+    
+    // 平坦度判定：曲线位于控制多边形的凸包内，
+    // 所有内部控制点到首尾弦的距离都不超过容差时，弦与曲线的偏差也不超过容差
+    const QPointF chord = last - first;
+    const qreal chordLengthSq = chord.x() * chord.x() + chord.y() * chord.y();
+    bool flat = true;
+    for (size_t i = 1; i + 1 < n && flat; ++i) {
+        const QPointF v = controlPoints[i] - first;
+        qreal distSq;
+        if (chordLengthSq <= 1e-12) {
+            distSq = v.x() * v.x() + v.y() * v.y();
+        } else {
+            const qreal cross = v.x() * chord.y() - v.y() * chord.x();
+            distSq = cross * cross / chordLengthSq;
+            // 控制点投影落在弦外时按到端点的距离计算，避免折返的曲线被拉直
+            const qreal dot = v.x() * chord.x() + v.y() * chord.y();
+            if (dot < 0) {
+                distSq = v.x() * v.x() + v.y() * v.y();
+            } else if (dot > chordLengthSq) {
+                const QPointF w = controlPoints[i] - last;
+                distSq = w.x() * w.x() + w.y() * w.y();
+            }
+        }
+        flat = distSq <= toleranceSq;
+    }
+    
+    if (flat || depth >= MAX_SUBDIVISION_DEPTH) {
+        out << last;
+        return;
+    }
+    
+    // 分割为左右两段，各自仍是n阶曲线
+    std::vector<QPointF> left;
+    std::vector<QPointF> right;
+    splitAtHalf(controlPoints, left, right);
+    
+    flattenRecursive(left, toleranceSq, depth + 1, out);
+    flattenRecursive(right, toleranceSq, depth + 1, out);
+}
+
+QPainterPath BezierDrawStrategy::toCubicPath(const std::vector<QPointF>& controlPoints, qreal tolerance) {
     QPainterPath path;
-    if (points.size() == 2) {
+    if (controlPoints.empty()) {
+        return path;
+    }
+    
+    path.moveTo(controlPoints.front());
+    if (controlPoints.size() == 2) {
         // 两个点退化为直线
-        path.moveTo(points[0]);
-        path.lineTo(points[1]);
-    } else {
-        // 伯恩斯坦公式
-        path.moveTo(points[0]);
-        for (int step = 1; step <= numSteps; ++step) {
-            double t = static_cast<double>(step) / numSteps;//t为插值参数
-            QPointF p = calculateBezierPoint(points, t);
-            path.lineTo(p);
+        path.lineTo(controlPoints.back());
+        return path;
+    }
+    
+    const qreal minTolerance = 1e-3;
+    fitCubicRecursive(controlPoints, std::max(tolerance, minTolerance), 0, path);
+    return path;
+}
+
+void BezierDrawStrategy::fitCubicRecursive(const std::vector<QPointF>& controlPoints, qreal tolerance,
+                                           int depth, QPainterPath& out) {
+    const size_t n = controlPoints.size();
+    const qreal degree = static_cast<qreal>(n - 1);
+    const QPointF first = controlPoints.front();
+    const QPointF last = controlPoints.back();
+    
+    // 三次曲线与原曲线在两端的位置和一阶导数一致：B'(0) = n(P1 - P0)，C'(0) = 3(C1 - C0)
+    const QPointF c1 = first + (controlPoints[1] - first) * (degree / 3.0);
+    const QPointF c2 = last - (last - controlPoints[n - 2]) * (degree / 3.0);
+    
+    if (n <= 4 || depth >= MAX_SUBDIVISION_DEPTH) {
+        out.cubicTo(c1, c2, last);
+        return;
+    }
+    
+    // 把三次曲线升阶到n阶后逐个比较控制点，差值曲线位于这些差向量的凸包内，
+    // 最大差值就是两条曲线偏差的上界
+    std::vector<QPointF> elevated = {first, c1, c2, last};
+    while (elevated.size() < n) {
+        const size_t m = elevated.size();
+        std::vector<QPointF> next(m + 1);
+        next[0] = elevated[0];
+        next[m] = elevated[m - 1];
+        for (size_t i = 1; i < m; ++i) {
+            const qreal a = static_cast<qreal>(i) / m;
+            next[i] = elevated[i - 1] * a + elevated[i] * (1.0 - a);
         }
+        elevated.swap(next);
     }
     
-    // 绘制路径
-    painter->drawPath(path);
+    const qreal toleranceSq = tolerance * tolerance;
+    bool withinTolerance = true;
+    for (size_t i = 2; i + 2 < n && withinTolerance; ++i) {
+        const QPointF d = controlPoints[i] - elevated[i];
+        withinTolerance = d.x() * d.x() + d.y() * d.y() <= toleranceSq;
+    }
     
-    // 恢复原始画笔
-    painter->setPen(originalPen);
+    if (withinTolerance) {
+        out.cubicTo(c1, c2, last);
+        return;
+    }
+    
+    std::vector<QPointF> left;
+    std::vector<QPointF> right;
+    splitAtHalf(controlPoints, left, right);
+    
+    fitCubicRecursive(left, tolerance, depth + 1, out);
+    fitCubicRecursive(right, tolerance, depth + 1, out);
+}
+
+void BezierDrawStrategy::splitAtHalf(const std::vector<QPointF>& controlPoints,
+                                     std::vector<QPointF>& left, std::vector<QPointF>& right) {
+    const size_t n = controlPoints.size();
+    std::vector<QPointF> work = controlPoints;
+    left.resize(n);
+    right.resize(n);
+    for (size_t level = 0; level < n; ++level) {
+        left[level] = work[0];
+        right[n - 1 - level] = work[n - 1 - level];
+        for (size_t i = 0; i + 1 < n - level; ++i) {
+            work[i] = (work[i] + work[i + 1]) * 0.5;
+        }
+    }
 }
 
 //贝塞尔曲线点计算(递推)
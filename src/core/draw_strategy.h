@@ -5,6 +5,7 @@
 #include <QPointF>
 #include <vector>
 #include <QPainterPath>
+#include <QPolygonF>
 #include <map>
 #include <utility> 
 
@@ -56,9 +57,46 @@ public:
     
     // 计算n阶Bezier曲线上的点
     QPointF calculateBezierPoint(const std::vector<QPointF>& controlPoints, double t) const;
+    
+    // 绘制已生成的曲线路径（由图形项缓存提供）
+    void drawPath(QPainter* painter, const QPainterPath& path);
+    
+    /**
+     * @brief 按平坦度容差自适应细分，将n阶Bezier曲线展平为折线
+     * @param controlPoints 控制点
+     * @param tolerance 折线到曲线的最大允许偏差（与控制点同一坐标系）
+     * @return 从第一个控制点到最后一个控制点的折线
+     */
+    static QPolygonF flatten(const std::vector<QPointF>& controlPoints, qreal tolerance);
+    
+    /**
+     * @brief 将n阶Bezier曲线转换为分段三次Bezier路径
+     * 
+     * 每段用端点和端点切线构造三次曲线（三阶及以下精确表示），误差超过容差时在中点分割。
+     * 误差由原曲线与升阶后三次曲线之差的控制点给出上界，因此结果保证在容差以内，
+     * 且各段之间切线连续。
+     * 
+     * @param controlPoints 控制点
+     * @param tolerance 三次曲线与原曲线的最大允许偏差（与控制点同一坐标系）
+     * @return 由moveTo和cubicTo（两点时为lineTo）组成的路径
+     */
+    static QPainterPath toCubicPath(const std::vector<QPointF>& controlPoints, qreal tolerance);
+    
+    // 屏幕空间的默认平坦度容差（像素）
+    static constexpr qreal DEFAULT_FLATNESS = 0.25;
+    
 private:
+    // 细分的最大深度，保证退化输入下也能结束
+    static constexpr int MAX_SUBDIVISION_DEPTH = 16;
     
-
+    static void flattenRecursive(const std::vector<QPointF>& controlPoints, qreal toleranceSq,
+                                 int depth, QPolygonF& out);
+    static void fitCubicRecursive(const std::vector<QPointF>& controlPoints, qreal tolerance,
+                                  int depth, QPainterPath& out);
+    
+    // de Casteljau算法在t=0.5处分割曲线
+    static void splitAtHalf(const std::vector<QPointF>& controlPoints,
+                            std::vector<QPointF>& left, std::vector<QPointF>& right);
 };
 
 #endif // DRAW_STRATEGY_H
\ No newline at end of file
@@ -49,32 +49,34 @@ QPainterPath EllipseGraphicItem::shape() const
 {
     // 如果使用自定义路径，返回自定义路径的形状
     if (m_useCustomPath && !m_customClipPath.isEmpty()) {
-        // 使用自定义裁剪路径作为形状
-        QPainterPath customShape = m_customClipPath;
+        // 使用自定义裁剪路径作为形状，考虑画笔宽度的影响扩展路径；
+        // 合并描边的代价较高，结果缓存到下次几何变化
+        return cachedShape(m_pen.width(), [this]() {
+            QPainterPathStroker stroker;
+            stroker.setWidth(m_pen.width());
+            return m_customClipPath.united(stroker.createStroke(m_customClipPath));
+        });
+    }
+    
+    return cachedShape(m_pen.width(), [this]() {
+        // 应用缩放因子计算实际尺寸
+        double scaledWidth = m_width * m_scale.x();
+        double scaledHeight = m_height * m_scale.y();
+        
+        // 创建一个椭圆形状的路径
+        QPainterPath path;
+        path.addEllipse(QRectF(
+            -scaledWidth/2, 
+            -scaledHeight/2,
+            scaledWidth,
+            scaledHeight
+        ));
         
         // 考虑画笔宽度的影响，使用strokePath扩展路径
         QPainterPathStroker stroker;
         stroker.setWidth(m_pen.width());
-        return customShape.united(stroker.createStroke(customShape));
-    }
-    
-    // 应用缩放因子计算实际尺寸
-    double scaledWidth = m_width * m_scale.x();
-    double scaledHeight = m_height * m_scale.y();
-    
-    // 创建一个椭圆形状的路径
-    QPainterPath path;
-    path.addEllipse(QRectF(
-        -scaledWidth/2, 
-        -scaledHeight/2,
-        scaledWidth,
-        scaledHeight
-    ));
-    
-    // 考虑画笔宽度的影响，使用strokePath扩展路径
-    QPainterPathStroker stroker;
-    stroker.setWidth(m_pen.width());
-    return path.united(stroker.createStroke(path));
+        return path.united(stroker.createStroke(path));
+    });
 }
 
 // 重写contains方法，实现更准确的椭圆内部检测
@@ -86,10 +88,13 @@ bool EllipseGraphicItem::contains(const QPointF& point) const
         QPointF localPoint = mapFromScene(point);
         
         // 检查点是否在路径内部或边缘上
-        // 考虑笔宽的影响
-        QPainterPathStroker stroker;
-        stroker.setWidth(m_pen.width() + 2.0); // 增加额外的容差
-        QPainterPath expandedPath = m_customClipPath.united(stroker.createStroke(m_customClipPath));
+        // 考虑笔宽的影响，增加额外的容差
+        const qreal hitWidth = m_pen.width() + 2.0;
+        const QPainterPath& expandedPath = cachedShape(hitWidth, [this, hitWidth]() {
+            QPainterPathStroker stroker;
+            stroker.setWidth(hitWidth);
+            return m_customClipPath.united(stroker.createStroke(m_customClipPath));
+        });
         return expandedPath.contains(localPoint);
     }
     
@@ -151,6 +156,8 @@ void EllipseGraphicItem::setWidth(double width)
 {
     // 确保宽度有效
     m_width = std::max(1.0, width);
+    markSpatialIndexDirty();
+    invalidateShapeCache();
     update();
 }
 
@@ -163,6 +170,8 @@ void EllipseGraphicItem::setHeight(double height)
 {
     // 确保高度有效
     m_height = std::max(1.0, height);
+    markSpatialIndexDirty();
+    invalidateShapeCache();
     update();
 }
 
@@ -171,6 +180,8 @@ void EllipseGraphicItem::setSize(double width, double height)
     // 确保尺寸有效
     m_width = std::max(1.0, width);
     m_height = std::max(1.0, height);
+    markSpatialIndexDirty();
+    invalidateShapeCache();
     update();
 }
 
@@ -194,6 +205,8 @@ void EllipseGraphicItem::setScale(const QPointF& scale)
                  .arg(m_height));
     
     // 更新图形
+    markSpatialIndexDirty();
+    invalidateShapeCache();
     update();
 }
 
@@ -213,26 +226,32 @@ bool EllipseGraphicItem::clip(const QPainterPath& clipPath)
     Logger::debug(QString("EllipseGraphicItem::clip: 原始形状边界: (%1,%2,%3,%4)")
         .arg(bounds.x()).arg(bounds.y()).arg(bounds.width()).arg(bounds.height()));
 
-    // 将裁剪路径转换为点集
-    std::vector<QPointF> clipPoints = ClipAlgorithms::pathToPoints(clipPath, 0.5);
-    Logger::debug(QString("EllipseGraphicItem::clip: 裁剪路径点数: %1").arg(clipPoints.size()));
+    // 使用裁剪算法计算路径交集
+    QPainterPath resultPath = ClipAlgorithms::clipPath(clipSubjectPath(), clipPath);
+    Logger::debug(QString("EllipseGraphicItem::clip: 裁剪结果元素数: %1")
+        .arg(resultPath.elementCount()));
+
+    return applyClipResult(resultPath);
+}
 
-    // 获取椭圆的路径
+QPainterPath EllipseGraphicItem::clipSubjectPath() const
+{
+    // 获取椭圆的路径并转换到场景坐标
     QPainterPath path = toPath();
-    // 转换到场景坐标
     QTransform toScene;
     toScene.translate(pos().x(), pos().y());
-    path = toScene.map(path);
+    return toScene.map(path);
+}
 
-    // 使用裁剪算法计算路径交集
-    QPainterPath resultPath = ClipAlgorithms::clipPath(path, clipPath);
-    Logger::debug(QString("EllipseGraphicItem::clip: 裁剪结果元素数: %1, 点数: %2")
-        .arg(resultPath.elementCount())
-        .arg(ClipAlgorithms::pathToPoints(resultPath, 0.5).size()));
+bool EllipseGraphicItem::applyClipResult(const QPainterPath& resultPath)
+{
+    // 获取椭圆的当前边界
+    QRectF bounds = boundingRect();
+    bounds.translate(pos());  // 转换为场景坐标
 
     // 检查结果是否为空
     if (resultPath.isEmpty()) {
-        Logger::warning("EllipseGraphicItem::clip: 裁剪结果为空，没有交集");
+        Logger::warning("EllipseGraphicItem::applyClipResult: 裁剪结果为空，没有交集");
         return false;
     }
 
@@ -260,19 +279,20 @@ bool EllipseGraphicItem::clip(const QPainterPath& clipPath)
         m_useCustomPath = false;
         
         // 更新缓存和图形显示
+        invalidateShapeCache();
         invalidateCache();
         update();
         
-        Logger::info(QString("EllipseGraphicItem::clip: 裁剪结果仍是椭圆，尺寸: %1x%2")
+        Logger::info(QString("EllipseGraphicItem::applyClipResult: 裁剪结果仍是椭圆，尺寸: %1x%2")
                     .arg(resultBounds.width())
                     .arg(resultBounds.height()));
     } else {
         // 非椭圆裁剪结果，转换为自定义形状
-        Logger::debug(QString("EllipseGraphicItem::clip: 裁剪结果不是椭圆，点数: %1")
+        Logger::debug(QString("EllipseGraphicItem::applyClipResult: 裁剪结果不是椭圆，点数: %1")
                      .arg(resultPoints.size()));
         
         if (resultPoints.size() < 3) {
-            Logger::warning("EllipseGraphicItem::clip: 裁剪结果点数不足，无法创建有效形状");
+            Logger::warning("EllipseGraphicItem::applyClipResult: 裁剪结果点数不足，无法创建有效形状");
             return false;
         }
         
@@ -289,7 +309,7 @@ bool EllipseGraphicItem::clip(const QPainterPath& clipPath)
         
         // 最后再次检查自定义路径是否有效
         if (m_customClipPath.isEmpty()) {
-            Logger::warning("EllipseGraphicItem::clip: 转换后的自定义路径为空，保持原图形不变");
+            Logger::warning("EllipseGraphicItem::applyClipResult: 转换后的自定义路径为空，保持原图形不变");
             return false;
         }
         
@@ -305,11 +325,11 @@ bool EllipseGraphicItem::clip(const QPainterPath& clipPath)
         
         // 如果点太多，尝试简化点集以提高性能
         if (resultPoints.size() > 100) {
-            Logger::debug("EllipseGraphicItem::clip: 尝试简化过多的点");
+            Logger::debug("EllipseGraphicItem::applyClipResult: 尝试简化过多的点");
             // 使用更大的flatness值重新生成路径点，减少点数
             std::vector<QPointF> simplifiedPoints = ClipAlgorithms::pathToPoints(m_customClipPath, 1.0);
             if (simplifiedPoints.size() >= 3 && simplifiedPoints.size() < resultPoints.size()) {
-                Logger::debug(QString("EllipseGraphicItem::clip: 成功简化点数从 %1 到 %2")
+                Logger::debug(QString("EllipseGraphicItem::applyClipResult: 成功简化点数从 %1 到 %2")
                              .arg(resultPoints.size())
                              .arg(simplifiedPoints.size()));
                 
@@ -321,10 +341,11 @@ bool EllipseGraphicItem::clip(const QPainterPath& clipPath)
         }
         
         // 更新缓存和图形显示
+        invalidateShapeCache();
         invalidateCache();
         update();
         
-        Logger::info(QString("EllipseGraphicItem::clip: 裁剪完成，转换为自定义形状，点数: %1")
+        Logger::info(QString("EllipseGraphicItem::applyClipResult: 裁剪完成，转换为自定义形状，点数: %1")
                     .arg(resultPoints.size()));
     }
     
@@ -336,7 +357,7 @@ bool EllipseGraphicItem::clip(const QPainterPath& clipPath)
     setFlag(QGraphicsItem::ItemIsSelectable, true);
     setFlag(QGraphicsItem::ItemSendsGeometryChanges, true);
     
-    Logger::debug(QString("EllipseGraphicItem::clip: 设置可移动状态为 %1").arg(wasMovable ? "可移动" : "不可移动"));
+    Logger::debug(QString("EllipseGraphicItem::applyClipResult: 设置可移动状态为 %1").arg(wasMovable ? "可移动" : "不可移动"));
     
     return true;
 }
@@ -412,6 +433,7 @@ void EllipseGraphicItem::restoreFromPoints(const std::vector<QPointF>& points)
         m_height = bounds.height();
         
         // 更新缓存和图形显示
+        invalidateShapeCache();
         invalidateCache();
         update();
         
@@ -434,6 +456,7 @@ void EllipseGraphicItem::restoreFromPoints(const std::vector<QPointF>& points)
     m_height = newHeight;
     
     // 更新缓存和图形显示
+    invalidateShapeCache();
     invalidateCache();
     update();
     
@@ -442,8 +465,22 @@ void EllipseGraphicItem::restoreFromPoints(const std::vector<QPointF>& points)
                 .arg(m_height));
 }
 
+QList<QPolygonF> EllipseGraphicItem::simplifiedOutline(qreal pixelSize) const
+{
+    Q_UNUSED(pixelSize);
+    
+    // 使用路径的扁平化多边形（包括自定义裁剪路径）
+    return toPath().toSubpathPolygons();
+}
+
 void EllipseGraphicItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
+    // 低细节层次交给基类处理（边界框或简化折线）
+    if (detailLevel(painter, option, widget) != DetailFull) {
+        GraphicItem::paint(painter, option, widget);
+        return;
+    }
+    
     // 使用自定义路径绘制非椭圆形状
     if (m_useCustomPath && !m_customClipPath.isEmpty()) {
         // 设置高质量渲染选项
@@ -35,6 +35,8 @@ public:
     
     // 重写裁剪相关方法
     bool clip(const QPainterPath& clipPath) override;
+    QPainterPath clipSubjectPath() const override;
+    bool applyClipResult(const QPainterPath& resultPath) override;
     QPainterPath toPath() const override;
     void restoreFromPoints(const std::vector<QPointF>& points) override;
     
@@ -45,6 +47,9 @@ protected:
     // 提供绘制点集合
     std::vector<QPointF> getDrawPoints() const override;
     
+    // 低细节层次下的简化轮廓
+    QList<QPolygonF> simplifiedOutline(qreal pixelSize) const override;
+    
 private:
     QPointF m_center; // 中心点（相对于图形项坐标系）
     double m_width;   // 宽度
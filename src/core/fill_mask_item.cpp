@@ -0,0 +1,147 @@
+#include "fill_mask_item.h"
+#include "../utils/logger.h"
+#include "../utils/graphics_utils.h"
+#include <QPainter>
+#include <QPixmap>
+#include <QPixmapCache>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+FillMaskItem::Mask FillMaskItem::encode(const QImage& original, const QImage& filled, const QRect& bounds)
+{
+    Mask mask;
+    const QRect rect = bounds.intersected(original.rect()).intersected(filled.rect());
+    if (rect.isEmpty() || original.size() != filled.size()) {
+        return mask;
+    }
+
+    // 按32位像素比较，格式不一致时先统一
+    const QImage a = original.format() == QImage::Format_ARGB32 ? original : original.convertToFormat(QImage::Format_ARGB32);
+    const QImage b = filled.format() == QImage::Format_ARGB32 ? filled : filled.convertToFormat(QImage::Format_ARGB32);
+
+    mask.size = rect.size();
+    mask.rowOffsets.reserve(static_cast<size_t>(rect.height()) + 1);
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        mask.rowOffsets.push_back(static_cast<quint32>(mask.runs.size() / 2));
+        const quint32* rowA = reinterpret_cast<const quint32*>(a.constScanLine(y)) + rect.left();
+        const quint32* rowB = reinterpret_cast<const quint32*>(b.constScanLine(y)) + rect.left();
+        mask.pixelCount += GraphicsUtils::appendDiffRuns(rowA, rowB, rect.width(), mask.runs);
+    }
+    mask.rowOffsets.push_back(static_cast<quint32>(mask.runs.size() / 2));
+    mask.runs.shrink_to_fit();
+    return mask;
+}
+
+FillMaskItem::FillMaskItem(const Mask& mask, const QColor& color, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      m_mask(mask),
+      m_color(color)
+{
+    static std::atomic<quint64> s_nextCacheId{1};
+    m_cacheId = s_nextCacheId.fetch_add(1);
+
+    // 需要exposedRect只栅格化可见分块
+    setFlag(ItemUsesExtendedStyleOption, true);
+
+    Logger::debug(QString("FillMaskItem: 创建填充图元 %1x%2，%3 个像素，编码 %4 字节")
+                  .arg(mask.size.width()).arg(mask.size.height())
+                  .arg(mask.pixelCount).arg(mask.byteSize()));
+}
+
+FillMaskItem::~FillMaskItem()
+{
+    // 释放缓存中属于本图元的分块
+    const int tilesX = (m_mask.size.width() + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (m_mask.size.height() + TILE_SIZE - 1) / TILE_SIZE;
+    for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            QPixmapCache::remove(tileKey(tx, ty));
+        }
+    }
+}
+
+QRectF FillMaskItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), QSizeF(m_mask.size));
+}
+
+QString FillMaskItem::tileKey(int tileX, int tileY) const
+{
+    return QString("fillmask_%1_%2_%3").arg(m_cacheId).arg(tileX).arg(tileY);
+}
+
+QImage FillMaskItem::rasterize(const QRect& rect) const
+{
+    const QRect area = rect.intersected(QRect(QPoint(0, 0), m_mask.size));
+    if (area.isEmpty()) {
+        return QImage();
+    }
+
+    QImage image(area.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    const quint32 pixel = qPremultiply(m_color.rgba());
+
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        quint32* row = reinterpret_cast<quint32*>(image.scanLine(y - area.top()));
+        const quint32 first = m_mask.rowOffsets[y];
+        const quint32 last = m_mask.rowOffsets[y + 1];
+        for (quint32 r = first; r < last; ++r) {
+            const int start = m_mask.runs[2 * r];
+            const int end = start + m_mask.runs[2 * r + 1];
+            if (end <= area.left()) {
+                continue;
+            }
+            if (start > area.right()) {
+                break;  // 同一行的行程按起点递增
+            }
+            const int from = qMax(start, area.left()) - area.left();
+            const int to = qMin(end, area.right() + 1) - area.left();
+            std::fill(row + from, row + to, pixel);
+        }
+    }
+    return image;
+}
+
+void FillMaskItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(widget);
+
+    if (m_mask.isEmpty()) {
+        return;
+    }
+
+    const QRectF exposed = option ? option->exposedRect.intersected(boundingRect()) : boundingRect();
+    if (exposed.isEmpty()) {
+        return;
+    }
+
+    // 只处理与可见区域相交的分块
+    const int tileLeft = qMax(0, static_cast<int>(std::floor(exposed.left())) / TILE_SIZE);
+    const int tileTop = qMax(0, static_cast<int>(std::floor(exposed.top())) / TILE_SIZE);
+    const int tileRight = static_cast<int>(std::ceil(exposed.right()) - 1) / TILE_SIZE;
+    const int tileBottom = static_cast<int>(std::ceil(exposed.bottom()) - 1) / TILE_SIZE;
+
+    for (int ty = tileTop; ty <= tileBottom; ++ty) {
+        // 整行分块都没有行程时跳过
+        const int rowStart = ty * TILE_SIZE;
+        const int rowEnd = qMin(rowStart + TILE_SIZE, m_mask.size.height());
+        if (m_mask.rowOffsets[rowStart] == m_mask.rowOffsets[rowEnd]) {
+            continue;
+        }
+
+        for (int tx = tileLeft; tx <= tileRight; ++tx) {
+            const QRect tileRect(tx * TILE_SIZE, rowStart, TILE_SIZE, TILE_SIZE);
+            const QString key = tileKey(tx, ty);
+            QPixmap tile;
+            if (!QPixmapCache::find(key, &tile)) {
+                tile = QPixmap::fromImage(rasterize(tileRect));
+                QPixmapCache::insert(key, tile);
+            }
+            if (!tile.isNull()) {
+                painter->drawPixmap(tileRect.topLeft(), tile);
+            }
+        }
+    }
+}
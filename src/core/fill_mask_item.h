@@ -0,0 +1,76 @@
+#ifndef FILL_MASK_ITEM_H
+#define FILL_MASK_ITEM_H
+
+#include <QGraphicsItem>
+#include <QColor>
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <vector>
+
+/**
+ * @brief 位图填充结果图元
+ *
+ * 只保存填充区域包围盒内的行程编码掩码和一个颜色，而不是覆盖整个场景的位图。
+ * 绘制时按分块(tile)将可见部分栅格化为QPixmap，并放入QPixmapCache按需淘汰，
+ * 因此撤销栈和场景中的每个填充只占用与填充轮廓复杂度成正比的内存。
+ */
+class FillMaskItem : public QGraphicsItem {
+public:
+    /**
+     * @brief 行程编码掩码
+     *
+     * 每行由若干 [起点, 长度] 对组成，坐标相对于掩码左上角；
+     * rowOffsets[y] 到 rowOffsets[y + 1] 之间是第y行的行程（以对为单位）。
+     */
+    struct Mask {
+        QSize size;
+        std::vector<quint32> rowOffsets;
+        std::vector<qint32> runs;
+        int pixelCount = 0;
+
+        bool isEmpty() const { return pixelCount == 0; }
+
+        // 编码数据占用的字节数
+        qsizetype byteSize() const {
+            return static_cast<qsizetype>(rowOffsets.size() * sizeof(quint32) + runs.size() * sizeof(qint32));
+        }
+    };
+
+    /**
+     * @brief 由填充前后的图像编码掩码，两幅图像在bounds内不同的像素即为填充像素
+     * @param original 填充前的图像
+     * @param filled 填充后的图像
+     * @param bounds 填充区域的包围盒（图像坐标）
+     * @return 掩码，坐标相对于bounds左上角
+     */
+    static Mask encode(const QImage& original, const QImage& filled, const QRect& bounds);
+
+    FillMaskItem(const Mask& mask, const QColor& color, QGraphicsItem* parent = nullptr);
+    ~FillMaskItem() override;
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+    QColor color() const { return m_color; }
+    const Mask& mask() const { return m_mask; }
+
+    /**
+     * @brief 将掩码在指定矩形内的部分栅格化
+     * @param rect 掩码坐标中的矩形
+     * @return 预乘ARGB图像，未填充处透明
+     */
+    QImage rasterize(const QRect& rect) const;
+
+private:
+    // 分块边长（像素）
+    static constexpr int TILE_SIZE = 256;
+
+    Mask m_mask;
+    QColor m_color;
+    quint64 m_cacheId;   // 分块缓存键前缀，避免与已销毁图元的地址复用冲突
+
+    QString tileKey(int tileX, int tileY) const;
+};
+
+#endif // FILL_MASK_ITEM_H
@@ -49,11 +49,16 @@ void FlowchartBaseItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
     GraphicItem::hoverLeaveEvent(event);
 }
 
-void FlowchartBaseItem::drawText(QPainter* painter, const QRectF& rect)
+void FlowchartBaseItem::drawText(QPainter* painter, const QRectF& rect, const QWidget* widget)
 {
     if (!m_textVisible || m_text.isEmpty())
         return;
     
+    // 文字在屏幕上小于几个像素时无法辨认，跳过排版和绘制（导出时始终绘制）
+    const qreal fontSize = m_textFont.pointSizeF() > 0 ? m_textFont.pointSizeF() : m_textFont.pixelSize();
+    if (isBelowScreenSize(painter, widget, fontSize, MIN_TEXT_SCREEN_SIZE))
+        return;
+    
     // 保存画笔状态
     painter->save();
     
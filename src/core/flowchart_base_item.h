@@ -65,8 +65,11 @@ protected:
     // 鼠标拖动相关
     QPointF m_lastMousePos;
     
+    // 文本在屏幕上的最小可见字号（像素），低于此值时不绘制文本
+    static constexpr qreal MIN_TEXT_SCREEN_SIZE = 3.0;
+    
     // 绘制文本的辅助方法
-    void drawText(QPainter* painter, const QRectF& rect);
+    void drawText(QPainter* painter, const QRectF& rect, const QWidget* widget);
     
     // 处理双击事件以编辑文本
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event) override;
@@ -40,13 +40,18 @@ FlowchartConnectorItem::FlowchartConnectorItem(const QPointF& startPoint, const
 
 QRectF FlowchartConnectorItem::boundingRect() const
 {
-    // 返回路径的边界矩形，添加额外空间用于箭头
-    QRectF baseRect = m_path.boundingRect();
-    return baseRect.adjusted(-m_arrowSize, -m_arrowSize, m_arrowSize, m_arrowSize);
+    // 路径的边界矩形加上箭头空间，在updatePath()中计算
+    return m_boundingRect;
 }
 
 void FlowchartConnectorItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
+    // 缩小到只有几个像素时按边界框绘制或跳过
+    const DetailLevel level = detailLevel(painter, option, widget);
+    if (paintLowDetail(painter, level)) {
+        return;
+    }
+    
     // 调用基类的绘制方法
     FlowchartBaseItem::paint(painter, option, widget);
     
@@ -57,8 +62,8 @@ void FlowchartConnectorItem::paint(QPainter* painter, const QStyleOptionGraphics
     // 绘制路径
     painter->drawPath(m_path);
     
-    // 绘制箭头
-    if (m_path.length() > 0) {
+    // 绘制箭头（箭头在屏幕上不足一个像素时跳过，导出时始终绘制）
+    if (m_path.length() > 0 && !isBelowScreenSize(painter, widget, m_arrowSize, 1.0)) {
         // 设置箭头填充色
         painter->setBrush(m_pen.color());
         
@@ -120,11 +125,12 @@ void FlowchartConnectorItem::drawArrow(QPainter* painter, const QPointF& point,
 
 QPainterPath FlowchartConnectorItem::shape() const
 {
-    // 创建一个宽一点的路径，便于选择
-    QPainterPath path = m_path;
-    QPainterPathStroker stroker;
-    stroker.setWidth(8); // 使线条选择区域宽一些，便于用户选择
-    return stroker.createStroke(path);
+    // 创建一个宽一点的路径，便于选择；描边结果缓存到下次updatePath()
+    return cachedShape(HIT_WIDTH, [this]() {
+        QPainterPathStroker stroker;
+        stroker.setWidth(HIT_WIDTH);
+        return stroker.createStroke(m_path);
+    });
 }
 
 QPainterPath FlowchartConnectorItem::toPath() const
@@ -152,8 +158,34 @@ std::vector<QPointF> FlowchartConnectorItem::getDrawPoints() const
     return points;
 }
 
+void FlowchartConnectorItem::setEndpoints(const QPointF& start, const QPointF& end)
+{
+    if (start == m_startPoint && end == m_endPoint) {
+        return;
+    }
+    
+    m_startPoint = start;
+    m_endPoint = end;
+    updatePath();
+}
+
+void FlowchartConnectorItem::setEndpoints(const QPointF& start, const QPointF& end, const QList<QPointF>& routePoints)
+{
+    if (start == m_startPoint && end == m_endPoint && routePoints == m_routePoints) {
+        return;
+    }
+    
+    m_startPoint = start;
+    m_endPoint = end;
+    m_routePoints = routePoints;
+    updatePath();
+}
+
 void FlowchartConnectorItem::updatePath()
 {
+    // 路径决定边界矩形，先通知场景几何即将变化
+    prepareGeometryChange();
+    
     // 根据连接类型创建路径
     switch (m_connectorType) {
         case ConnectorType::StraightLine:
@@ -166,8 +198,10 @@ void FlowchartConnectorItem::updatePath()
             m_path = createOrthogonalPath();
             break;
     }
+    m_boundingRect = m_path.boundingRect().adjusted(-m_arrowSize, -m_arrowSize, m_arrowSize, m_arrowSize);
     
-    // 更新缓存
+    // 更新缓存和命中形状
+    invalidateShapeCache();
     invalidateCache();
     update();
 }
@@ -193,6 +227,12 @@ QPainterPath FlowchartConnectorItem::createOrthogonalPath() const
             path.lineTo(point);
         }
         path.lineTo(m_endPoint);
+    } else if (!m_routePoints.isEmpty()) {
+        // 使用路由器计算的绕行拐点
+        for (const QPointF& point : m_routePoints) {
+            path.lineTo(point);
+        }
+        path.lineTo(m_endPoint);
     } else {
         // 否则，自动创建正交线
         // 计算中点
@@ -252,6 +292,7 @@ void FlowchartConnectorItem::restoreFromPoints(const std::vector<QPointF>& point
         for (size_t i = 2; i < points.size(); ++i) {
             m_controlPoints.append(points[i]);
         }
+        m_routePoints.clear();
         
         // 更新路径
         updatePath();
@@ -57,6 +57,12 @@ public:
     // 设置起点和终点
     void setStartPoint(const QPointF& point) { m_startPoint = point; updatePath(); }
     void setEndPoint(const QPointF& point) { m_endPoint = point; updatePath(); }
+    // 同时设置起点和终点，只重建一次路径（端点均未变化时不做任何事）
+    void setEndpoints(const QPointF& start, const QPointF& end);
+    
+    // 同时设置起点、终点和自动路由的中间拐点（仅在没有手动控制点的折线中使用）
+    void setEndpoints(const QPointF& start, const QPointF& end, const QList<QPointF>& routePoints);
+    QList<QPointF> getRoutePoints() const { return m_routePoints; }
     QPointF getStartPoint() const { return m_startPoint; }
     QPointF getEndPoint() const { return m_endPoint; }
     
@@ -104,8 +110,15 @@ private:
     // 控制点（用于曲线和折线）
     QList<QPointF> m_controlPoints;
     
-    // 路径
+    // 路由器计算的折线拐点（不含起点和终点）
+    QList<QPointF> m_routePoints;
+    
+    // 路径及其边界矩形（含箭头空间）
     QPainterPath m_path;
+    QRectF m_boundingRect;
+    
+    // 命中测试的描边宽度
+    static constexpr qreal HIT_WIDTH = 8.0;
     
     // 箭头大小
     qreal m_arrowSize = 10.0;
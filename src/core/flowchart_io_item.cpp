@@ -35,6 +35,15 @@ QRectF FlowchartIOItem::boundingRect() const
 
 void FlowchartIOItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
+    // 缩小到只有几个像素时按边界框绘制或跳过，较小时关闭抗锯齿
+    const DetailLevel level = detailLevel(painter, option, widget);
+    if (paintLowDetail(painter, level)) {
+        return;
+    }
+    if (level == DetailSimplified) {
+        painter->setRenderHint(QPainter::Antialiasing, false);
+    }
+    
     // 使用缓存时调用基类方法
     if (m_cachingEnabled && !m_cacheInvalid) {
         GraphicItem::paint(painter, option, widget);
@@ -59,7 +68,7 @@ void FlowchartIOItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *o
     painter->drawPolygon(parallelogram);
     
     // 绘制文本
-    drawText(painter, rect);
+    drawText(painter, rect, widget);
     
     // 如果被选中，绘制选择控制点
     if (option->state & QStyle::State_Selected) {
@@ -33,6 +33,15 @@ QRectF FlowchartStartEndItem::boundingRect() const
 
 void FlowchartStartEndItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
+    // 缩小到只有几个像素时按边界框绘制或跳过，较小时关闭抗锯齿
+    const DetailLevel level = detailLevel(painter, option, widget);
+    if (paintLowDetail(painter, level)) {
+        return;
+    }
+    if (level == DetailSimplified) {
+        painter->setRenderHint(QPainter::Antialiasing, false);
+    }
+    
     // 使用缓存时调用基类方法
     if (m_cachingEnabled && !m_cacheInvalid) {
         GraphicItem::paint(painter, option, widget);
@@ -47,7 +56,7 @@ void FlowchartStartEndItem::paint(QPainter *painter, const QStyleOptionGraphicsI
     painter->drawRoundedRect(rect, m_cornerRadius, m_cornerRadius);
     
     // 绘制文本
-    drawText(painter, rect);
+    drawText(painter, rect, widget);
     
     // 如果被选中，绘制选择控制点
     if (option->state & QStyle::State_Selected) {
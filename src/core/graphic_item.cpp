@@ -8,8 +8,16 @@
 #include <cmath>
 #include <QCryptographicHash>
 #include "draw_strategy.h"
+#include "spatial_index.h"
+#include "item_registry.h"
 #include <QApplication>
 
+// LOD默认阈值（屏幕像素）
+bool GraphicItem::s_lodEnabled = true;
+qreal GraphicItem::s_lodHiddenSize = 1.0;
+qreal GraphicItem::s_lodBoxSize = 4.0;
+qreal GraphicItem::s_lodSimplifiedSize = 24.0;
+
 GraphicItem::GraphicItem()
 {
     // 设置必要的标志，包括可选择和可移动
@@ -23,6 +31,18 @@ GraphicItem::GraphicItem()
     // 设置默认画笔和画刷
     m_pen = QPen(Qt::black, 2); // 调整默认线宽与原Graphic一致
     m_brush = QBrush(Qt::transparent);
+
+    ItemRegistry::add(this);
+}
+
+GraphicItem::~GraphicItem()
+{
+    ItemRegistry::remove(this);
+
+    // 从场景空间索引中移除，避免索引持有悬空指针
+    if (SpatialIndex* index = SpatialIndex::forScene(scene())) {
+        index->remove(this);
+    }
 }
 
 // 从Graphic类迁移的绘制方法
@@ -55,6 +75,37 @@ QRectF GraphicItem::boundingRect() const
 
 void GraphicItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
+    // 缩小到只有几个像素时，按边界框绘制或直接跳过
+    const DetailLevel level = detailLevel(painter, option, widget);
+    if (paintLowDetail(painter, level)) {
+        return;
+    }
+    
+    // 较小时绘制抽稀后的折线，不使用抗锯齿
+    if (level == DetailSimplified) {
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        painter->setPen(m_pen);
+        
+        const qreal pixelSize = 1.0 / option->levelOfDetailFromTransform(painter->worldTransform());
+        const QList<QPolygonF> outline = (m_useCustomPath && !m_customClipPath.isEmpty())
+            ? m_customClipPath.toSubpathPolygons()
+            : simplifiedOutline(pixelSize);
+        for (const QPolygonF& polyline : outline) {
+            const QPolygonF decimated = decimatePolyline(polyline, pixelSize);
+            if (decimated.size() > 2 && decimated.isClosed() && !m_useCustomPath) {
+                painter->setBrush(m_brush);
+                painter->drawPolygon(decimated);
+            } else {
+                painter->drawPolyline(decimated);
+            }
+        }
+        
+        if (isSelected()) {
+            drawSelectionHandles(painter);
+        }
+        return;
+    }
+    
     // 设置抗锯齿和高质量渲染
     painter->setRenderHint(QPainter::Antialiasing);
     painter->setRenderHint(QPainter::SmoothPixmapTransform);
@@ -107,6 +158,102 @@ void GraphicItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* optio
     }
 }
 
+void GraphicItem::setLevelOfDetailThresholds(qreal hiddenBelow, qreal boxBelow, qreal simplifiedBelow)
+{
+    s_lodHiddenSize = qMax<qreal>(0.0, hiddenBelow);
+    s_lodBoxSize = qMax(s_lodHiddenSize, boxBelow);
+    s_lodSimplifiedSize = qMax(s_lodBoxSize, simplifiedBelow);
+}
+
+GraphicItem::DetailLevel GraphicItem::detailLevel(const QPainter* painter, const QStyleOptionGraphicsItem* option,
+                                                  const QWidget* widget) const
+{
+    // 导出、填充取样等离屏渲染没有widget，始终完整绘制
+    if (!s_lodEnabled || !painter || !option || !widget) {
+        return DetailFull;
+    }
+    
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    const QRectF bounds = boundingRect();
+    const qreal screenExtent = qMax(bounds.width(), bounds.height()) * lod;
+    
+    // 选中的图形至少保留边界框，避免选中后“消失”
+    if (screenExtent < s_lodHiddenSize && !isSelected()) {
+        return DetailHidden;
+    }
+    if (screenExtent < s_lodBoxSize) {
+        return DetailBox;
+    }
+    if (screenExtent < s_lodSimplifiedSize) {
+        return DetailSimplified;
+    }
+    return DetailFull;
+}
+
+bool GraphicItem::isBelowScreenSize(const QPainter* painter, const QWidget* widget,
+                                    qreal extent, qreal minScreenSize) const
+{
+    if (!s_lodEnabled || !painter || !widget) {
+        return false;
+    }
+    return extent * QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()) < minScreenSize;
+}
+
+bool GraphicItem::paintLowDetail(QPainter* painter, DetailLevel level)
+{
+    if (level == DetailHidden) {
+        return true;
+    }
+    if (level == DetailBox) {
+        // 用画刷颜色填充边界框，透明画刷时使用线条颜色
+        QColor color = m_brush.color();
+        if (m_brush.style() == Qt::NoBrush || color.alpha() == 0) {
+            color = m_pen.color();
+        }
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        painter->fillRect(boundingRect(), color);
+        
+        if (isSelected()) {
+            drawSelectionHandles(painter);
+        }
+        return true;
+    }
+    return false;
+}
+
+QList<QPolygonF> GraphicItem::simplifiedOutline(qreal pixelSize) const
+{
+    Q_UNUSED(pixelSize);
+    
+    // 默认将绘制点依次连接，适用于直线等由关键点组成的图形
+    QPolygonF polyline;
+    for (const QPointF& point : getDrawPoints()) {
+        polyline << point;
+    }
+    return {polyline};
+}
+
+QPolygonF GraphicItem::decimatePolyline(const QPolygonF& polyline, qreal tolerance)
+{
+    if (polyline.size() <= 2 || tolerance <= 0.0) {
+        return polyline;
+    }
+    
+    // 径向距离抽稀：丢弃与上一个保留点距离小于容差的点
+    QPolygonF result;
+    result.reserve(polyline.size());
+    result << polyline.first();
+    const qreal toleranceSquared = tolerance * tolerance;
+    for (int i = 1; i < polyline.size() - 1; ++i) {
+        const QPointF delta = polyline.at(i) - result.last();
+        if (QPointF::dotProduct(delta, delta) >= toleranceSquared) {
+            result << polyline.at(i);
+        }
+    }
+    result << polyline.last();
+    return result;
+}
+
 void GraphicItem::drawSelectionHandles(QPainter* painter)
 {
     // 绘制选择框
@@ -291,6 +438,7 @@ void GraphicItem::setScale(const QPointF& scale)
 {
     if (m_scale != scale) {
         m_scale = scale;
+        invalidateShapeCache();
         invalidateCache();
         update();
     }
@@ -301,6 +449,7 @@ void GraphicItem::setScale(qreal scale)
     QPointF newScale(scale, scale);
     if (m_scale != newScale) {
         m_scale = newScale;
+        invalidateShapeCache();
         invalidateCache();
         update();
     }
@@ -344,6 +493,7 @@ void GraphicItem::setPen(const QPen &pen)
 {
     if (m_pen != pen) {
         m_pen = pen;
+        invalidateShapeCache();
         invalidateCache();
         update();
     }
@@ -397,7 +547,23 @@ QVariant GraphicItem::itemChange(GraphicsItemChange change, const QVariant &valu
     else if (change == ItemPositionHasChanged) {
         // 位置已经改变，更新相关状态
         invalidateCache();
-        // 这里可以添加任何在位置变化后需要执行的逻辑
+        markSpatialIndexDirty();
+    }
+    // 即将离开当前场景，从旧场景的空间索引中移除
+    else if (change == ItemSceneChange) {
+        if (SpatialIndex* index = SpatialIndex::forScene(scene())) {
+            index->remove(this);
+        }
+    }
+    // 加入新场景或变换改变后，等待空间索引刷新
+    else if (change == ItemSceneHasChanged) {
+        ItemRegistry::setScene(this, value.value<QGraphicsScene*>());
+        markSpatialIndexDirty();
+    }
+    else if (change == ItemTransformHasChanged ||
+             change == ItemRotationHasChanged ||
+             change == ItemScaleHasChanged) {
+        markSpatialIndexDirty();
     }
     
     return QGraphicsItem::itemChange(change, value);
@@ -421,12 +587,35 @@ void GraphicItem::enableCaching(bool enable) {
 
 // 使缓存无效
 void GraphicItem::invalidateCache() {
+    // 缓存失效通常意味着几何或外观改变，同时刷新空间索引中的边界；
+    // 命中形状位于本地坐标系，平移/旋转时仍然有效，只由几何和画笔的设置函数清空
+    markSpatialIndexDirty();
+    
     if (m_cachingEnabled) {
         m_cacheInvalid = true;
         update(); // 触发重绘以更新缓存
     }
 }
 
+// 标记空间索引中的边界需要刷新
+void GraphicItem::markSpatialIndexDirty() {
+    if (SpatialIndex* index = SpatialIndex::forScene(scene())) {
+        index->markDirty(this);
+    }
+}
+
+const QPainterPath& GraphicItem::cachedShape(qreal strokeWidth, const std::function<QPainterPath()>& build) const {
+    auto it = m_shapeCache.find(strokeWidth);
+    if (it == m_shapeCache.end()) {
+        it = m_shapeCache.insert(strokeWidth, build());
+    }
+    return it.value();
+}
+
+void GraphicItem::invalidateShapeCache() {
+    m_shapeCache.clear();
+}
+
 // 悬停进入事件处理
 void GraphicItem::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
@@ -709,6 +898,19 @@ bool GraphicItem::clip(const QPainterPath& clipPath)
     return false;
 }
 
+QPainterPath GraphicItem::clipSubjectPath() const
+{
+    // 基类不支持批量裁剪
+    return QPainterPath();
+}
+
+bool GraphicItem::applyClipResult(const QPainterPath& resultPath)
+{
+    Q_UNUSED(resultPath);
+    Logger::warning("GraphicItem::applyClipResult: 基类默认实现被调用，未执行实际裁剪");
+    return false;
+}
+
 QPainterPath GraphicItem::toPath() const
 {
     // 基类默认实现，子类应该重写以提供正确的路径表示
@@ -14,6 +14,10 @@
 #include <QDataStream>
 #include <QString>
 #include <QPainterPath>
+#include <QPolygonF>
+#include <QList>
+#include <QMap>
+#include <functional>
 
 class DrawStrategy;
 
@@ -61,7 +65,7 @@ public:
     }
 
     GraphicItem();
-    virtual ~GraphicItem() = default;
+    virtual ~GraphicItem();
     
     // QGraphicsItem接口
     QRectF boundingRect() const override;
@@ -152,6 +156,19 @@ public:
     // 获取控制点大小
     static int getHandleSize() { return HANDLE_SIZE; }
 
+    // 细节层次（LOD）：根据图形在屏幕上的像素尺寸选择绘制方式
+    enum DetailLevel {
+        DetailHidden,      // 不绘制
+        DetailBox,         // 仅绘制填充的边界矩形
+        DetailSimplified,  // 绘制抽稀后的折线，关闭抗锯齿
+        DetailFull         // 完整绘制
+    };
+    
+    // 设置LOD阈值：边界矩形在屏幕上的最大边长（像素）低于对应值时降级绘制
+    static void setLevelOfDetailThresholds(qreal hiddenBelow, qreal boxBelow, qreal simplifiedBelow);
+    static void setLevelOfDetailEnabled(bool enabled) { s_lodEnabled = enabled; }
+    static bool isLevelOfDetailEnabled() { return s_lodEnabled; }
+    
     // 缓存相关方法
     void enableCaching(bool enable);
     bool isCachingEnabled() const { return m_cachingEnabled; }
@@ -160,6 +177,12 @@ public:
     // 裁剪相关方法
     virtual bool clip(const QPainterPath& clipPath);
     
+    // 批量裁剪：返回场景坐标下参与裁剪的路径，空路径表示只能通过clip()裁剪
+    virtual QPainterPath clipSubjectPath() const;
+    
+    // 批量裁剪：应用已在其他线程算好的裁剪结果（场景坐标）
+    virtual bool applyClipResult(const QPainterPath& resultPath);
+    
     // 获取图形的路径表示（用于裁剪）
     virtual QPainterPath toPath() const;
     
@@ -189,6 +212,29 @@ protected:
     // 控制点大小
     static constexpr int HANDLE_SIZE = 12;  // 增大控制点大小以便更容易点击
     
+    // LOD设置
+    static bool s_lodEnabled;
+    static qreal s_lodHiddenSize;
+    static qreal s_lodBoxSize;
+    static qreal s_lodSimplifiedSize;
+    
+    // 计算当前绘制的细节层次（无widget时为导出等离屏渲染，始终完整绘制）
+    DetailLevel detailLevel(const QPainter* painter, const QStyleOptionGraphicsItem* option,
+                            const QWidget* widget) const;
+    
+    // 局部长度extent在屏幕上是否小于minScreenSize像素（无widget的离屏渲染及关闭LOD时始终为false）
+    bool isBelowScreenSize(const QPainter* painter, const QWidget* widget,
+                           qreal extent, qreal minScreenSize) const;
+    
+    // 按低细节层次绘制，已处理（隐藏或边界框）时返回true
+    bool paintLowDetail(QPainter* painter, DetailLevel level);
+    
+    // 低细节层次下使用的简化轮廓（局部坐标），pixelSize为一个屏幕像素对应的局部长度
+    virtual QList<QPolygonF> simplifiedOutline(qreal pixelSize) const;
+    
+    // 按距离容差抽稀折线，保留首尾点
+    static QPolygonF decimatePolyline(const QPolygonF& polyline, qreal tolerance);
+    
     // 重写事件处理
     QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
     
@@ -202,6 +248,18 @@ protected:
     bool m_cacheInvalid = true;
     QPixmap m_cachedPixmap;
     
+    // 通知场景空间索引边界可能已变化（在下次查询前刷新）
+    void markSpatialIndexDirty();
+    
+    // 命中形状缓存：shape()/contains()中描边、合并等代价较高的路径按描边宽度缓存，
+    // 只在缓存失效后的第一次调用时执行build
+    const QPainterPath& cachedShape(qreal strokeWidth, const std::function<QPainterPath()>& build) const;
+    
+    // 几何或画笔变化后清空命中形状缓存（位置变化不需要调用）
+    void invalidateShapeCache();
+    
+    mutable QMap<qreal, QPainterPath> m_shapeCache;
+    
     // 创建用于缓存的键
     QString createCacheKey() const;
     // 更新缓存
@@ -0,0 +1,50 @@
+#include "item_registry.h"
+
+QHash<const QGraphicsItem*, const QGraphicsScene*>& ItemRegistry::registry()
+{
+    static QHash<const QGraphicsItem*, const QGraphicsScene*> s_registry;
+    return s_registry;
+}
+
+void ItemRegistry::add(const QGraphicsItem* item)
+{
+    if (item) {
+        registry().insert(item, nullptr);
+    }
+}
+
+void ItemRegistry::setScene(const QGraphicsItem* item, const QGraphicsScene* scene)
+{
+    if (item) {
+        registry().insert(item, scene);
+    }
+}
+
+void ItemRegistry::remove(const QGraphicsItem* item)
+{
+    registry().remove(item);
+}
+
+bool ItemRegistry::isAlive(const QGraphicsItem* item)
+{
+    return item && registry().contains(item);
+}
+
+bool ItemRegistry::isInScene(const QGraphicsItem* item, const QGraphicsScene* scene)
+{
+    if (!item || !scene) {
+        return false;
+    }
+    auto it = registry().constFind(item);
+    return it != registry().constEnd() && it.value() == scene;
+}
+
+const QGraphicsScene* ItemRegistry::sceneOf(const QGraphicsItem* item)
+{
+    return registry().value(item, nullptr);
+}
+
+int ItemRegistry::count()
+{
+    return registry().size();
+}
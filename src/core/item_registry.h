@@ -0,0 +1,45 @@
+#ifndef ITEM_REGISTRY_H
+#define ITEM_REGISTRY_H
+
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <QHash>
+
+/**
+ * @brief 图形项存活登记表
+ *
+ * 记录每个存活的GraphicItem当前所在的场景。GraphicItem在构造时登记，
+ * 在itemChange(ItemSceneHasChanged)中更新所在场景，析构时注销，
+ * 因此“图形项是否仍在场景中”的判断是一次哈希查找，
+ * 用于替代代价为O(n)的m_scene->items().contains(item)。
+ *
+ * 只能在GUI线程中使用。
+ */
+class ItemRegistry {
+public:
+    // 登记新构造的图形项（尚未加入场景）
+    static void add(const QGraphicsItem* item);
+
+    // 图形项所在场景发生变化（scene为nullptr表示已离开场景）
+    static void setScene(const QGraphicsItem* item, const QGraphicsScene* scene);
+
+    // 注销即将析构的图形项
+    static void remove(const QGraphicsItem* item);
+
+    // 图形项是否存活（已登记且尚未析构）
+    static bool isAlive(const QGraphicsItem* item);
+
+    // 图形项是否存活且位于指定场景中
+    static bool isInScene(const QGraphicsItem* item, const QGraphicsScene* scene);
+
+    // 存活图形项所在的场景（未登记或不在场景中时返回nullptr）
+    static const QGraphicsScene* sceneOf(const QGraphicsItem* item);
+
+    // 已登记的图形项数量
+    static int count();
+
+private:
+    static QHash<const QGraphicsItem*, const QGraphicsScene*>& registry();
+};
+
+#endif // ITEM_REGISTRY_H
@@ -0,0 +1,504 @@
+#include "orthogonal_router.h"
+#include "flowchart_base_item.h"
+#include "flowchart_connector_item.h"
+#include "spatial_index.h"
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+// 坐标比较容差
+static const qreal COORD_EPSILON = 1e-6;
+
+// 方向编号：0 = +x，1 = -x，2 = +y，3 = -y
+static const int DIR_DX[4] = {1, -1, 0, 0};
+static const int DIR_DY[4] = {0, 0, 1, -1};
+
+static int directionIndex(const QPointF& dir)
+{
+    if (qAbs(dir.x()) >= qAbs(dir.y())) {
+        return dir.x() >= 0 ? 0 : 1;
+    }
+    return dir.y() >= 0 ? 2 : 3;
+}
+
+static int oppositeDirection(int dir)
+{
+    return dir ^ 1;
+}
+
+// 排序去重，并丢弃区域外的坐标
+static void normalizeCoords(std::vector<qreal>& coords, qreal low, qreal high)
+{
+    std::sort(coords.begin(), coords.end());
+    std::vector<qreal> result;
+    result.reserve(coords.size());
+    for (qreal c : coords) {
+        if (c < low - COORD_EPSILON || c > high + COORD_EPSILON) {
+            continue;
+        }
+        if (result.empty() || c - result.back() > COORD_EPSILON) {
+            result.push_back(c);
+        }
+    }
+    coords.swap(result);
+}
+
+// 第一个不小于value的坐标下标
+static int firstAtLeast(const std::vector<qreal>& coords, qreal value)
+{
+    return static_cast<int>(std::lower_bound(coords.begin(), coords.end(), value - COORD_EPSILON) - coords.begin());
+}
+
+// 最后一个不大于value的坐标下标
+static int lastAtMost(const std::vector<qreal>& coords, qreal value)
+{
+    return static_cast<int>(std::upper_bound(coords.begin(), coords.end(), value + COORD_EPSILON) - coords.begin()) - 1;
+}
+
+// 去掉共线的中间顶点
+static QList<QPointF> removeCollinear(const QList<QPointF>& points)
+{
+    QList<QPointF> result;
+    for (const QPointF& p : points) {
+        if (!result.isEmpty() && qAbs(result.last().x() - p.x()) < COORD_EPSILON &&
+            qAbs(result.last().y() - p.y()) < COORD_EPSILON) {
+            continue;
+        }
+        if (result.size() >= 2) {
+            const QPointF& a = result[result.size() - 2];
+            const QPointF& b = result.last();
+            const bool sameX = qAbs(a.x() - b.x()) < COORD_EPSILON && qAbs(b.x() - p.x()) < COORD_EPSILON;
+            const bool sameY = qAbs(a.y() - b.y()) < COORD_EPSILON && qAbs(b.y() - p.y()) < COORD_EPSILON;
+            if (sameX || sameY) {
+                result.last() = p;
+                continue;
+            }
+        }
+        result.append(p);
+    }
+    return result;
+}
+
+OrthogonalRouter::OrthogonalRouter(QGraphicsScene* scene)
+    : m_scene(scene)
+{
+}
+
+template<typename Fn>
+void OrthogonalRouter::forEachCell(const QRectF& rect, Fn fn)
+{
+    const int x0 = static_cast<int>(std::floor(rect.left() / CORRIDOR_CELL_SIZE));
+    const int x1 = static_cast<int>(std::floor(rect.right() / CORRIDOR_CELL_SIZE));
+    const int y0 = static_cast<int>(std::floor(rect.top() / CORRIDOR_CELL_SIZE));
+    const int y1 = static_cast<int>(std::floor(rect.bottom() / CORRIDOR_CELL_SIZE));
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            fn(cellKey(cx, cy));
+        }
+    }
+}
+
+QList<QPointF> OrthogonalRouter::route(const QPointF& start, FlowchartBaseItem* fromItem,
+                                       const QPointF& end, FlowchartBaseItem* toItem) const
+{
+    const qreal clearance = m_margin / 2;
+    const QRectF fromRect = fromItem ? fromItem->sceneBoundingRect() : QRectF();
+    const QRectF toRect = toItem ? toItem->sceneBoundingRect() : QRectF();
+
+    const QPointF startDir = exitDirection(start, fromRect, end);
+    const QPointF endDir = exitDirection(end, toRect, start);
+
+    // 出线点：沿出线方向至少前进m_margin，并离开自身元素的间隙范围
+    auto stubPoint = [clearance, this](const QPointF& port, const QPointF& dir, const QRectF& rect) {
+        QPointF stub = port + dir * m_margin;
+        if (rect.isValid()) {
+            const QRectF inflated = rect.adjusted(-clearance, -clearance, clearance, clearance);
+            if (dir.x() > 0) stub.setX(qMax(stub.x(), inflated.right()));
+            if (dir.x() < 0) stub.setX(qMin(stub.x(), inflated.left()));
+            if (dir.y() > 0) stub.setY(qMax(stub.y(), inflated.bottom()));
+            if (dir.y() < 0) stub.setY(qMin(stub.y(), inflated.top()));
+        }
+        return stub;
+    };
+    const QPointF startStub = stubPoint(start, startDir, fromRect);
+    const QPointF endStub = stubPoint(end, endDir, toRect);
+
+    // 搜索区域：两端出线点的包围盒向外扩展，再包含与之相交的障碍物，保证可以从外侧绕行
+    const qreal padding = m_margin * REGION_PADDING_FACTOR;
+    QRectF region = QRectF(startStub, endStub).normalized().adjusted(-padding, -padding, padding, padding);
+    std::vector<QRectF> obstacles;
+    collectObstacles(region, obstacles);
+    for (const QRectF& rect : obstacles) {
+        region = region.united(rect);
+    }
+    region.adjust(-m_margin, -m_margin, m_margin, m_margin);
+    obstacles.clear();
+    collectObstacles(region, obstacles);
+
+    QList<QPointF> path = findPath(startStub, startDir, endStub, -endDir,
+                                   obstacles, region, m_margin * 2);
+    if (path.isEmpty()) {
+        return simpleRoute(start, end);
+    }
+
+    path.prepend(start);
+    path.append(end);
+    return removeCollinear(path);
+}
+
+QList<QPointF> OrthogonalRouter::findPath(const QPointF& start, const QPointF& startDir,
+                                          const QPointF& end, const QPointF& endDir,
+                                          const std::vector<QRectF>& obstacles,
+                                          const QRectF& region, qreal bendPenalty)
+{
+    // 候选坐标：区域边界、两端点以及各障碍物的边线
+    std::vector<qreal> xs = {start.x(), end.x(), region.left(), region.right()};
+    std::vector<qreal> ys = {start.y(), end.y(), region.top(), region.bottom()};
+    xs.reserve(obstacles.size() * 2 + 4);
+    ys.reserve(obstacles.size() * 2 + 4);
+    for (const QRectF& rect : obstacles) {
+        xs.push_back(rect.left());
+        xs.push_back(rect.right());
+        ys.push_back(rect.top());
+        ys.push_back(rect.bottom());
+    }
+    normalizeCoords(xs, region.left(), region.right());
+    normalizeCoords(ys, region.top(), region.bottom());
+
+    const int nx = static_cast<int>(xs.size());
+    const int ny = static_cast<int>(ys.size());
+    if (nx < 1 || ny < 1 || static_cast<qint64>(nx) * ny > MAX_GRID_NODES) {
+        return QList<QPointF>();
+    }
+
+    const int si = firstAtLeast(xs, start.x());
+    const int sj = firstAtLeast(ys, start.y());
+    const int ei = firstAtLeast(xs, end.x());
+    const int ej = firstAtLeast(ys, end.y());
+    if (si >= nx || sj >= ny || ei >= nx || ej >= ny) {
+        return QList<QPointF>();
+    }
+    if (si == ei && sj == ej) {
+        return QList<QPointF>{start, end};
+    }
+
+    // 标记穿过障碍物内部的网格边：
+    // hBlocked[j * nx + i] 为 (i, j)-(i + 1, j)，vBlocked[j * nx + i] 为 (i, j)-(i, j + 1)
+    std::vector<char> hBlocked(static_cast<size_t>(nx) * ny, 0);
+    std::vector<char> vBlocked(static_cast<size_t>(nx) * ny, 0);
+    for (const QRectF& rect : obstacles) {
+        const int i0 = firstAtLeast(xs, rect.left());
+        const int i1 = lastAtMost(xs, rect.right());
+        const int j0 = firstAtLeast(ys, rect.top());
+        const int j1 = lastAtMost(ys, rect.bottom());
+        if (i0 > i1 || j0 > j1) {
+            continue;
+        }
+        // 严格位于矩形内部的坐标范围
+        const int iIn0 = xs[i0] > rect.left() + COORD_EPSILON ? i0 : i0 + 1;
+        const int iIn1 = xs[i1] < rect.right() - COORD_EPSILON ? i1 : i1 - 1;
+        const int jIn0 = ys[j0] > rect.top() + COORD_EPSILON ? j0 : j0 + 1;
+        const int jIn1 = ys[j1] < rect.bottom() - COORD_EPSILON ? j1 : j1 - 1;
+
+        for (int j = jIn0; j <= jIn1; ++j) {
+            for (int i = i0; i < i1; ++i) {
+                hBlocked[static_cast<size_t>(j) * nx + i] = 1;
+            }
+        }
+        for (int j = j0; j < j1; ++j) {
+            for (int i = iIn0; i <= iIn1; ++i) {
+                vBlocked[static_cast<size_t>(j) * nx + i] = 1;
+            }
+        }
+    }
+
+    // A*：状态为（网格节点，到达方向），代价为路径长度加拐弯惩罚
+    const int stateCount = nx * ny * 4;
+    const qreal infinity = std::numeric_limits<qreal>::max();
+    std::vector<qreal> cost(stateCount, infinity);
+    std::vector<int> parent(stateCount, -1);
+    std::vector<char> closed(stateCount, 0);
+
+    auto heuristic = [&](int i, int j) {
+        return qAbs(xs[i] - end.x()) + qAbs(ys[j] - end.y());
+    };
+
+    using QueueEntry = std::pair<qreal, int>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+
+    const int startState = (sj * nx + si) * 4 + directionIndex(startDir);
+    const int goalDir = directionIndex(endDir);
+    cost[startState] = 0;
+    open.push({heuristic(si, sj), startState});
+
+    qreal bestCost = infinity;
+    int bestState = -1;
+
+    while (!open.empty()) {
+        const QueueEntry top = open.top();
+        open.pop();
+        if (top.first >= bestCost) {
+            break;
+        }
+        const int state = top.second;
+        if (closed[state]) {
+            continue;
+        }
+        closed[state] = 1;
+
+        const int node = state / 4;
+        const int dir = state % 4;
+        const int i = node % nx;
+        const int j = node / nx;
+
+        if (i == ei && j == ej) {
+            // 到达终止出线点后还需转向终点方向
+            const qreal total = cost[state] + (dir != goalDir ? bendPenalty : 0);
+            if (total < bestCost) {
+                bestCost = total;
+                bestState = state;
+            }
+            continue;
+        }
+
+        for (int nd = 0; nd < 4; ++nd) {
+            if (nd == oppositeDirection(dir)) {
+                continue;
+            }
+            const int ni = i + DIR_DX[nd];
+            const int nj = j + DIR_DY[nd];
+            if (ni < 0 || ni >= nx || nj < 0 || nj >= ny) {
+                continue;
+            }
+
+            bool blocked = false;
+            switch (nd) {
+            case 0: blocked = hBlocked[static_cast<size_t>(j) * nx + i]; break;
+            case 1: blocked = hBlocked[static_cast<size_t>(j) * nx + ni]; break;
+            case 2: blocked = vBlocked[static_cast<size_t>(j) * nx + i]; break;
+            case 3: blocked = vBlocked[static_cast<size_t>(nj) * nx + i]; break;
+            }
+            if (blocked) {
+                continue;
+            }
+
+            const int nextState = (nj * nx + ni) * 4 + nd;
+            const qreal nextCost = cost[state] + qAbs(xs[ni] - xs[i]) + qAbs(ys[nj] - ys[j]) +
+                                   (nd != dir ? bendPenalty : 0);
+            if (nextCost < cost[nextState]) {
+                cost[nextState] = nextCost;
+                parent[nextState] = state;
+                open.push({nextCost + heuristic(ni, nj), nextState});
+            }
+        }
+    }
+
+    if (bestState < 0) {
+        return QList<QPointF>();
+    }
+
+    QList<QPointF> path;
+    for (int state = bestState; state >= 0; state = parent[state]) {
+        const int node = state / 4;
+        path.prepend(QPointF(xs[node % nx], ys[node / nx]));
+    }
+    return removeCollinear(path);
+}
+
+const QList<QPointF>* OrthogonalRouter::cachedRoute(FlowchartConnectorItem* connector,
+                                                    const QPointF& start, const QPointF& end) const
+{
+    auto it = m_routes.constFind(connector);
+    if (it == m_routes.constEnd() || it.value().points.size() < 2) {
+        return nullptr;
+    }
+    const QList<QPointF>& points = it.value().points;
+    if (points.first() != start || points.last() != end) {
+        return nullptr;
+    }
+    return &points;
+}
+
+void OrthogonalRouter::storeRoute(FlowchartConnectorItem* connector, const QList<QPointF>& points)
+{
+    removeRoute(connector);
+    if (!connector || points.size() < 2) {
+        return;
+    }
+
+    // 走廊外扩必须大于障碍物间隙(m_margin / 2)：贴着障碍物绕行的线段离元素边界正好一个间隙，
+    // 外扩恰好等于间隙时走廊只与元素边界相接，QRectF::intersects判定为不相交，元素移开后绕行路径不会失效
+    const qreal inflate = m_margin;
+    CachedRoute route;
+    route.points = points;
+    route.corridors.reserve(points.size() - 1);
+    for (int i = 1; i < points.size(); ++i) {
+        route.corridors.push_back(QRectF(points[i - 1], points[i]).normalized()
+                                  .adjusted(-inflate, -inflate, inflate, inflate));
+    }
+
+    indexCorridors(connector, route);
+    m_routes.insert(connector, route);
+}
+
+void OrthogonalRouter::removeRoute(FlowchartConnectorItem* connector)
+{
+    auto it = m_routes.find(connector);
+    if (it == m_routes.end()) {
+        return;
+    }
+    unindexCorridors(connector, it.value());
+    m_routes.erase(it);
+}
+
+void OrthogonalRouter::clear()
+{
+    m_routes.clear();
+    m_corridorGrid.clear();
+}
+
+QList<FlowchartConnectorItem*> OrthogonalRouter::invalidateRoutes(const QRectF& rect)
+{
+    QList<FlowchartConnectorItem*> result;
+    if (!rect.isValid()) {
+        return result;
+    }
+
+    QSet<FlowchartConnectorItem*> candidates;
+    forEachCell(rect, [&](quint64 key) {
+        auto cell = m_corridorGrid.constFind(key);
+        if (cell != m_corridorGrid.constEnd()) {
+            for (FlowchartConnectorItem* connector : cell.value()) {
+                candidates.insert(connector);
+            }
+        }
+    });
+
+    for (FlowchartConnectorItem* connector : candidates) {
+        const CachedRoute& route = m_routes[connector];
+        for (const QRectF& corridor : route.corridors) {
+            if (corridor.intersects(rect)) {
+                result.append(connector);
+                break;
+            }
+        }
+    }
+
+    for (FlowchartConnectorItem* connector : result) {
+        removeRoute(connector);
+    }
+    return result;
+}
+
+void OrthogonalRouter::collectObstacles(const QRectF& region, std::vector<QRectF>& obstacles) const
+{
+    if (!m_scene) {
+        return;
+    }
+
+    const qreal clearance = m_margin / 2;
+    auto addItem = [&](QGraphicsItem* item) {
+        auto* flowchartItem = dynamic_cast<FlowchartBaseItem*>(item);
+        if (!flowchartItem || dynamic_cast<FlowchartConnectorItem*>(item)) {
+            return;
+        }
+        obstacles.push_back(flowchartItem->sceneBoundingRect()
+                            .adjusted(-clearance, -clearance, clearance, clearance));
+    };
+
+    // 障碍物已含间隙，查询范围相应扩大
+    const QRectF queryRect = region.adjusted(-clearance, -clearance, clearance, clearance);
+    if (SpatialIndex* index = SpatialIndex::forScene(m_scene)) {
+        index->visit(queryRect, [&](QGraphicsItem* item, const QRectF&) {
+            addItem(item);
+        });
+    } else {
+        const QList<QGraphicsItem*> items = m_scene->items(queryRect, Qt::IntersectsItemBoundingRect);
+        for (QGraphicsItem* item : items) {
+            addItem(item);
+        }
+    }
+}
+
+QPointF OrthogonalRouter::exitDirection(const QPointF& point, const QRectF& itemRect, const QPointF& towards)
+{
+    if (!itemRect.isValid()) {
+        const QPointF delta = towards - point;
+        if (qAbs(delta.x()) >= qAbs(delta.y())) {
+            return QPointF(delta.x() >= 0 ? 1 : -1, 0);
+        }
+        return QPointF(0, delta.y() >= 0 ? 1 : -1);
+    }
+
+    // 从距离最近的一条边出线
+    const qreal distances[4] = {
+        qAbs(itemRect.right() - point.x()),
+        qAbs(point.x() - itemRect.left()),
+        qAbs(itemRect.bottom() - point.y()),
+        qAbs(point.y() - itemRect.top())
+    };
+    int side = 0;
+    for (int i = 1; i < 4; ++i) {
+        if (distances[i] < distances[side]) {
+            side = i;
+        }
+    }
+    return QPointF(DIR_DX[side], DIR_DY[side]);
+}
+
+QList<QPointF> OrthogonalRouter::simpleRoute(const QPointF& start, const QPointF& end)
+{
+    const QPointF midPoint((start.x() + end.x()) / 2, (start.y() + end.y()) / 2);
+    QList<QPointF> path;
+    path.append(start);
+    if (qAbs(start.x() - end.x()) > qAbs(start.y() - end.y())) {
+        path.append(QPointF(midPoint.x(), start.y()));
+        path.append(QPointF(midPoint.x(), end.y()));
+    } else {
+        path.append(QPointF(start.x(), midPoint.y()));
+        path.append(QPointF(end.x(), midPoint.y()));
+    }
+    path.append(end);
+    return removeCollinear(path);
+}
+
+void OrthogonalRouter::indexCorridors(FlowchartConnectorItem* connector, const CachedRoute& route)
+{
+    QSet<quint64> keys;
+    for (const QRectF& corridor : route.corridors) {
+        forEachCell(corridor, [&](quint64 key) {
+            keys.insert(key);
+        });
+    }
+    for (quint64 key : keys) {
+        m_corridorGrid[key].append(connector);
+    }
+}
+
+void OrthogonalRouter::unindexCorridors(FlowchartConnectorItem* connector, const CachedRoute& route)
+{
+    QSet<quint64> keys;
+    for (const QRectF& corridor : route.corridors) {
+        forEachCell(corridor, [&](quint64 key) {
+            keys.insert(key);
+        });
+    }
+    for (quint64 key : keys) {
+        auto cell = m_corridorGrid.find(key);
+        if (cell == m_corridorGrid.end()) {
+            continue;
+        }
+        cell->removeOne(connector);
+        if (cell->isEmpty()) {
+            m_corridorGrid.erase(cell);
+        }
+    }
+}
+
+quint64 OrthogonalRouter::cellKey(int cellX, int cellY)
+{
+    return (static_cast<quint64>(static_cast<quint32>(cellX)) << 32) | static_cast<quint32>(cellY);
+}
@@ -0,0 +1,103 @@
+#ifndef ORTHOGONAL_ROUTER_H
+#define ORTHOGONAL_ROUTER_H
+
+#include <QGraphicsScene>
+#include <QPointF>
+#include <QRectF>
+#include <QList>
+#include <QHash>
+#include <vector>
+
+class FlowchartBaseItem;
+class FlowchartConnectorItem;
+
+/**
+ * @brief 正交连接线路由器 - 绕开流程图元素的折线路由
+ *
+ * 在起点和终点附近的区域内，以障碍物（流程图元素的边界矩形加上间隙）的边线
+ * 和两端出线点的坐标构造稀疏正交可见图，用A*搜索长度加拐弯惩罚最小的路径。
+ * 每条连接线的路由结果按走廊（路径各线段的外扩矩形）缓存在网格中，
+ * 元素移动后只需使走廊与其新旧边界相交的路由失效并重新计算。
+ */
+class OrthogonalRouter {
+public:
+    explicit OrthogonalRouter(QGraphicsScene* scene);
+
+    /**
+     * @brief 计算绕开障碍物的正交路径
+     * @param start 起点（场景坐标）
+     * @param fromItem 起点所在元素，用于确定出线方向并排除自身，可为nullptr
+     * @param end 终点（场景坐标）
+     * @param toItem 终点所在元素，可为nullptr
+     * @return 包含起点和终点的折线顶点；搜索失败时返回简单的三段折线
+     */
+    QList<QPointF> route(const QPointF& start, FlowchartBaseItem* fromItem,
+                         const QPointF& end, FlowchartBaseItem* toItem) const;
+
+    /**
+     * @brief 在给定障碍物中搜索正交路径（不访问场景，可单独使用）
+     * @param start 起始出线点
+     * @param startDir 起始方向（单位轴向量）
+     * @param end 终止出线点
+     * @param endDir 到达终止出线点后继续前进的方向（单位轴向量）
+     * @param obstacles 障碍物矩形，路径不会穿过其内部
+     * @param region 搜索区域，路径不会离开该区域
+     * @param bendPenalty 每个拐弯的附加代价
+     * @return 从start到end的折线顶点，失败时返回空列表
+     */
+    static QList<QPointF> findPath(const QPointF& start, const QPointF& startDir,
+                                   const QPointF& end, const QPointF& endDir,
+                                   const std::vector<QRectF>& obstacles,
+                                   const QRectF& region, qreal bendPenalty);
+
+    // 路由缓存：端点与缓存一致时返回缓存的路径，否则返回nullptr
+    const QList<QPointF>* cachedRoute(FlowchartConnectorItem* connector,
+                                      const QPointF& start, const QPointF& end) const;
+    void storeRoute(FlowchartConnectorItem* connector, const QList<QPointF>& points);
+    void removeRoute(FlowchartConnectorItem* connector);
+    void clear();
+
+    // 使走廊与矩形相交的路由失效，返回受影响的连接器
+    QList<FlowchartConnectorItem*> invalidateRoutes(const QRectF& rect);
+
+    // 出线长度，障碍物间隙为其一半
+    void setMargin(qreal margin) { m_margin = margin; }
+    qreal margin() const { return m_margin; }
+
+    int cachedRouteCount() const { return m_routes.size(); }
+
+private:
+    struct CachedRoute {
+        QList<QPointF> points;
+        std::vector<QRectF> corridors;   // 各线段外扩后的矩形
+    };
+
+    // 走廊网格单元大小
+    static constexpr qreal CORRIDOR_CELL_SIZE = 128.0;
+    // 搜索区域在两端出线点包围盒外的扩展量（以出线长度为单位）
+    static constexpr qreal REGION_PADDING_FACTOR = 4.0;
+    // 可见图最多节点数，超过时放弃搜索
+    static constexpr int MAX_GRID_NODES = 400000;
+
+    QGraphicsScene* m_scene;
+    qreal m_margin = 20.0;
+    QHash<FlowchartConnectorItem*, CachedRoute> m_routes;
+    QHash<quint64, QList<FlowchartConnectorItem*>> m_corridorGrid;
+
+    // 收集与区域相交的障碍物（已加上间隙），忽略连接线
+    void collectObstacles(const QRectF& region, std::vector<QRectF>& obstacles) const;
+
+    // 端点相对于所在元素的出线方向
+    static QPointF exitDirection(const QPointF& point, const QRectF& itemRect, const QPointF& towards);
+
+    // 无障碍信息时的三段折线
+    static QList<QPointF> simpleRoute(const QPointF& start, const QPointF& end);
+
+    // 走廊网格维护
+    void indexCorridors(FlowchartConnectorItem* connector, const CachedRoute& route);
+    void unindexCorridors(FlowchartConnectorItem* connector, const CachedRoute& route);
+    template<typename Fn> static void forEachCell(const QRectF& rect, Fn fn);
+    static quint64 cellKey(int cellX, int cellY);
+};
+
+#endif // ORTHOGONAL_ROUTER_H
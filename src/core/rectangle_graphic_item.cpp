@@ -63,35 +63,37 @@ QPainterPath RectangleGraphicItem::shape() const
 {
     // 如果使用自定义路径，返回自定义路径的形状
     if (m_useCustomPath && !m_customClipPath.isEmpty()) {
-        // 使用自定义裁剪路径作为形状
-        QPainterPath customShape = m_customClipPath;
+        // 使用自定义裁剪路径作为形状，考虑画笔宽度的影响扩展路径；
+        // 合并描边的代价较高，结果缓存到下次几何变化
+        return cachedShape(m_pen.width(), [this]() {
+            QPainterPathStroker stroker;
+            stroker.setWidth(m_pen.width());
+            return m_customClipPath.united(stroker.createStroke(m_customClipPath));
+        });
+    }
+    
+    return cachedShape(m_pen.width(), [this]() {
+        // 应用缩放因子计算实际尺寸
+        double scaledWidth = m_size.width() * m_scale.x();
+        double scaledHeight = m_size.height() * m_scale.y();
+        
+        // 基于缩放后的尺寸计算左上角相对位置
+        QPointF scaledTopLeft = QPointF(-scaledWidth/2, -scaledHeight/2);
+        
+        // 创建矩形路径
+        QPainterPath path;
+        path.addRect(QRectF(
+            scaledTopLeft.x(),
+            scaledTopLeft.y(),
+            scaledWidth,
+            scaledHeight
+        ));
         
         // 考虑画笔宽度的影响，使用strokePath扩展路径
         QPainterPathStroker stroker;
         stroker.setWidth(m_pen.width());
-        return customShape.united(stroker.createStroke(customShape));
-    }
-    
-    // 应用缩放因子计算实际尺寸
-    double scaledWidth = m_size.width() * m_scale.x();
-    double scaledHeight = m_size.height() * m_scale.y();
-    
-    // 基于缩放后的尺寸计算左上角相对位置
-    QPointF scaledTopLeft = QPointF(-scaledWidth/2, -scaledHeight/2);
-    
-    // 创建矩形路径
-    QPainterPath path;
-    path.addRect(QRectF(
-        scaledTopLeft.x(),
-        scaledTopLeft.y(),
-        scaledWidth,
-        scaledHeight
-    ));
-    
-    // 考虑画笔宽度的影响，使用strokePath扩展路径
-    QPainterPathStroker stroker;
-    stroker.setWidth(m_pen.width());
-    return path.united(stroker.createStroke(path));
+        return path.united(stroker.createStroke(path));
+    });
 }
 
 std::vector<QPointF> RectangleGraphicItem::getDrawPoints() const
@@ -142,6 +144,8 @@ void RectangleGraphicItem::setSize(const QSizeF& size)
     setPos(oldTopLeft + QPointF(validSize.width()/2, validSize.height()/2));
     m_topLeft = QPointF(-validSize.width()/2, -validSize.height()/2);
     
+    markSpatialIndexDirty();
+    invalidateShapeCache();
     update();
 }
 
@@ -165,6 +169,8 @@ void RectangleGraphicItem::setScale(const QPointF& scale)
                  .arg(m_size.height()));
     
     // 更新图形
+    markSpatialIndexDirty();
+    invalidateShapeCache();
     update();
 }
 
@@ -183,10 +189,13 @@ bool RectangleGraphicItem::contains(const QPointF& point) const
         QPointF localPoint = mapFromScene(point);
         
         // 检查点是否在路径内部或边缘上
-        // 考虑笔宽的影响
-        QPainterPathStroker stroker;
-        stroker.setWidth(m_pen.width() + 2.0); // 增加额外的容差
-        QPainterPath expandedPath = m_customClipPath.united(stroker.createStroke(m_customClipPath));
+        // 考虑笔宽的影响，增加额外的容差
+        const qreal hitWidth = m_pen.width() + 2.0;
+        const QPainterPath& expandedPath = cachedShape(hitWidth, [this, hitWidth]() {
+            QPainterPathStroker stroker;
+            stroker.setWidth(hitWidth);
+            return m_customClipPath.united(stroker.createStroke(m_customClipPath));
+        });
         return expandedPath.contains(localPoint);
     }
     
@@ -227,131 +236,141 @@ bool RectangleGraphicItem::clip(const QPainterPath& clipPath)
     std::vector<QPointF> clipPoints = ClipAlgorithms::pathToPoints(clipPath, 0.5);
     Logger::debug(QString("pathToPoints: 通过toFillPolygon提取了 %1 个点").arg(clipPoints.size()));
 
-    // 保存当前可移动状态
-    bool wasMovable = isMovable();
-
     // 是否是自由形状裁剪（需要用通用算法）
     if (clipPoints.size() > 4) {
         Logger::debug("RectangleGraphicItem::clip: 使用通用裁剪算法(自由形状裁剪)");
 
-        // 获取矩形的路径
-        QPainterPath path = toPath();
-        // 转换到场景坐标
-        QTransform toScene;
-        toScene.translate(pos().x(), pos().y());
-        path = toScene.map(path);
-
         // 使用裁剪算法计算路径交集
-        QPainterPath resultPath = ClipAlgorithms::clipPath(path, clipPath);
-        Logger::debug(QString("RectangleGraphicItem::clip: 裁剪结果元素数: %1, 点数: %2")
-            .arg(resultPath.elementCount())
-            .arg(ClipAlgorithms::pathToPoints(resultPath, 0.5).size()));
+        QPainterPath resultPath = ClipAlgorithms::clipPath(clipSubjectPath(), clipPath);
+        Logger::debug(QString("RectangleGraphicItem::clip: 裁剪结果元素数: %1")
+            .arg(resultPath.elementCount()));
 
-        // 判断裁剪结果是否是矩形
-        bool isRectangular = ClipAlgorithms::isPathRectangular(resultPath);
-        
-        if (isRectangular) {
-            // 如果裁剪结果是矩形，直接调整矩形大小和位置
-            QRectF resultRect = resultPath.boundingRect();
-            setPos(resultRect.center());
-            
-            // 将尺寸设置为新矩形的尺寸
-            QSizeF newSize(resultRect.width(), resultRect.height());
-            m_size = newSize;
-            m_topLeft = QPointF(-newSize.width()/2, -newSize.height()/2);
-            
-            // 确保不使用自定义路径
-            m_useCustomPath = false;
-            
-            // 更新缓存和图形显示
-            invalidateCache();
-            update();
-            
-            Logger::info(QString("RectangleGraphicItem::clip: 裁剪结果是矩形，尺寸: %1x%2")
-                        .arg(newSize.width())
-                        .arg(newSize.height()));
-        } else {
-            // 非矩形裁剪结果，转换为自定义形状
-            std::vector<QPointF> resultPoints = ClipAlgorithms::pathToPoints(resultPath, 0.5);
-            Logger::debug(QString("RectangleGraphicItem::clip: 裁剪结果不是矩形，点数: %1")
-                         .arg(resultPoints.size()));
-            
-            if (resultPoints.size() < 3) {
-                Logger::warning("RectangleGraphicItem::clip: 裁剪结果点数不足，无法创建有效形状");
-                return false;
-            }
-            
-            // 计算结果边界和中心点
-            QRectF resultBounds = resultPath.boundingRect();
-            Logger::debug(QString("RectangleGraphicItem::clip: 裁剪结果边界: (%1,%2,%3,%4)")
-                         .arg(resultBounds.x()).arg(resultBounds.y())
-                         .arg(resultBounds.width()).arg(resultBounds.height()));
-            
-            // 对裁剪结果路径进行预处理，确保质量
-            // 使用更小的flatness值获取更精细的点集
-            std::vector<QPointF> detailedPoints = ClipAlgorithms::pathToPoints(resultPath, 0.1);
-            
-            Logger::debug(QString("RectangleGraphicItem::clip: 优化后的裁剪结果点数: %1")
-                         .arg(detailedPoints.size()));
-            
-            // 检查裁剪结果是否有效
-            if (detailedPoints.size() < 3) {
-                Logger::warning("RectangleGraphicItem::clip: 裁剪结果点数不足，无法创建有效路径");
-                return false;
-            }
-            
-            // 计算结果的中心点和边界
-            QRectF newBounds = resultPath.boundingRect();
-            QPointF newCenter = newBounds.center();
-            
-            // 设置图形项位置为裁剪结果的中心
-            setPos(newCenter);
-            
-            // 将裁剪结果转换为相对于新中心点的坐标
-            QTransform transform;
-            transform.translate(-newCenter.x(), -newCenter.y());
-            m_customClipPath = transform.map(resultPath);
-            
-            // 最后再次检查自定义路径是否有效
-            if (m_customClipPath.isEmpty()) {
-                Logger::warning("RectangleGraphicItem::clip: 转换后的自定义路径为空，保持原图形不变");
-                return false;
-            }
-            
-            // 保留WindingFill作为计算规则，但我们的绘制会忽略填充
-            m_customClipPath.setFillRule(Qt::WindingFill);
-            
-            // 启用自定义路径绘制模式
-            m_useCustomPath = true;
-            
-            // 保存尺寸信息（主要用于边界框计算）
-            m_size = newBounds.size();
-            m_topLeft = QPointF(-m_size.width()/2, -m_size.height()/2);
-            
-            // 如果点太多，尝试简化点集以提高性能
-            if (detailedPoints.size() > 500) {
-                Logger::debug("RectangleGraphicItem::clip: 尝试简化过多的点");
-                // 使用更大的flatness值重新生成路径点，减少点数
-                std::vector<QPointF> simplifiedPoints = ClipAlgorithms::pathToPoints(m_customClipPath, 0.5);
-                if (simplifiedPoints.size() >= 3 && simplifiedPoints.size() < detailedPoints.size()) {
-                    Logger::debug(QString("RectangleGraphicItem::clip: 成功简化点数从 %1 到 %2")
-                                 .arg(detailedPoints.size())
-                                 .arg(simplifiedPoints.size()));
-                    
-                    // 重新创建简化后的路径
-                    m_customClipPath = ClipAlgorithms::pointsToPath(simplifiedPoints);
-                    m_customClipPath.setFillRule(Qt::WindingFill);
-                    detailedPoints = simplifiedPoints;
-                }
+        return applyClipResult(resultPath);
+    }
+
+    return true;
+}
+
+QPainterPath RectangleGraphicItem::clipSubjectPath() const
+{
+    // 获取矩形的路径并转换到场景坐标
+    QPainterPath path = toPath();
+    QTransform toScene;
+    toScene.translate(pos().x(), pos().y());
+    return toScene.map(path);
+}
+
+bool RectangleGraphicItem::applyClipResult(const QPainterPath& resultPath)
+{
+    // 保存当前可移动状态
+    bool wasMovable = isMovable();
+
+    // 判断裁剪结果是否是矩形
+    bool isRectangular = ClipAlgorithms::isPathRectangular(resultPath);
+    
+    if (isRectangular) {
+        // 如果裁剪结果是矩形，直接调整矩形大小和位置
+        QRectF resultRect = resultPath.boundingRect();
+        setPos(resultRect.center());
+        
+        // 将尺寸设置为新矩形的尺寸
+        QSizeF newSize(resultRect.width(), resultRect.height());
+        m_size = newSize;
+        m_topLeft = QPointF(-newSize.width()/2, -newSize.height()/2);
+        
+        // 确保不使用自定义路径
+        m_useCustomPath = false;
+        
+        // 更新缓存和图形显示
+        invalidateShapeCache();
+        invalidateCache();
+        update();
+        
+        Logger::info(QString("RectangleGraphicItem::applyClipResult: 裁剪结果是矩形，尺寸: %1x%2")
+                    .arg(newSize.width())
+                    .arg(newSize.height()));
+    } else {
+        // 非矩形裁剪结果，转换为自定义形状
+        std::vector<QPointF> resultPoints = ClipAlgorithms::pathToPoints(resultPath, 0.5);
+        Logger::debug(QString("RectangleGraphicItem::applyClipResult: 裁剪结果不是矩形，点数: %1")
+                     .arg(resultPoints.size()));
+        
+        if (resultPoints.size() < 3) {
+            Logger::warning("RectangleGraphicItem::applyClipResult: 裁剪结果点数不足，无法创建有效形状");
+            return false;
+        }
+        
+        // 计算结果边界和中心点
+        QRectF resultBounds = resultPath.boundingRect();
+        Logger::debug(QString("RectangleGraphicItem::applyClipResult: 裁剪结果边界: (%1,%2,%3,%4)")
+                     .arg(resultBounds.x()).arg(resultBounds.y())
+                     .arg(resultBounds.width()).arg(resultBounds.height()));
+        
+        // 对裁剪结果路径进行预处理，确保质量
+        // 使用更小的flatness值获取更精细的点集
+        std::vector<QPointF> detailedPoints = ClipAlgorithms::pathToPoints(resultPath, 0.1);
+        
+        Logger::debug(QString("RectangleGraphicItem::applyClipResult: 优化后的裁剪结果点数: %1")
+                     .arg(detailedPoints.size()));
+        
+        // 检查裁剪结果是否有效
+        if (detailedPoints.size() < 3) {
+            Logger::warning("RectangleGraphicItem::applyClipResult: 裁剪结果点数不足，无法创建有效路径");
+            return false;
+        }
+        
+        // 计算结果的中心点和边界
+        QRectF newBounds = resultPath.boundingRect();
+        QPointF newCenter = newBounds.center();
+        
+        // 设置图形项位置为裁剪结果的中心
+        setPos(newCenter);
+        
+        // 将裁剪结果转换为相对于新中心点的坐标
+        QTransform transform;
+        transform.translate(-newCenter.x(), -newCenter.y());
+        m_customClipPath = transform.map(resultPath);
+        
+        // 最后再次检查自定义路径是否有效
+        if (m_customClipPath.isEmpty()) {
+            Logger::warning("RectangleGraphicItem::applyClipResult: 转换后的自定义路径为空，保持原图形不变");
+            return false;
+        }
+        
+        // 保留WindingFill作为计算规则，但我们的绘制会忽略填充
+        m_customClipPath.setFillRule(Qt::WindingFill);
+        
+        // 启用自定义路径绘制模式
+        m_useCustomPath = true;
+        
+        // 保存尺寸信息（主要用于边界框计算）
+        m_size = newBounds.size();
+        m_topLeft = QPointF(-m_size.width()/2, -m_size.height()/2);
+        
+        // 如果点太多，尝试简化点集以提高性能
+        if (detailedPoints.size() > 500) {
+            Logger::debug("RectangleGraphicItem::applyClipResult: 尝试简化过多的点");
+            // 使用更大的flatness值重新生成路径点，减少点数
+            std::vector<QPointF> simplifiedPoints = ClipAlgorithms::pathToPoints(m_customClipPath, 0.5);
+            if (simplifiedPoints.size() >= 3 && simplifiedPoints.size() < detailedPoints.size()) {
+                Logger::debug(QString("RectangleGraphicItem::applyClipResult: 成功简化点数从 %1 到 %2")
+                             .arg(detailedPoints.size())
+                             .arg(simplifiedPoints.size()));
+                
+                // 重新创建简化后的路径
+                m_customClipPath = ClipAlgorithms::pointsToPath(simplifiedPoints);
+                m_customClipPath.setFillRule(Qt::WindingFill);
+                detailedPoints = simplifiedPoints;
             }
-            
-            // 更新缓存和图形显示
-            invalidateCache();
-            update();
-            
-            Logger::info(QString("RectangleGraphicItem::clip: 裁剪完成，转换为自定义形状，点数: %1")
-                        .arg(detailedPoints.size()));
         }
+        
+        // 更新缓存和图形显示
+        invalidateShapeCache();
+        invalidateCache();
+        update();
+        
+        Logger::info(QString("RectangleGraphicItem::clip: 裁剪完成，转换为自定义形状，点数: %1")
+                    .arg(detailedPoints.size()));
     }
     
     // 确保裁剪后保持可移动状态
@@ -362,7 +381,7 @@ bool RectangleGraphicItem::clip(const QPainterPath& clipPath)
     setFlag(QGraphicsItem::ItemIsSelectable, true);
     setFlag(QGraphicsItem::ItemSendsGeometryChanges, true);
     
-    Logger::debug(QString("RectangleGraphicItem::clip: 设置可移动状态为 %1").arg(wasMovable ? "可移动" : "不可移动"));
+    Logger::debug(QString("RectangleGraphicItem::applyClipResult: 设置可移动状态为 %1").arg(wasMovable ? "可移动" : "不可移动"));
     
     return true;
 }
@@ -441,6 +460,7 @@ void RectangleGraphicItem::restoreFromPoints(const std::vector<QPointF>& points)
         m_topLeft = QPointF(-m_size.width()/2, -m_size.height()/2);
         
         // 更新缓存和图形显示
+        invalidateShapeCache();
         invalidateCache();
         update();
         
@@ -465,6 +485,7 @@ void RectangleGraphicItem::restoreFromPoints(const std::vector<QPointF>& points)
     m_topLeft = QPointF(-newSize.width()/2, -newSize.height()/2);
     
     // 更新缓存和图形显示
+    invalidateShapeCache();
     invalidateCache();
     update();
     
@@ -473,9 +494,23 @@ void RectangleGraphicItem::restoreFromPoints(const std::vector<QPointF>& points)
                 .arg(m_size.height()));
 }
 
+QList<QPolygonF> RectangleGraphicItem::simplifiedOutline(qreal pixelSize) const
+{
+    Q_UNUSED(pixelSize);
+    
+    // 使用路径的扁平化多边形（包括自定义裁剪路径）
+    return toPath().toSubpathPolygons();
+}
+
 // 重写绘制方法，支持自定义路径绘制
 void RectangleGraphicItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
+    // 低细节层次交给基类处理（边界框或简化折线）
+    if (detailLevel(painter, option, widget) != DetailFull) {
+        GraphicItem::paint(painter, option, widget);
+        return;
+    }
+    
     // 使用自定义路径绘制非矩形形状
     if (m_useCustomPath && !m_customClipPath.isEmpty()) {
         // 设置高质量渲染选项
@@ -40,9 +40,15 @@ public:
     
     // 重写裁剪相关方法
     bool clip(const QPainterPath& clipPath) override;
+    QPainterPath clipSubjectPath() const override;
+    bool applyClipResult(const QPainterPath& resultPath) override;
     QPainterPath toPath() const override;
     void restoreFromPoints(const std::vector<QPointF>& points) override;
     
+protected:
+    // 低细节层次下的简化轮廓
+    QList<QPolygonF> simplifiedOutline(qreal pixelSize) const override;
+    
 private:
     QPointF m_topLeft;  // 相对于中心点的偏移
     QSizeF m_size;      // 矩形基础尺寸
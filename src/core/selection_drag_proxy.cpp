@@ -0,0 +1,142 @@
+#include "selection_drag_proxy.h"
+#include <QSet>
+#include <QStyle>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+
+SelectionDragProxy::SelectionDragProxy(const QList<QGraphicsItem*>& items)
+    : QGraphicsItem()
+{
+    setFlag(QGraphicsItem::ItemIsSelectable, false);
+    setFlag(QGraphicsItem::ItemIsMovable, false);
+    setFlag(QGraphicsItem::ItemIsFocusable, false);
+    setAcceptHoverEvents(false);
+    setAcceptedMouseButtons(Qt::NoButton);
+
+    // 平移时复用缓存的位图，不再逐项重绘
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
+    // 祖先也被选中的项会随祖先一起绘制
+    const QSet<QGraphicsItem*> selected(items.begin(), items.end());
+    QList<QGraphicsItem*> roots;
+    for (QGraphicsItem* item : items) {
+        if (!item) {
+            continue;
+        }
+        bool ancestorSelected = false;
+        for (QGraphicsItem* parent = item->parentItem(); parent; parent = parent->parentItem()) {
+            if (selected.contains(parent)) {
+                ancestorSelected = true;
+                break;
+            }
+        }
+        if (!ancestorSelected) {
+            roots.append(item);
+        }
+    }
+
+    // 顶层选中项按Z值排序，相同Z值保持原有顺序
+    std::stable_sort(roots.begin(), roots.end(), [](QGraphicsItem* a, QGraphicsItem* b) {
+        return a->zValue() < b->zValue();
+    });
+
+    qreal topZ = 0.0;
+    for (QGraphicsItem* item : roots) {
+        appendEntries(item);
+        m_bounds = m_bounds.united(item->mapRectToScene(item->boundingRect() | item->childrenBoundingRect()));
+        topZ = qMax(topZ, item->zValue());
+    }
+
+    // 拖动中的图形显示在同层其他图形之上
+    setZValue(topZ);
+
+    // 记录完绘制条目后再隐藏原图形项，保证记录的是原有的不透明度
+    for (QGraphicsItem* item : roots) {
+        m_hidden.append(item);
+        m_hiddenOpacity.append(item->opacity());
+        item->setOpacity(0.0);
+    }
+}
+
+SelectionDragProxy::~SelectionDragProxy()
+{
+    restoreItems();
+}
+
+void SelectionDragProxy::appendEntries(QGraphicsItem* item)
+{
+    if (!item->isVisible()) {
+        return;
+    }
+
+    QList<QGraphicsItem*> children = item->childItems();
+    std::stable_sort(children.begin(), children.end(), [](QGraphicsItem* a, QGraphicsItem* b) {
+        return a->zValue() < b->zValue();
+    });
+
+    // 堆叠在父项之后的子项先绘制
+    for (QGraphicsItem* child : children) {
+        if (child->zValue() < 0 || (child->flags() & QGraphicsItem::ItemStacksBehindParent)) {
+            appendEntries(child);
+        }
+    }
+    m_entries.append(Entry{item, item->effectiveOpacity()});
+    for (QGraphicsItem* child : children) {
+        if (!(child->zValue() < 0 || (child->flags() & QGraphicsItem::ItemStacksBehindParent))) {
+            appendEntries(child);
+        }
+    }
+}
+
+void SelectionDragProxy::restoreItems()
+{
+    for (int i = 0; i < m_hidden.size(); ++i) {
+        m_hidden[i]->setOpacity(m_hiddenOpacity[i]);
+    }
+    m_hidden.clear();
+    m_hiddenOpacity.clear();
+    m_entries.clear();
+}
+
+QRectF SelectionDragProxy::boundingRect() const
+{
+    return m_bounds;
+}
+
+void SelectionDragProxy::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    // 代理项的本地坐标即拖动开始时的场景坐标，各项按自身的场景变换绘制
+    const QTransform baseTransform = painter->transform();
+    const qreal baseOpacity = painter->opacity();
+    QStyleOptionGraphicsItem itemOption;
+    itemOption.palette = option->palette;
+    for (const Entry& entry : m_entries) {
+        if (entry.opacity <= 0.0) {
+            continue;
+        }
+
+        painter->save();
+        painter->setTransform(entry.item->sceneTransform() * baseTransform);
+        painter->setOpacity(baseOpacity * entry.opacity);
+
+        const QRectF itemRect = entry.item->boundingRect();
+        itemOption.state = option->state;
+        itemOption.state.setFlag(QStyle::State_Selected, entry.item->isSelected());
+        itemOption.exposedRect = itemRect;
+        itemOption.rect = itemRect.toAlignedRect();
+        entry.item->paint(painter, &itemOption, widget);
+
+        painter->restore();
+    }
+}
+
+QPainterPath SelectionDragProxy::shape() const
+{
+    return QPainterPath();
+}
+
+bool SelectionDragProxy::contains(const QPointF &point) const
+{
+    Q_UNUSED(point);
+    return false;
+}
@@ -0,0 +1,47 @@
+#ifndef SELECTION_DRAG_PROXY_H
+#define SELECTION_DRAG_PROXY_H
+
+#include <QGraphicsItem>
+#include <QList>
+#include <QPainter>
+
+/**
+ * @brief 拖动选择时的代理项
+ *
+ * 拖动开始时记录选中项（及其子项）的绘制顺序和不透明度，把原图形项的不透明度设为0，
+ * 由代理项按各项的场景变换代为绘制。代理项使用设备坐标缓存，拖动过程中只改变
+ * 代理项自身的位置，缓存的位图直接平移，原图形项的位置、空间索引和连接线都不变。
+ * 拖动结束时恢复原图形项的不透明度，由调用方一次性提交实际位置。
+ */
+class SelectionDragProxy : public QGraphicsItem {
+public:
+    explicit SelectionDragProxy(const QList<QGraphicsItem*>& items);
+    ~SelectionDragProxy() override;
+
+    // QGraphicsItem接口
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+    // 不拦截鼠标事件
+    QPainterPath shape() const override;
+    bool contains(const QPointF &point) const override;
+
+    // 恢复原图形项的显示，可重复调用
+    void restoreItems();
+
+private:
+    struct Entry {
+        QGraphicsItem* item;
+        qreal opacity;  // 拖动开始时的有效不透明度
+    };
+
+    QList<Entry> m_entries;          // 按绘制顺序排列
+    QList<QGraphicsItem*> m_hidden;  // 被设置为透明的顶层选中项
+    QList<qreal> m_hiddenOpacity;
+    QRectF m_bounds;                 // 拖动开始时的场景边界
+
+    // 按父项与子项的堆叠关系追加绘制条目
+    void appendEntries(QGraphicsItem* item);
+};
+
+#endif // SELECTION_DRAG_PROXY_H
@@ -1,23 +1,51 @@
 #include "core/selection_manager.h"
 #include "ui/draw_area.h"
 #include "core/graphic_item.h"
+#include "core/spatial_index.h"
+#include "core/item_registry.h"
+#include "core/selection_drag_proxy.h"
+#include "utils/clip_algorithms.h"
 #include <QGraphicsScene>
 #include <QPainter>
 #include <QWidget>
+#include <QRegion>
 #include <QDebug>
 
+// 选择控制点的边长（视图像素）
+static const int SELECTION_HANDLE_SIZE = 8;
+
+// 视图中选择边框及控制点所在的环形区域（视口坐标），用于只重绘控制点
+static QRegion selectionHandleRegion(const QGraphicsView* view, const QRectF& bounds)
+{
+    const int margin = SELECTION_HANDLE_SIZE / 2 + 2;
+    const QRect outer = view->mapFromScene(bounds).boundingRect().adjusted(-margin, -margin, margin, margin);
+    const QRect inner = outer.adjusted(2 * margin, 2 * margin, -2 * margin, -2 * margin);
+    return inner.isValid() ? QRegion(outer).subtracted(QRegion(inner)) : QRegion(outer);
+}
+
 SelectionManager::SelectionManager(QGraphicsScene* scene)
     : QObject(nullptr)
     , m_scene(scene)
     , m_selectionRect(nullptr)
+    , m_lassoItem(nullptr)
+    , m_lassoSimplifier(0.5)
     , m_isDraggingSelection(false)
     , m_selectionMode(SingleSelection)
     , m_filter(nullptr)
+    , m_version(0)
+    , m_boundsValid(true)
+    , m_movingSelection(false)
+    , m_dragProxy(nullptr)
+    , m_listenerIndex(nullptr)
+    , m_listenerId(0)
 {
     // 创建选择区域矩形，但不添加到场景中
     m_selectionRect = new QGraphicsRectItem();
     m_selectionRect->setZValue(1000); // 确保选择矩形显示在其他项的顶部
+    m_lassoItem = new QGraphicsPathItem();
+    m_lassoItem->setZValue(1000);
     updateSelectionAppearance();
+    attachGeometryListener();
 }
 
 SelectionManager::~SelectionManager()
@@ -27,9 +55,11 @@ SelectionManager::~SelectionManager()
         
         // 断开所有信号连接
         this->disconnect();
+        detachGeometryListener();
+        finishLiveMove();
         
         // 安全地清除选择，不触发信号
-        m_selectedItems.clear();
+        clearSelected();
         
         // 安全检查：确保m_selectionRect有效并且在场景中
         if (m_selectionRect) {
@@ -40,6 +70,13 @@ SelectionManager::~SelectionManager()
             delete m_selectionRect;
             m_selectionRect = nullptr;
         }
+        if (m_lassoItem) {
+            if (m_lassoItem->scene() && m_scene && m_lassoItem->scene() == m_scene) {
+                m_scene->removeItem(m_lassoItem);
+            }
+            delete m_lassoItem;
+            m_lassoItem = nullptr;
+        }
         
         // 清空场景引用
         m_scene = nullptr;
@@ -56,15 +93,16 @@ SelectionManager::~SelectionManager()
 
 void SelectionManager::setScene(QGraphicsScene* scene)
 {
-    // 如果选择矩形在旧场景中，移除它
-    if (m_selectionRect && m_selectionRect->scene()) {
-        m_selectionRect->scene()->removeItem(m_selectionRect);
-    }
+    // 如果选择矩形或套索在旧场景中，移除它
+    removeSelectionItems();
+    finishLiveMove();
     
+    detachGeometryListener();
     m_scene = scene;
+    attachGeometryListener();
     
     // 清除当前选择
-    m_selectedItems.clear();
+    clearSelected();
     
     // 发出选择改变信号
     emit selectionChanged();
@@ -76,17 +114,25 @@ void SelectionManager::startSelection(const QPointF& startPoint, SelectionMode m
     m_currentPoint = startPoint;
     m_selectionMode = mode;
     
-    // 确保选择矩形已从场景中移除
-    if (m_selectionRect->scene()) {
-        m_selectionRect->scene()->removeItem(m_selectionRect);
-    }
-    
-    // 设置初始大小为0
-    m_selectionRect->setRect(QRectF(m_startPoint, QSizeF(0, 0)));
+    // 确保选择矩形和套索已从场景中移除
+    removeSelectionItems();
     
-    // 添加到场景
-    if (m_scene) {
-        m_scene->addItem(m_selectionRect);
+    if (m_selectionMode == LassoSelection) {
+        // 套索从起点开始记录轨迹
+        m_lassoSimplifier.reset();
+        m_lassoSimplifier.addPoint(m_startPoint);
+        m_lassoItem->setPath(QPainterPath(m_startPoint));
+        if (m_scene) {
+            m_scene->addItem(m_lassoItem);
+        }
+    } else {
+        // 设置初始大小为0
+        m_selectionRect->setRect(QRectF(m_startPoint, QSizeF(0, 0)));
+        
+        // 添加到场景
+        if (m_scene) {
+            m_scene->addItem(m_selectionRect);
+        }
     }
     
     // 在多选模式下，保存之前的选择
@@ -94,8 +140,10 @@ void SelectionManager::startSelection(const QPointF& startPoint, SelectionMode m
         m_previousSelection = m_selectedItems;
     } else if (m_selectionMode == SingleSelection) {
         // 在单选模式下，清除之前的选择
-        m_selectedItems.clear();
+        clearSelected();
     }
+    m_rectItems.clear();
+    m_lastSelectionRect = QRectF();
     
     // 发出选择开始信号
     emit selectionStarted();
@@ -105,6 +153,14 @@ void SelectionManager::updateSelection(const QPointF& currentPoint)
 {
     m_currentPoint = currentPoint;
     
+    // 套索只记录轨迹，松开鼠标时再确定选择
+    if (m_selectionMode == LassoSelection) {
+        // 显示的轨迹由简化后的顶点构成，顶点数不随鼠标事件数增长
+        m_lassoSimplifier.addPoint(currentPoint);
+        m_lassoItem->setPath(ClipAlgorithms::pointsToPath(m_lassoSimplifier.points(), true));
+        return;
+    }
+    
     // 计算选择区域
     qreal left = qMin(m_startPoint.x(), m_currentPoint.x());
     qreal top = qMin(m_startPoint.y(), m_currentPoint.y());
@@ -113,20 +169,28 @@ void SelectionManager::updateSelection(const QPointF& currentPoint)
     
     // 更新选择矩形的位置和大小
     m_selectionRect->setRect(QRectF(left, top, width, height));
+    
+    // 拖动过程中只增减进出矩形的项并切换其选中状态（由各项自行重绘），
+    // 选择集合在结束时统一更新
+    updateSelectionFromRect();
 }
 
 void SelectionManager::finishSelection()
 {
-    // 如果选择区域有效
-    if (isSelectionValid()) {
-        // 根据选择区域更新选择的项
+    if (m_selectionMode == LassoSelection) {
+        updateSelectionFromLasso();
+    } else {
+        // 根据最终的选择区域更新选择的项（与最后一次拖动的矩形相同时无需查询）
         updateSelectionFromRect();
+        for (QGraphicsItem* item : m_rectItems) {
+            insertSelected(item);
+        }
+        m_rectItems.clear();
+        m_lastSelectionRect = QRectF();
     }
     
-    // 如果选择矩形在场景中，移除它
-    if (m_selectionRect && m_selectionRect->scene()) {
-        m_selectionRect->scene()->removeItem(m_selectionRect);
-    }
+    // 如果选择矩形或套索在场景中，移除它
+    removeSelectionItems();
     
     // 应用选择到场景
     applySelectionToScene();
@@ -138,21 +202,35 @@ void SelectionManager::finishSelection()
 
 void SelectionManager::updateSelectionFromRect()
 {
-    // 如果没有场景或选择矩形无效，返回
-    if (!m_scene || !isSelectionValid()) {
+    if (!m_scene) {
         return;
     }
     
-    // 获取选择区域内的所有图形项
-    QList<QGraphicsItem*> itemsInRect = m_scene->items(getSelectionRect());
+    // 选择区域过小时视为没有选中任何项
+    const QRectF selectionRect = isSelectionValid() ? getSelectionRect() : QRectF();
+    if (selectionRect == m_lastSelectionRect) {
+        return;
+    }
     
-    // 如果是单选模式，清除之前的选择
-    if (m_selectionMode == SingleSelection) {
-        m_selectedItems.clear();
+    // 只有新旧矩形之差的条带中的项可能进出选择，首次查询时为整个矩形
+    QSet<QGraphicsItem*> candidates;
+    if (m_lastSelectionRect.isNull()) {
+        collectItemsInRect(selectionRect, candidates);
+    } else if (selectionRect.isNull()) {
+        candidates = m_rectItems;
+    } else {
+        QList<QRectF> strips;
+        subtractRect(selectionRect, m_lastSelectionRect, strips);
+        subtractRect(m_lastSelectionRect, selectionRect, strips);
+        for (const QRectF& strip : strips) {
+            collectItemsInRect(strip, candidates);
+        }
     }
+    m_lastSelectionRect = selectionRect;
     
-    // 处理每个选择区域内的项
-    for (QGraphicsItem* item : itemsInRect) {
+    QPainterPath selectionPath;
+    selectionPath.addRect(selectionRect);
+    for (QGraphicsItem* item : candidates) {
         // 跳过选择矩形自身
         if (item == m_selectionRect) {
             continue;
@@ -168,8 +246,128 @@ void SelectionManager::updateSelectionFromRect()
             continue;
         }
         
-        // 添加到选择集合
-        m_selectedItems.insert(item);
+        const bool inRect = !selectionRect.isNull() && isItemInSelectionRect(item, selectionRect, selectionPath);
+        if (inRect == m_rectItems.contains(item)) {
+            continue;
+        }
+        if (inRect) {
+            m_rectItems.insert(item);
+        } else {
+            m_rectItems.remove(item);
+        }
+        item->setSelected(inRect);
+    }
+}
+
+void SelectionManager::updateSelectionFromLasso()
+{
+    if (!m_scene || !isSelectionValid()) {
+        return;
+    }
+    
+    const std::vector<QPointF> polygon = m_lassoSimplifier.points();
+    if (polygon.size() < 3) {
+        return;
+    }
+    const QPainterPath lassoPath = m_lassoItem->path();
+    
+    // 先按套索的边界框取候选项
+    std::vector<QGraphicsItem*> candidates;
+    std::vector<QRectF> candidateRects;
+    auto addCandidate = [&](QGraphicsItem* item, const QRectF& rect) {
+        if (item == m_selectionRect || item == m_lassoItem || !applyFilter(item)) {
+            return;
+        }
+        candidates.push_back(item);
+        candidateRects.push_back(rect);
+    };
+    visitCandidates(lassoPath.boundingRect(), addCandidate);
+    
+    // 再把所有候选项的边界与套索多边形批量分类，只有与套索边界相交的项需要精确的形状检测
+    const std::vector<ClipAlgorithms::RegionRelation> relations =
+        ClipAlgorithms::classifyRects(polygon, candidateRects);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        QGraphicsItem* item = candidates[i];
+        if (relations[i] == ClipAlgorithms::RegionRelation::Inside) {
+            insertSelected(item);
+        } else if (relations[i] == ClipAlgorithms::RegionRelation::Partial) {
+            if (item->collidesWithPath(item->mapFromScene(lassoPath), Qt::IntersectsItemShape)) {
+                insertSelected(item);
+            }
+        }
+    }
+}
+
+bool SelectionManager::isItemInSelectionRect(QGraphicsItem* item, const QRectF& rect, const QPainterPath& path) const
+{
+    // 完全包含在矩形内的项无需做形状检测
+    const QRectF itemRect = item->sceneBoundingRect();
+    if (rect.contains(itemRect)) {
+        return true;
+    }
+    if (!rect.intersects(itemRect)) {
+        return false;
+    }
+    return item->collidesWithPath(item->mapFromScene(path), Qt::IntersectsItemShape);
+}
+
+void SelectionManager::collectItemsInRect(const QRectF& rect, QSet<QGraphicsItem*>& items) const
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+    
+    visitCandidates(rect, [&items](QGraphicsItem* item, const QRectF&) {
+        items.insert(item);
+    });
+}
+
+void SelectionManager::visitCandidates(const QRectF& rect,
+                                       const std::function<void(QGraphicsItem*, const QRectF&)>& visitor) const
+{
+    SpatialIndex* index = SpatialIndex::forScene(m_scene);
+    if (index) {
+        index->visit(rect, visitor);
+    }
+    
+    // 空间索引只登记GraphicItem，其余图形项仍由场景自身的索引查询
+    for (QGraphicsItem* item : m_scene->items(rect, Qt::IntersectsItemBoundingRect)) {
+        if (!index || !index->contains(item)) {
+            visitor(item, item->sceneBoundingRect());
+        }
+    }
+}
+
+void SelectionManager::removeSelectionItems()
+{
+    if (m_selectionRect && m_selectionRect->scene()) {
+        m_selectionRect->scene()->removeItem(m_selectionRect);
+    }
+    if (m_lassoItem && m_lassoItem->scene()) {
+        m_lassoItem->scene()->removeItem(m_lassoItem);
+    }
+}
+
+void SelectionManager::subtractRect(const QRectF& rect, const QRectF& hole, QList<QRectF>& result)
+{
+    const QRectF overlap = rect.intersected(hole);
+    if (overlap.isEmpty()) {
+        result.append(rect);
+        return;
+    }
+    
+    // 上下两条占满宽度，左右两条只取重叠部分的高度
+    if (overlap.top() > rect.top()) {
+        result.append(QRectF(rect.left(), rect.top(), rect.width(), overlap.top() - rect.top()));
+    }
+    if (overlap.bottom() < rect.bottom()) {
+        result.append(QRectF(rect.left(), overlap.bottom(), rect.width(), rect.bottom() - overlap.bottom()));
+    }
+    if (overlap.left() > rect.left()) {
+        result.append(QRectF(rect.left(), overlap.top(), overlap.left() - rect.left(), overlap.height()));
+    }
+    if (overlap.right() < rect.right()) {
+        result.append(QRectF(overlap.right(), overlap.top(), rect.right() - overlap.right(), overlap.height()));
     }
 }
 
@@ -188,10 +386,13 @@ void SelectionManager::clearSelection()
 {
     qDebug() << "SelectionManager::clearSelection: 开始清除选择";
     
+    // 清除前结束未完成的实时拖动，恢复图形项的显示
+    finishLiveMove();
+    
     // 检查对象有效性
     if (!m_scene) {
         qDebug() << "SelectionManager::clearSelection: 场景为空，无需清除";
-        m_selectedItems.clear();
+        clearSelected();
         m_isDraggingSelection = false;
         return;
     }
@@ -204,6 +405,9 @@ void SelectionManager::clearSelection()
             m_scene->removeItem(m_selectionRect);
         }
     }
+    if (m_lassoItem && m_lassoItem->scene() == m_scene) {
+        m_scene->removeItem(m_lassoItem);
+    }
     
     // 记录被清除的项目数量
     int itemCount = m_selectedItems.size();
@@ -212,7 +416,11 @@ void SelectionManager::clearSelection()
     // 安全清除当前选择
     QSet<QGraphicsItem*> itemsToDeselect;
     for (QGraphicsItem* item : m_selectedItems) {
-        if (item && m_scene->items().contains(item)) {
+        // GraphicItem通过存活登记表O(1)判断；其他类型的图形项退回遍历场景
+        const bool inScene = ItemRegistry::isAlive(item)
+            ? ItemRegistry::isInScene(item, m_scene)
+            : (item && m_scene->items().contains(item));
+        if (inScene) {
             itemsToDeselect.insert(item);
         }
     }
@@ -225,7 +433,7 @@ void SelectionManager::clearSelection()
     }
     
     // 清除选择集合
-    m_selectedItems.clear();
+    clearSelected();
     
     // 应用选择到场景
     if (m_scene) {
@@ -243,11 +451,18 @@ void SelectionManager::clearSelection()
 
 QRectF SelectionManager::getSelectionRect() const
 {
+    if (m_selectionMode == LassoSelection) {
+        return m_lassoItem ? m_lassoItem->path().boundingRect() : QRectF();
+    }
     return m_selectionRect ? m_selectionRect->rect() : QRectF();
 }
 
 QPainterPath SelectionManager::getSelectionPath() const
 {
+    if (m_selectionMode == LassoSelection) {
+        return m_lassoItem ? m_lassoItem->path() : QPainterPath();
+    }
+    
     QPainterPath path;
     if (m_selectionRect) {
         path.addRect(m_selectionRect->rect());
@@ -261,7 +476,7 @@ bool SelectionManager::isSelectionValid() const
         return false;
     }
     
-    QRectF rect = m_selectionRect->rect();
+    QRectF rect = getSelectionRect();
     return rect.width() > 5 && rect.height() > 5; // 确保选择区域足够大
 }
 
@@ -271,6 +486,10 @@ void SelectionManager::setSelectionAppearance(const QPen& pen, const QBrush& bru
         m_selectionRect->setPen(pen);
         m_selectionRect->setBrush(brush);
     }
+    if (m_lassoItem) {
+        m_lassoItem->setPen(pen);
+        m_lassoItem->setBrush(brush);
+    }
 }
 
 void SelectionManager::updateSelectionAppearance()
@@ -285,29 +504,186 @@ void SelectionManager::updateSelectionAppearance()
         
         m_selectionRect->setPen(pen);
         m_selectionRect->setBrush(brush);
+        if (m_lassoItem) {
+            m_lassoItem->setPen(pen);
+            m_lassoItem->setBrush(brush);
+        }
     }
 }
 
 bool SelectionManager::contains(const QPointF& point) const
 {
+    if (m_selectionMode == LassoSelection) {
+        return m_lassoItem && m_lassoItem->path().contains(point);
+    }
     return m_selectionRect && m_selectionRect->rect().contains(point);
 }
 
 void SelectionManager::moveSelection(const QPointF& offset)
 {
-    // 移动所有选中的图形项
+    // 移动所有选中的图形项，总边界随之平移而不必重算
+    m_movingSelection = true;
+    bool allMoved = true;
     for (QGraphicsItem* item : m_selectedItems) {
+        const QPointF oldPos = item->pos();
         item->moveBy(offset.x(), offset.y());
+        // 不可移动的项会拒绝位置变化
+        if (item->pos() == oldPos && !offset.isNull()) {
+            allMoved = false;
+        }
+    }
+    m_movingSelection = false;
+    if (allMoved) {
+        m_bounds.translate(offset);
+    } else {
+        m_boundsValid = false;
     }
     
     // 发出选择改变信号
     emit selectionChanged();
 }
 
+void SelectionManager::beginLiveMove()
+{
+    if (m_dragProxy || !m_scene || m_selectedItems.isEmpty()) {
+        return;
+    }
+    
+    m_dragProxy = new SelectionDragProxy(getSelectedItems());
+    m_scene->addItem(m_dragProxy);
+    m_liveMoveOffset = QPointF();
+}
+
+void SelectionManager::updateLiveMove(const QPointF& totalOffset)
+{
+    if (!m_dragProxy) {
+        return;
+    }
+    
+    // 只移动代理项，缓存的绘制结果随之平移
+    const QRectF oldBounds = selectionBounds().translated(m_liveMoveOffset);
+    m_liveMoveOffset = totalOffset;
+    m_dragProxy->setPos(totalOffset);
+    
+    // 控制点绘制在前景层，只重绘新旧控制点所在的区域
+    const QRectF newBounds = selectionBounds().translated(totalOffset);
+    if (m_scene) {
+        for (QGraphicsView* view : m_scene->views()) {
+            view->viewport()->update(selectionHandleRegion(view, oldBounds) + selectionHandleRegion(view, newBounds));
+        }
+    }
+}
+
+QPointF SelectionManager::finishLiveMove()
+{
+    if (!m_dragProxy) {
+        return QPointF();
+    }
+    
+    m_dragProxy->restoreItems();
+    if (m_dragProxy->scene()) {
+        m_dragProxy->scene()->removeItem(m_dragProxy);
+    }
+    delete m_dragProxy;
+    m_dragProxy = nullptr;
+    
+    const QPointF offset = m_liveMoveOffset;
+    m_liveMoveOffset = QPointF();
+    return offset;
+}
+
 QList<QGraphicsItem*> SelectionManager::getSelectedItems() const
 {
-    // 将QSet转换为QList，使用QList构造函数而不是toList方法
-    return QList<QGraphicsItem*>(m_selectedItems.begin(), m_selectedItems.end());
+    // QList隐式共享，返回快照中的列表只增加引用计数
+    return snapshot()->items;
+}
+
+std::shared_ptr<const SelectionManager::Snapshot> SelectionManager::snapshot() const
+{
+    if (!m_snapshot || m_snapshot->version != m_version) {
+        auto current = std::make_shared<Snapshot>();
+        current->version = m_version;
+        current->items = QList<QGraphicsItem*>(m_selectedItems.begin(), m_selectedItems.end());
+        m_snapshot = std::move(current);
+    }
+    return m_snapshot;
+}
+
+QRectF SelectionManager::selectionBounds() const
+{
+    // 选择中含有不会通知几何变化的项时无法判断缓存是否过期，每次都重算
+    if (!m_boundsValid || !m_listenerIndex || !m_untrackedItems.isEmpty()) {
+        QRectF bounds;
+        for (QGraphicsItem* item : m_selectedItems) {
+            if (item) {
+                bounds = bounds.united(item->sceneBoundingRect());
+            }
+        }
+        m_bounds = bounds;
+        m_boundsValid = true;
+    }
+    return m_bounds;
+}
+
+void SelectionManager::insertSelected(QGraphicsItem* item)
+{
+    if (!item || m_selectedItems.contains(item)) {
+        return;
+    }
+    m_selectedItems.insert(item);
+    if (!dynamic_cast<GraphicItem*>(item)) {
+        m_untrackedItems.insert(item);
+    }
+    ++m_version;
+    if (m_boundsValid) {
+        m_bounds = m_bounds.united(item->sceneBoundingRect());
+    }
+}
+
+void SelectionManager::removeSelected(QGraphicsItem* item)
+{
+    if (!m_selectedItems.remove(item)) {
+        return;
+    }
+    m_untrackedItems.remove(item);
+    ++m_version;
+    // 被移除的项可能已经失效，不读取其边界，直接让总边界失效
+    m_boundsValid = false;
+}
+
+void SelectionManager::clearSelected()
+{
+    if (m_selectedItems.isEmpty()) {
+        return;
+    }
+    m_selectedItems.clear();
+    m_untrackedItems.clear();
+    ++m_version;
+    m_bounds = QRectF();
+    m_boundsValid = true;
+}
+
+void SelectionManager::attachGeometryListener()
+{
+    m_listenerIndex = SpatialIndex::forScene(m_scene);
+    if (!m_listenerIndex) {
+        return;
+    }
+    m_listenerId = m_listenerIndex->addGeometryListener([this](QGraphicsItem* item) {
+        if (m_boundsValid && !m_movingSelection && m_selectedItems.contains(item)) {
+            m_boundsValid = false;
+        }
+    });
+}
+
+void SelectionManager::detachGeometryListener()
+{
+    // 索引可能已先于选择管理器销毁，仍在注册表中时才注销
+    if (m_listenerIndex && SpatialIndex::forScene(m_scene) == m_listenerIndex) {
+        m_listenerIndex->removeGeometryListener(m_listenerId);
+    }
+    m_listenerIndex = nullptr;
+    m_listenerId = 0;
 }
 
 GraphicItem::ControlHandle SelectionManager::handleAtPoint(const QPointF& point) const
@@ -385,21 +761,7 @@ void SelectionManager::scaleSelection(GraphicItem::ControlHandle handle, const Q
     qDebug() << "SelectionManager::scaleSelection: 尝试缩放选择，控制点类型:" << handle << "位置:" << point;
     
     // 获取选中项的边界矩形
-    QRectF boundingRect;
-    bool first = true;
-    for (QGraphicsItem* item : m_selectedItems) {
-        if (!item) continue;
-        
-        // 使用sceneBoundingRect确保获取图形项在场景中的精确边界
-        QRectF itemRect = item->sceneBoundingRect();
-        
-        if (first) {
-            boundingRect = itemRect;
-            first = false;
-        } else {
-            boundingRect = boundingRect.united(itemRect);
-        }
-    }
+    QRectF boundingRect = selectionBounds();
     
     // 计算缩放因子
     qreal scaleX = 1.0;
@@ -472,23 +834,8 @@ void SelectionManager::scaleSelection(GraphicItem::ControlHandle handle, const Q
     
     // 更新选择矩形
     if (m_selectionRect && m_selectionRect->scene()) {
-        // 重新计算选中项的边界矩形
-        QRectF newBoundingRect;
-        bool first = true;
-        for (QGraphicsItem* item : m_selectedItems) {
-            if (!item) continue;
-            
-            // 使用精确的边界矩形计算
-            QRectF itemRect = item->sceneBoundingRect();
-            
-            if (first) {
-                newBoundingRect = itemRect;
-                first = false;
-            } else {
-                newBoundingRect = newBoundingRect.united(itemRect);
-            }
-        }
-        m_selectionRect->setRect(newBoundingRect);
+        // 缩放使总边界失效，这里会重新计算一次
+        m_selectionRect->setRect(selectionBounds());
     } else {
         qDebug() << "SelectionManager::scaleSelection: 选择矩形不存在或不在场景中，无法更新选择区域";
     }
@@ -506,30 +853,15 @@ void SelectionManager::paint(QPainter* painter, const QGraphicsView* view)
     
     painter->save();
     
-    // 计算选中项的边界矩形
-    QRectF boundingRect;
-    bool first = true;
-    for (QGraphicsItem* item : m_selectedItems) {
-        if (!item) continue;
-        
-        // 使用sceneBoundingRect确保获取图形项在场景中的精确边界
-        // 这对椭圆等特殊图形尤为重要
-        QRectF itemRect = item->sceneBoundingRect();
-        
-        if (first) {
-            boundingRect = itemRect;
-            first = false;
-        } else {
-            boundingRect = boundingRect.united(itemRect);
-        }
-    }
+    // 选中项的边界矩形（增量维护，不必每次绘制都遍历选中项）；实时拖动时跟随代理项
+    const QRectF boundingRect = selectionBounds().translated(m_liveMoveOffset);
     
     // 设置控制点样式
     painter->setPen(QPen(Qt::blue, 1));
     painter->setBrush(QBrush(Qt::white));
     
     // 控制点大小
-    const int handleSize = 8;
+    const int handleSize = SELECTION_HANDLE_SIZE;
     
     // 现在我们可以使用QGraphicsView的mapFromScene方法
     if (view) {
@@ -627,7 +959,7 @@ void SelectionManager::addToSelection(QGraphicsItem* item)
 {
     // 如果项有效且通过过滤器
     if (item && applyFilter(item)) {
-        m_selectedItems.insert(item);
+        insertSelected(item);
         applySelectionToScene();
         emit selectionChanged();
     }
@@ -637,7 +969,7 @@ void SelectionManager::removeFromSelection(QGraphicsItem* item)
 {
     // 如果项在选择中
     if (m_selectedItems.contains(item)) {
-        m_selectedItems.remove(item);
+        removeSelected(item);
         applySelectionToScene();
         emit selectionChanged();
     }
@@ -647,9 +979,9 @@ void SelectionManager::toggleSelection(QGraphicsItem* item)
 {
     // 如果项已选中，取消选择；否则，添加到选择
     if (m_selectedItems.contains(item)) {
-        m_selectedItems.remove(item);
+        removeSelected(item);
     } else if (applyFilter(item)) {
-        m_selectedItems.insert(item);
+        insertSelected(item);
     }
     
     applySelectionToScene();
@@ -668,23 +1000,7 @@ QPointF SelectionManager::selectionCenter() const
         return QPointF();
     }
     
-    QRectF boundingRect;
-    bool first = true;
-    for (QGraphicsItem* item : m_selectedItems) {
-        if (!item) continue;
-        
-        // 使用精确的边界矩形计算
-        QRectF itemRect = item->sceneBoundingRect();
-        
-        if (first) {
-            boundingRect = itemRect;
-            first = false;
-        } else {
-            boundingRect = boundingRect.united(itemRect);
-        }
-    }
-    
-    return boundingRect.center();
+    return selectionBounds().center();
 }
 
 void SelectionManager::applySelectionToScene()
@@ -695,10 +1011,10 @@ void SelectionManager::applySelectionToScene()
         return;
     }
     
-    // 先清除所有项的选择状态
-    QList<QGraphicsItem*> items = m_scene->items();
+    // 先清除已选中项的选择状态（只需遍历场景的选中集合，而不是全部项）
+    const QList<QGraphicsItem*> items = m_scene->selectedItems();
     for (QGraphicsItem* item : items) {
-        if (item) {
+        if (item && !m_selectedItems.contains(item)) {
             item->setSelected(false);
         }
     }
@@ -734,7 +1050,7 @@ void SelectionManager::applySelectionToScene()
     
     // 从选择集合中移除无效项
     for (QGraphicsItem* item : invalidItems) {
-        m_selectedItems.remove(item);
+        removeSelected(item);
     }
 }
 
@@ -750,7 +1066,7 @@ void SelectionManager::syncSelectionFromScene()
     
     // 清除当前选择
     int oldCount = m_selectedItems.size();
-    m_selectedItems.clear();
+    clearSelected();
     
     // 将场景中所有选中的项添加到选择中
     QList<QGraphicsItem*> sceneSelectedItems = m_scene->selectedItems();
@@ -763,7 +1079,7 @@ void SelectionManager::syncSelectionFromScene()
         }
         
         if (applyFilter(item)) {
-            m_selectedItems.insert(item);
+            insertSelected(item);
             newCount++;
         }
     }
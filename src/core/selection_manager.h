@@ -6,15 +6,20 @@
 #include <QPainterPath>
 #include <QList>
 #include <QGraphicsRectItem>
+#include <QGraphicsPathItem>
 #include <QGraphicsScene>
 #include <QObject>
 #include <QPainter>
 #include <QSet>
 #include <QGraphicsView>
 #include <functional>
+#include <memory>
 #include "../core/graphic_item.h"
+#include "../utils/clip_algorithms.h"
 
 class GraphicItem;
+class SpatialIndex;
+class SelectionDragProxy;
 
 // 选择区域管理器类，负责处理选择区域的创建、显示和交互
 class SelectionManager : public QObject {
@@ -26,11 +31,18 @@ public:
         SingleSelection,    // 单选模式
         MultiSelection,     // 多选模式（保持之前的选择）
         RectSelection,      // 矩形区域选择
+        LassoSelection,     // 自由套索选择
     };
     
     // 选择过滤器接口
     using SelectionFilter = std::function<bool(QGraphicsItem*)>;
     
+    // 选择快照：创建后不再改变，版本号相同的快照包含相同的项
+    struct Snapshot {
+        quint64 version = 0;
+        QList<QGraphicsItem*> items;
+    };
+    
     explicit SelectionManager(QGraphicsScene* scene = nullptr);
     ~SelectionManager();
     
@@ -64,9 +76,30 @@ public:
     // 处理选择区域的移动
     void moveSelection(const QPointF& offset);
     
-    // 获取选择区域中的所有图形项
+    // 实时拖动：拖动过程中只移动绘制选中项的代理，图形项本身保持不动
+    void beginLiveMove();
+    void updateLiveMove(const QPointF& totalOffset);
+    
+    // 结束实时拖动，恢复图形项的显示并返回总偏移；实际移动由调用方（通常以命令）提交
+    QPointF finishLiveMove();
+    bool isLiveMoving() const { return m_dragProxy != nullptr; }
+    
+    // 获取选择区域中的所有图形项（返回快照中的列表，选择未改变时不复制）
     QList<QGraphicsItem*> getSelectedItems() const;
     
+    // 获取当前选择的快照，选择未改变时返回同一个对象
+    std::shared_ptr<const Snapshot> snapshot() const;
+    
+    // 选择版本号，选择集合每次改变时递增
+    quint64 selectionVersion() const { return m_version; }
+    
+    // 选中项数量
+    int selectedCount() const { return m_selectedItems.size(); }
+    bool hasSelection() const { return !m_selectedItems.isEmpty(); }
+    
+    // 选中项的总边界（场景坐标）
+    QRectF selectionBounds() const;
+    
     // 设置是否正在拖动选择区域
     void setDraggingSelection(bool dragging) { m_isDraggingSelection = dragging; }
     
@@ -133,22 +166,74 @@ signals:
 private:
     QGraphicsScene* m_scene;
     QGraphicsRectItem* m_selectionRect;
+    QGraphicsPathItem* m_lassoItem;
+    ClipAlgorithms::StreamingSimplifier m_lassoSimplifier;  // 套索轨迹，共线的点会被去除
     QPointF m_startPoint;
     QPointF m_currentPoint;
     bool m_isDraggingSelection;
     SelectionMode m_selectionMode;
     SelectionFilter m_filter;
-    QSet<QGraphicsItem*> m_selectedItems;  // 使用集合存储选中的项
+    QSet<QGraphicsItem*> m_selectedItems;  // 使用集合存储选中的项，只通过insertSelected等方法修改
+    
+    // 选择版本及按版本缓存的快照
+    quint64 m_version;
+    mutable std::shared_ptr<const Snapshot> m_snapshot;
+    
+    // 选中项的总边界：增加项时合并，整体移动时平移，其他变化使其失效后在下次查询时重算。
+    // 选中项的几何变化通过空间索引的监听器得知，场景没有空间索引时每次查询都重算
+    mutable QRectF m_bounds;
+    mutable bool m_boundsValid;
+    QSet<QGraphicsItem*> m_untrackedItems;  // 不是GraphicItem的选中项（如导入的位图），几何变化不会通知空间索引
+    bool m_movingSelection;              // moveSelection期间忽略选中项的几何变化通知
+    
+    // 实时拖动的代理项及当前偏移
+    SelectionDragProxy* m_dragProxy;
+    QPointF m_liveMoveOffset;
+    SpatialIndex* m_listenerIndex;
+    int m_listenerId;
     QSet<QGraphicsItem*> m_previousSelection; // 用于保存多选模式下的之前选择
     
+    // 区域选择过程中由选择矩形选中的项（不含多选模式下原有的选择）及对应的矩形，结束时并入选择集合；
+    // 矩形变化时只查询新旧矩形之差的条带，增减进出矩形的项
+    QSet<QGraphicsItem*> m_rectItems;
+    QRectF m_lastSelectionRect;
+    
     // 更新选择区域的外观
     void updateSelectionAppearance();
     
     // 应用过滤器
     bool applyFilter(QGraphicsItem* item) const;
     
-    // 更新选择
+    // 按当前选择矩形增量更新选择
     void updateSelectionFromRect();
+    
+    // 判断图形项是否被选择矩形选中：完全包含，或形状与矩形相交
+    bool isItemInSelectionRect(QGraphicsItem* item, const QRectF& rect, const QPainterPath& path) const;
+    
+    // 访问边界与矩形相交的图形项及其场景边界：GraphicItem取自空间索引，
+    // 导入的位图、填充结果等不在索引中的图形项向场景查询
+    void visitCandidates(const QRectF& rect, const std::function<void(QGraphicsItem*, const QRectF&)>& visitor) const;
+    
+    // 收集边界与矩形相交的图形项
+    void collectItemsInRect(const QRectF& rect, QSet<QGraphicsItem*>& items) const;
+    
+    // 计算rect减去hole后剩余的部分（最多4个矩形）
+    static void subtractRect(const QRectF& rect, const QRectF& hole, QList<QRectF>& result);
+    
+    // 选择被套索圈住或与套索相交的项
+    void updateSelectionFromLasso();
+    
+    // 从场景中移除选择矩形和套索
+    void removeSelectionItems();
+    
+    // 修改选择集合，同时维护版本号和总边界
+    void insertSelected(QGraphicsItem* item);
+    void removeSelected(QGraphicsItem* item);
+    void clearSelected();
+    
+    // 在当前场景的空间索引上登记/注销几何变化监听器
+    void attachGeometryListener();
+    void detachGeometryListener();
 };
 
 #endif // SELECTION_MANAGER_H 
\ No newline at end of file
@@ -0,0 +1,453 @@
+#include "spatial_index.h"
+#include "graphic_item.h"
+#include "../utils/logger.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+
+SpatialIndex::SpatialIndex(QGraphicsScene* scene)
+    : m_scene(scene)
+{
+    m_root = new Node();
+    if (m_scene) {
+        registry().insert(m_scene, this);
+    }
+}
+
+SpatialIndex::~SpatialIndex()
+{
+    if (m_scene && registry().value(m_scene) == this) {
+        registry().remove(m_scene);
+    }
+    freeNode(m_root);
+    m_root = nullptr;
+}
+
+QHash<const QGraphicsScene*, SpatialIndex*>& SpatialIndex::registry()
+{
+    static QHash<const QGraphicsScene*, SpatialIndex*> s_registry;
+    return s_registry;
+}
+
+SpatialIndex* SpatialIndex::forScene(const QGraphicsScene* scene)
+{
+    if (!scene) {
+        return nullptr;
+    }
+    return registry().value(scene, nullptr);
+}
+
+void SpatialIndex::rebuild()
+{
+    if (!m_scene) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 收集场景中所有GraphicItem的边界
+    std::vector<Entry> entries;
+    const QList<QGraphicsItem*> sceneItems = m_scene->items();
+    entries.reserve(sceneItems.size());
+    for (QGraphicsItem* item : sceneItems) {
+        if (dynamic_cast<GraphicItem*>(item)) {
+            Entry entry;
+            entry.rect = item->sceneBoundingRect();
+            entry.item = item;
+            entries.push_back(entry);
+        }
+    }
+
+    clear();
+    if (!entries.empty()) {
+        freeNode(m_root);
+        m_root = bulkLoad(std::move(entries), true);
+        m_root->parent = nullptr;
+    }
+
+    Logger::debug(QString("SpatialIndex::rebuild: 已索引 %1 个图形项，耗时 %2 ms")
+                  .arg(m_leafOf.size()).arg(timer.elapsed()));
+}
+
+void SpatialIndex::clear()
+{
+    freeNode(m_root);
+    m_root = new Node();
+    m_leafOf.clear();
+    m_dirtyItems.clear();
+}
+
+void SpatialIndex::markDirty(QGraphicsItem* item)
+{
+    if (item) {
+        m_dirtyItems.insert(item);
+        for (const auto& listener : m_geometryListeners) {
+            listener.second(item);
+        }
+    }
+}
+
+int SpatialIndex::addGeometryListener(const GeometryListener& listener)
+{
+    const int id = m_nextListenerId++;
+    m_geometryListeners.push_back({id, listener});
+    return id;
+}
+
+void SpatialIndex::removeGeometryListener(int id)
+{
+    m_geometryListeners.erase(std::remove_if(m_geometryListeners.begin(), m_geometryListeners.end(),
+                                             [id](const auto& listener) { return listener.first == id; }),
+                              m_geometryListeners.end());
+}
+
+void SpatialIndex::remove(QGraphicsItem* item)
+{
+    if (!item) {
+        return;
+    }
+    m_dirtyItems.remove(item);
+    removeEntry(item);
+}
+
+QList<QGraphicsItem*> SpatialIndex::items(const QRectF& rect) const
+{
+    QList<QGraphicsItem*> result;
+    visit(rect, [&result](QGraphicsItem* item, const QRectF&) {
+        result.append(item);
+    });
+    return result;
+}
+
+void SpatialIndex::visit(const QRectF& rect,
+                         const std::function<void(QGraphicsItem*, const QRectF&)>& visitor) const
+{
+    flush();
+    if (!m_root || m_root->entries.empty()) {
+        return;
+    }
+
+    std::vector<const Node*> stack;
+    stack.push_back(m_root);
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        for (const Entry& entry : node->entries) {
+            if (!overlaps(entry.rect, rect)) {
+                continue;
+            }
+            if (node->leaf) {
+                visitor(entry.item, entry.rect);
+            } else {
+                stack.push_back(entry.child);
+            }
+        }
+    }
+}
+
+bool SpatialIndex::contains(QGraphicsItem* item) const
+{
+    flush();
+    return m_leafOf.contains(item);
+}
+
+int SpatialIndex::count() const
+{
+    flush();
+    return m_leafOf.size();
+}
+
+void SpatialIndex::flush() const
+{
+    if (!m_dirtyItems.isEmpty()) {
+        const_cast<SpatialIndex*>(this)->flushDirty();
+    }
+}
+
+void SpatialIndex::flushDirty()
+{
+    const QSet<QGraphicsItem*> dirty = m_dirtyItems;
+    m_dirtyItems.clear();
+
+    for (QGraphicsItem* item : dirty) {
+        removeEntry(item);
+        // 只索引仍在本场景中的图形项
+        if (item->scene() == m_scene) {
+            insertEntry(item, item->sceneBoundingRect());
+        }
+    }
+}
+
+void SpatialIndex::insertEntry(QGraphicsItem* item, const QRectF& rect)
+{
+    Node* leaf = chooseLeaf(rect);
+
+    Entry entry;
+    entry.rect = rect;
+    entry.item = item;
+    leaf->entries.push_back(entry);
+    m_leafOf.insert(item, leaf);
+
+    if (static_cast<int>(leaf->entries.size()) > MAX_ENTRIES) {
+        splitNode(leaf);
+    } else {
+        adjustBounds(leaf);
+    }
+}
+
+void SpatialIndex::removeEntry(QGraphicsItem* item)
+{
+    Node* leaf = m_leafOf.take(item);
+    if (!leaf) {
+        return;
+    }
+
+    auto it = std::find_if(leaf->entries.begin(), leaf->entries.end(),
+                           [item](const Entry& e) { return e.item == item; });
+    if (it != leaf->entries.end()) {
+        leaf->entries.erase(it);
+    }
+
+    // 向上删除空节点
+    Node* node = leaf;
+    while (node != m_root && node->entries.empty()) {
+        Node* parent = node->parent;
+        auto pit = std::find_if(parent->entries.begin(), parent->entries.end(),
+                                [node](const Entry& e) { return e.child == node; });
+        if (pit != parent->entries.end()) {
+            parent->entries.erase(pit);
+        }
+        delete node;
+        node = parent;
+    }
+    adjustBounds(node);
+
+    // 根节点只有一个子节点时降低树高
+    while (!m_root->leaf && m_root->entries.size() == 1) {
+        Node* child = m_root->entries.front().child;
+        m_root->entries.clear();
+        delete m_root;
+        m_root = child;
+        m_root->parent = nullptr;
+    }
+    if (!m_root->leaf && m_root->entries.empty()) {
+        m_root->leaf = true;
+    }
+}
+
+SpatialIndex::Node* SpatialIndex::chooseLeaf(const QRectF& rect) const
+{
+    Node* node = m_root;
+    while (!node->leaf) {
+        Entry* best = nullptr;
+        qreal bestEnlargement = 0.0;
+        qreal bestArea = 0.0;
+        for (Entry& entry : node->entries) {
+            qreal entryArea = area(entry.rect);
+            qreal enlargement = area(unite(entry.rect, rect)) - entryArea;
+            if (!best || enlargement < bestEnlargement ||
+                (enlargement == bestEnlargement && entryArea < bestArea)) {
+                best = &entry;
+                bestEnlargement = enlargement;
+                bestArea = entryArea;
+            }
+        }
+        node = best->child;
+    }
+    return node;
+}
+
+void SpatialIndex::splitNode(Node* node)
+{
+    // 沿中心点分布较宽的轴排序后对半拆分
+    qreal minX = 0, maxX = 0, minY = 0, maxY = 0;
+    bool first = true;
+    for (const Entry& e : node->entries) {
+        QPointF c = e.rect.center();
+        if (first) {
+            minX = maxX = c.x();
+            minY = maxY = c.y();
+            first = false;
+        } else {
+            minX = qMin(minX, c.x()); maxX = qMax(maxX, c.x());
+            minY = qMin(minY, c.y()); maxY = qMax(maxY, c.y());
+        }
+    }
+    const bool byX = (maxX - minX) >= (maxY - minY);
+    std::sort(node->entries.begin(), node->entries.end(), [byX](const Entry& a, const Entry& b) {
+        return byX ? a.rect.center().x() < b.rect.center().x()
+                   : a.rect.center().y() < b.rect.center().y();
+    });
+
+    Node* sibling = new Node();
+    sibling->leaf = node->leaf;
+    const size_t half = node->entries.size() / 2;
+    sibling->entries.assign(node->entries.begin() + half, node->entries.end());
+    node->entries.erase(node->entries.begin() + half, node->entries.end());
+    for (const Entry& e : sibling->entries) {
+        setParentOf(e, sibling);
+    }
+
+    if (node == m_root) {
+        Node* newRoot = new Node();
+        newRoot->leaf = false;
+        Entry left;
+        left.rect = boundsOf(node);
+        left.child = node;
+        Entry right;
+        right.rect = boundsOf(sibling);
+        right.child = sibling;
+        newRoot->entries.push_back(left);
+        newRoot->entries.push_back(right);
+        node->parent = newRoot;
+        sibling->parent = newRoot;
+        m_root = newRoot;
+        return;
+    }
+
+    Node* parent = node->parent;
+    if (Entry* own = parentEntryOf(node)) {
+        own->rect = boundsOf(node);
+    }
+    Entry right;
+    right.rect = boundsOf(sibling);
+    right.child = sibling;
+    sibling->parent = parent;
+    parent->entries.push_back(right);
+
+    if (static_cast<int>(parent->entries.size()) > MAX_ENTRIES) {
+        splitNode(parent);
+    } else {
+        adjustBounds(parent);
+    }
+}
+
+void SpatialIndex::adjustBounds(Node* node)
+{
+    while (node && node != m_root) {
+        Entry* own = parentEntryOf(node);
+        if (!own) {
+            break;
+        }
+        QRectF bounds = boundsOf(node);
+        if (own->rect == bounds) {
+            break;
+        }
+        own->rect = bounds;
+        node = node->parent;
+    }
+}
+
+void SpatialIndex::setParentOf(const Entry& entry, Node* parent)
+{
+    if (entry.child) {
+        entry.child->parent = parent;
+    } else if (entry.item) {
+        m_leafOf.insert(entry.item, parent);
+    }
+}
+
+SpatialIndex::Entry* SpatialIndex::parentEntryOf(Node* node) const
+{
+    if (!node || !node->parent) {
+        return nullptr;
+    }
+    for (Entry& e : node->parent->entries) {
+        if (e.child == node) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+void SpatialIndex::freeNode(Node* node)
+{
+    if (!node) {
+        return;
+    }
+    if (!node->leaf) {
+        for (Entry& e : node->entries) {
+            freeNode(e.child);
+        }
+    }
+    delete node;
+}
+
+SpatialIndex::Node* SpatialIndex::bulkLoad(std::vector<Entry> entries, bool leafLevel)
+{
+    // Sort-Tile-Recursive：先按x分片，片内按y排序后每MAX_ENTRIES个打包成一个节点
+    const size_t count = entries.size();
+    const size_t nodeCount = (count + MAX_ENTRIES - 1) / MAX_ENTRIES;
+    const size_t sliceCount = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodeCount))));
+    const size_t sliceSize = sliceCount * MAX_ENTRIES;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.rect.center().x() < b.rect.center().x();
+    });
+
+    std::vector<Entry> parents;
+    parents.reserve(nodeCount);
+    for (size_t s = 0; s < count; s += sliceSize) {
+        auto sliceBegin = entries.begin() + s;
+        auto sliceEnd = entries.begin() + std::min(count, s + sliceSize);
+        std::sort(sliceBegin, sliceEnd, [](const Entry& a, const Entry& b) {
+            return a.rect.center().y() < b.rect.center().y();
+        });
+
+        for (auto it = sliceBegin; it < sliceEnd; it += std::min<std::ptrdiff_t>(MAX_ENTRIES, sliceEnd - it)) {
+            Node* node = new Node();
+            node->leaf = leafLevel;
+            node->entries.assign(it, it + std::min<std::ptrdiff_t>(MAX_ENTRIES, sliceEnd - it));
+            for (const Entry& e : node->entries) {
+                setParentOf(e, node);
+            }
+
+            Entry parentEntry;
+            parentEntry.rect = boundsOf(node);
+            parentEntry.child = node;
+            parents.push_back(parentEntry);
+        }
+    }
+
+    if (parents.size() == 1) {
+        return parents.front().child;
+    }
+    return bulkLoad(std::move(parents), false);
+}
+
+QRectF SpatialIndex::boundsOf(const Node* node)
+{
+    QRectF bounds;
+    bool first = true;
+    for (const Entry& e : node->entries) {
+        if (first) {
+            bounds = e.rect;
+            first = false;
+        } else {
+            bounds = unite(bounds, e.rect);
+        }
+    }
+    return bounds;
+}
+
+qreal SpatialIndex::area(const QRectF& rect)
+{
+    return rect.width() * rect.height();
+}
+
+// QRectF::united/intersects会忽略零宽或零高的矩形（如水平线段），这里按闭区间处理
+QRectF SpatialIndex::unite(const QRectF& a, const QRectF& b)
+{
+    qreal left = qMin(a.left(), b.left());
+    qreal top = qMin(a.top(), b.top());
+    qreal right = qMax(a.right(), b.right());
+    qreal bottom = qMax(a.bottom(), b.bottom());
+    return QRectF(QPointF(left, top), QPointF(right, bottom));
+}
+
+bool SpatialIndex::overlaps(const QRectF& a, const QRectF& b)
+{
+    return a.left() <= b.right() && b.left() <= a.right() &&
+           a.top() <= b.bottom() && b.top() <= a.bottom();
+}
@@ -0,0 +1,113 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <QRectF>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief 场景空间索引 - 基于R树的图形项边界索引
+ *
+ * 以图形项的sceneBoundingRect()为键，支持批量构建（STR装载）和增量更新。
+ * GraphicItem在itemChange中自动登记位置/场景变化，索引在查询前惰性刷新，
+ * 用于替代对m_scene->items()的全量遍历（视口查询、区域选择等）。
+ */
+class SpatialIndex {
+public:
+    explicit SpatialIndex(QGraphicsScene* scene);
+    ~SpatialIndex();
+
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+    // 获取场景对应的索引（没有则返回nullptr）
+    static SpatialIndex* forScene(const QGraphicsScene* scene);
+
+    // 获取关联场景
+    QGraphicsScene* scene() const { return m_scene; }
+
+    // 批量重建：对场景中所有GraphicItem执行STR批量装载
+    void rebuild();
+
+    // 清空索引
+    void clear();
+
+    // 标记图形项需要重新计算边界（下次查询前刷新）
+    void markDirty(QGraphicsItem* item);
+
+    // 立即从索引中移除图形项
+    void remove(QGraphicsItem* item);
+
+    // 图形项的边界可能改变时（被标记为脏时）调用的监听器，返回用于移除的编号
+    using GeometryListener = std::function<void(QGraphicsItem*)>;
+    int addGeometryListener(const GeometryListener& listener);
+    void removeGeometryListener(int id);
+
+    // 查询与矩形相交的图形项（按边界矩形判断）
+    QList<QGraphicsItem*> items(const QRectF& rect) const;
+
+    // 遍历与矩形相交的图形项，回调参数为图形项及其索引中的边界
+    void visit(const QRectF& rect, const std::function<void(QGraphicsItem*, const QRectF&)>& visitor) const;
+
+    // 判断图形项是否已被索引
+    bool contains(QGraphicsItem* item) const;
+
+    // 已索引的图形项数量
+    int count() const;
+
+private:
+    struct Node;
+
+    // 节点条目：叶节点中item有效，内部节点中child有效
+    struct Entry {
+        QRectF rect;
+        QGraphicsItem* item = nullptr;
+        Node* child = nullptr;
+    };
+
+    struct Node {
+        bool leaf = true;
+        Node* parent = nullptr;
+        std::vector<Entry> entries;
+    };
+
+    // 节点容量
+    static constexpr int MAX_ENTRIES = 16;
+
+    QGraphicsScene* m_scene;
+    Node* m_root = nullptr;
+    QHash<QGraphicsItem*, Node*> m_leafOf;          // 图形项 -> 所在叶节点
+    mutable QSet<QGraphicsItem*> m_dirtyItems;      // 待刷新的图形项
+    std::vector<std::pair<int, GeometryListener>> m_geometryListeners;
+    int m_nextListenerId = 1;
+
+    // 惰性刷新待更新的图形项
+    void flush() const;
+    void flushDirty();
+
+    // R树内部操作
+    void insertEntry(QGraphicsItem* item, const QRectF& rect);
+    void removeEntry(QGraphicsItem* item);
+    Node* chooseLeaf(const QRectF& rect) const;
+    void splitNode(Node* node);
+    void adjustBounds(Node* node);
+    void setParentOf(const Entry& entry, Node* parent);
+    Entry* parentEntryOf(Node* node) const;
+    void freeNode(Node* node);
+    Node* bulkLoad(std::vector<Entry> entries, bool leafLevel);
+
+    static QRectF boundsOf(const Node* node);
+    static qreal area(const QRectF& rect);
+    static QRectF unite(const QRectF& a, const QRectF& b);
+    static bool overlaps(const QRectF& a, const QRectF& b);
+
+    // 场景 -> 索引注册表
+    static QHash<const QGraphicsScene*, SpatialIndex*>& registry();
+};
+
+#endif // SPATIAL_INDEX_H
@@ -4,11 +4,18 @@
 #include "../command/clip_command.h"
 #include "../command/command_manager.h"
 #include "../core/graphic_item.h"
+#include "../utils/clip_algorithms.h"
 #include <QGraphicsPathItem>
 #include <QApplication>
 #include <QMessageBox>
 #include <QPen>
 #include <QBrush>
+#include <QThreadPool>
+#include <QtMath>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <atomic>
 
 ClipState::ClipState()
 {
@@ -106,6 +113,12 @@ void ClipState::handleLeftMousePress(DrawArea* drawArea, QPointF scenePos)
         QPainterPath path;
         path.moveTo(m_startPoint);
         
+        // 按当前缩放把屏幕空间容差换算到场景坐标，边拖动边简化
+        const qreal viewScale = qSqrt(qAbs(drawArea->transform().determinant()));
+        m_simplifier.setTolerance(FREEHAND_TOLERANCE_PX / (viewScale > 0 ? viewScale : 1.0));
+        m_simplifier.reset();
+        m_simplifier.addPoint(m_startPoint);
+        
         m_freehandPoints.clear();
         m_freehandPoints.push_back(m_startPoint);
         
@@ -164,24 +177,21 @@ void ClipState::updateClipPreview(DrawArea* drawArea)
     else if (m_clipAreaMode == FreehandClip && m_clipPathItem) {
         // 更新自由形状裁剪区域
         
-        // 控制点采样频率，避免添加过多点，但也不能太少
-        // 减小采样间隔，提高精度
-        if (m_freehandPoints.empty() || 
-            (m_currentPoint - m_freehandPoints.back()).manhattanLength() > 5) {  // 从10减少到5
-            m_freehandPoints.push_back(m_currentPoint);
+        // 输入点交给流式简化器，预览只使用简化后的顶点
+        if (m_currentPoint != m_freehandPoints.back()) {
+            m_simplifier.addPoint(m_currentPoint);
+            m_freehandPoints = m_simplifier.points();
             
             // 创建路径
             QPainterPath path;
-            if (!m_freehandPoints.empty()) {
-                path.moveTo(m_freehandPoints[0]);
-                for (size_t i = 1; i < m_freehandPoints.size(); ++i) {
-                    path.lineTo(m_freehandPoints[i]);
-                }
-                // 封闭路径
-                if (m_freehandPoints.size() > 2) {
-                    // 添加一条从当前点到起点的虚线，表示路径会被闭合
-                    path.lineTo(m_freehandPoints[0]);
-                }
+            path.moveTo(m_freehandPoints[0]);
+            for (size_t i = 1; i < m_freehandPoints.size(); ++i) {
+                path.lineTo(m_freehandPoints[i]);
+            }
+            // 封闭路径
+            if (m_freehandPoints.size() > 2) {
+                // 添加一条从当前点到起点的虚线，表示路径会被闭合
+                path.lineTo(m_freehandPoints[0]);
             }
             
             // 更新路径
@@ -222,27 +232,9 @@ void ClipState::finishClip(DrawArea* drawArea)
             return;
         }
         
-        // 自由形状裁剪可能会比较复杂，进行简化处理
-        // 如果点数过多，进行适当简化，保留关键点
-        if (m_freehandPoints.size() > 100) {
-            std::vector<QPointF> simplifiedPoints;
-            simplifiedPoints.reserve(100);
-            
-            // 简单的降采样，保留关键拐点
-            double skipFactor = static_cast<double>(m_freehandPoints.size()) / 100.0;
-            for (size_t i = 0; i < m_freehandPoints.size(); i += std::max(1.0, skipFactor)) {
-                size_t idx = std::min(i, m_freehandPoints.size() - 1);
-                simplifiedPoints.push_back(m_freehandPoints[idx]);
-            }
-            
-            // 确保包含起点和终点
-            if (!simplifiedPoints.empty() && simplifiedPoints.back() != m_freehandPoints.back()) {
-                simplifiedPoints.push_back(m_freehandPoints.back());
-            }
-            
-            m_freehandPoints = simplifiedPoints;
-            logInfo(QString("ClipState::finishClip: 路径点数过多，已简化为 %1 个点").arg(m_freehandPoints.size()));
-        }
+        // 顶点在拖动过程中已由流式简化器精简，这里直接使用
+        logInfo(QString("ClipState::finishClip: 自由形状路径输入 %1 个点，简化后 %2 个顶点")
+                .arg(m_simplifier.inputCount()).arg(m_freehandPoints.size()));
         
         // 创建平滑的自由形状路径
         clipPath = QPainterPath();
@@ -281,45 +273,139 @@ void ClipState::finishClip(DrawArea* drawArea)
              .arg(clipRect.left()).arg(clipRect.top())
              .arg(clipRect.width()).arg(clipRect.height()));
     
-    // 处理每个选中的图形项
+    // 批量裁剪所有选中的图形项，作为一个撤销步骤
+    bool anythingClipped = clipItemsBatch(drawArea, clipPath);
+    
+    // 清除临时图形项
+    clearTemporaryItems(drawArea);
+    
+    // 重置裁剪状态
+    m_isClipping = false;
+    
+    // 更新状态消息
+    updateStatusMessage(drawArea, anythingClipped ? "裁剪完成" : "裁剪失败，没有图形项被裁剪");
+    
+    // 返回到编辑状态
+    drawArea->setEditState();
+}
+
+bool ClipState::clipItemsBatch(DrawArea* drawArea, const QPainterPath& clipPath)
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    const QRectF clipBounds = clipPath.boundingRect();
+    
+    // 1. 在GUI线程筛选候选项：包围盒不相交的直接剔除，完全在裁剪区域内的保持不变
+    struct ClipTask {
+        GraphicItem* item = nullptr;
+        QPainterPath subject;   // 场景坐标下的裁剪主体
+        QPainterPath result;    // 工作线程写入的裁剪结果
+    };
+    std::vector<ClipTask> tasks;
+    std::vector<GraphicItem*> fallbackItems;  // 不支持批量裁剪，只能逐个调用clip()
+    int rejectedCount = 0;
+    int insideCount = 0;
+    
+    for (QGraphicsItem* item : m_selectedItems) {
+        GraphicItem* graphicItem = dynamic_cast<GraphicItem*>(item);
+        if (!graphicItem) {
+            continue;
+        }
+        
+        const QRectF itemBounds = item->sceneBoundingRect();
+        if (!itemBounds.intersects(clipBounds)) {
+            ++rejectedCount;
+            continue;
+        }
+        if (clipPath.contains(itemBounds)) {
+            ++insideCount;
+            continue;
+        }
+        
+        QPainterPath subject = graphicItem->clipSubjectPath();
+        if (subject.isEmpty()) {
+            fallbackItems.push_back(graphicItem);
+            continue;
+        }
+        
+        ClipTask task;
+        task.item = graphicItem;
+        task.subject = subject;
+        tasks.push_back(task);
+    }
+    
+    logInfo(QString("ClipState::clipItemsBatch: 选中 %1 项，剔除 %2 项，完全包含 %3 项，并行裁剪 %4 项，逐个裁剪 %5 项")
+            .arg(m_selectedItems.size()).arg(rejectedCount).arg(insideCount)
+            .arg(tasks.size()).arg(fallbackItems.size()));
+    
+    // 2. 在线程池中并行计算裁剪结果，工作线程只访问各自的路径副本，不接触场景
+    if (!tasks.empty()) {
+        QThreadPool pool;
+        const int workerCount = qMax(1, qMin(QThreadPool::globalInstance()->maxThreadCount(),
+                                             static_cast<int>(tasks.size())));
+        pool.setMaxThreadCount(workerCount);
+        
+        // QPainterPath是隐式共享的且包围盒惰性缓存，跨线程共享同一数据会产生数据竞争，
+        // 因此在GUI线程为每个工作线程和每个任务构造独立的深拷贝
+        std::vector<QPainterPath> workerClips(workerCount);
+        for (QPainterPath& localClip : workerClips) {
+            localClip.addPath(clipPath);
+            localClip.setFillRule(clipPath.fillRule());
+        }
+        for (ClipTask& task : tasks) {
+            QPainterPath subject;
+            subject.addPath(task.subject);
+            subject.setFillRule(task.subject.fillRule());
+            task.subject = subject;
+        }
+        
+        std::atomic<size_t> nextTask{0};
+        for (int i = 0; i < workerCount; ++i) {
+            const QPainterPath* localClip = &workerClips[i];
+            pool.start([&tasks, &nextTask, localClip]() {
+                for (size_t index = nextTask.fetch_add(1); index < tasks.size(); index = nextTask.fetch_add(1)) {
+                    tasks[index].result = ClipAlgorithms::clipPath(tasks[index].subject, *localClip);
+                }
+            });
+        }
+        
+        // 等待期间继续处理绘制事件，避免界面冻结
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        while (!pool.waitForDone(50)) {
+            QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+        }
+        QApplication::restoreOverrideCursor();
+    }
+    
+    // 3. 回到GUI线程，将结果作为一个命令组应用
     CommandManager& cmdManager = CommandManager::getInstance();
+    QGraphicsScene* scene = drawArea->scene();
     bool anythingClipped = false;
     
-    // 开始命令分组
     cmdManager.beginCommandGroup();
     
-    for (QGraphicsItem* item : m_selectedItems) {
-        // 尝试将项目转换为GraphicItem
-        if (GraphicItem* graphicItem = dynamic_cast<GraphicItem*>(item)) {
-            // 创建裁剪命令
-            ClipCommand* cmd = new ClipCommand(drawArea->scene(), graphicItem, clipPath);
-            
-            // 添加到命令组
-            cmdManager.addCommandToGroup(cmd);
-            anythingClipped = true;
+    for (const ClipTask& task : tasks) {
+        if (task.result.isEmpty()) {
+            continue;
         }
+        cmdManager.addCommandToGroup(new ClipCommand(scene, task.item, clipPath, task.result));
+        anythingClipped = true;
+    }
+    
+    for (GraphicItem* graphicItem : fallbackItems) {
+        cmdManager.addCommandToGroup(new ClipCommand(scene, graphicItem, clipPath));
+        anythingClipped = true;
     }
     
-    // 提交命令组
     if (anythingClipped) {
         cmdManager.commitCommandGroup();
-        logInfo("ClipState::finishClip: 裁剪操作完成");
-    } else {
-        cmdManager.clear(); // 清除命令组
-        logWarning("ClipState::finishClip: 没有图形项被裁剪");
     }
+    cmdManager.endCommandGroup();
     
-    // 清除临时图形项
-    clearTemporaryItems(drawArea);
+    logInfo(QString("ClipState::clipItemsBatch: 批量裁剪完成，耗时 %1 ms").arg(timer.elapsed()));
     
-    // 重置裁剪状态
-    m_isClipping = false;
-    
-    // 更新状态消息
-    updateStatusMessage(drawArea, anythingClipped ? "裁剪完成" : "裁剪失败，没有图形项被裁剪");
-    
-    // 返回到编辑状态
-    drawArea->setEditState();
+    return anythingClipped;
 }
 
 void ClipState::cancelClip(DrawArea* drawArea)
@@ -332,6 +418,7 @@ void ClipState::cancelClip(DrawArea* drawArea)
     // 重置裁剪状态
     m_isClipping = false;
     m_freehandPoints.clear();
+    m_simplifier.reset();
     
     // 更新状态消息
     updateStatusMessage(drawArea, "裁剪操作已取消");
@@ -3,6 +3,7 @@
 
 #include "editor_state.h"
 #include "../core/graphic_item.h"
+#include "../utils/clip_algorithms.h"
 #include <QPointF>
 #include <QColor>
 #include <vector>
@@ -47,6 +48,9 @@ private:
     // 完成裁剪操作
     void finishClip(DrawArea* drawArea);
     
+    // 批量裁剪选中的图形项：剔除不相交项，并行计算裁剪结果，以一个命令组提交
+    bool clipItemsBatch(DrawArea* drawArea, const QPainterPath& clipPath);
+    
     // 取消裁剪操作
     void cancelClip(DrawArea* drawArea);
     
@@ -61,9 +65,15 @@ private:
     QPointF m_startPoint;
     QPointF m_currentPoint;
     
-    // 自由形状裁剪的点集合
+    // 自由形状裁剪的点集合（简化后的顶点）
     std::vector<QPointF> m_freehandPoints;
     
+    // 自由形状路径的流式简化器
+    ClipAlgorithms::StreamingSimplifier m_simplifier;
+    
+    // 自由形状路径简化的屏幕空间容差（像素）
+    static constexpr qreal FREEHAND_TOLERANCE_PX = 1.5;
+    
     // 裁剪区域模式
     ClipAreaMode m_clipAreaMode = RectangleClip;
     
@@ -9,6 +9,7 @@
 #include <QMainWindow>
 #include <QStatusBar>
 #include <cmath>
+#include <QtMath>
 #include <QStack>
 #include <QImage>
 #include "../core/draw_strategy.h"
@@ -539,36 +540,10 @@ void DrawState::updatePreviewItem(DrawArea* drawArea)
             if (m_bezierControlPoints.size() >= 2) {
                 QPainterPath path;
 
-                // 使用策略类统一算法
-                BezierDrawStrategy strategy;  // 创建策略对象复用逻辑
-                strategy.setColor(m_lineColor);  // 颜色/线宽参数可忽略，预览时仅需计算路径
-                strategy.setLineWidth(m_lineWidth);
-
-                // 直接调用策略类的绘制逻辑生成路径
-                if (m_bezierControlPoints.size() == 2) {
-                    // 两点直线
-                    path.moveTo(m_bezierControlPoints[0]);
-                    path.lineTo(m_bezierControlPoints[1]);
-                } else {
-                    // 高阶贝塞尔：复用优化算法
-                    path.moveTo(m_bezierControlPoints[0]);
-                    
-                    // 1. 动态计算步长（直接复用策略类中的逻辑）
-                    double totalPolylineLength = 0.0;
-                    for (size_t i = 1; i < m_bezierControlPoints.size(); ++i) {
-                        totalPolylineLength += QLineF(m_bezierControlPoints[i-1], m_bezierControlPoints[i]).length();
-                    }
-                    const double densityFactor = 5.0;
-                    const int minSteps = 20, maxSteps = 500;
-                    int numSteps = std::clamp(static_cast<int>(totalPolylineLength * densityFactor), minSteps, maxSteps);
-
-                    // 2. 使用策略类计算曲线点
-                    for (int step = 1; step <= numSteps; ++step) {
-                        double t = static_cast<double>(step) / numSteps;
-                        QPointF p = strategy.calculateBezierPoint(m_bezierControlPoints, t); 
-                        path.lineTo(p);
-                    }
-                }
+                // 使用策略类统一的分段三次曲线转换，按当前缩放确定容差
+                const qreal viewScale = qSqrt(qAbs(drawArea->transform().determinant()));
+                const qreal tolerance = BezierDrawStrategy::DEFAULT_FLATNESS / (viewScale > 0 ? viewScale : 1.0);
+                path = BezierDrawStrategy::toCubicPath(m_bezierControlPoints, tolerance);
 
                 // 更新预览图形项
                 if (!m_previewItem) {
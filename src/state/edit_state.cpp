@@ -263,13 +263,15 @@ void EditState::handleLeftMousePress(DrawArea* drawArea, QPointF scenePos)
             m_dragStartPosition = QPoint(static_cast<int>(scenePos.x()), static_cast<int>(scenePos.y()));
             QApplication::setOverrideCursor(Qt::SizeAllCursor);
         } else {
-            // 点击空白区域，开始区域选择
+            // 点击空白区域，开始区域选择；按住Alt时使用套索
             selectionManager->clearSelection();
             m_isDragging = false;
             m_isScaling = false;
             m_isRotating = false;
             m_isAreaSelecting = true;
-            selectionManager->startSelection(scenePos);
+            const bool lasso = QApplication::keyboardModifiers() & Qt::AltModifier;
+            selectionManager->startSelection(scenePos, lasso ? SelectionManager::LassoSelection
+                                                             : SelectionManager::SingleSelection);
             QApplication::setOverrideCursor(Qt::CrossCursor);
         }
     }
@@ -310,16 +312,13 @@ void EditState::mouseMoveEvent(DrawArea* drawArea, QMouseEvent* event)
     
     // 根据当前状态处理鼠标移动
     if (m_isAreaSelecting) {
-        // 更新选择区域
+        // 更新选择区域，选择矩形和进出选择的项会各自请求重绘
         selectionManager->updateSelection(scenePos);
-        
-        // 确保更新视图
-        drawArea->viewport()->update();
     } else if (m_isScaling) {
         // 处理缩放
         if (m_activeHandle != GraphicItem::None) {
             // 如果是单个图形项的缩放
-            if (selectionManager->getSelectedItems().size() == 1) {
+            if (selectionManager->selectedCount() == 1) {
                 QGraphicsItem* item = selectionManager->getSelectedItems().first();
                 GraphicItem* graphicItem = dynamic_cast<GraphicItem*>(item);
                 if (graphicItem) {
@@ -335,7 +334,7 @@ void EditState::mouseMoveEvent(DrawArea* drawArea, QMouseEvent* event)
         drawArea->viewport()->update();
     } else if (m_isRotating) {
         // 处理旋转
-        if (selectionManager->getSelectedItems().size() == 1) {
+        if (selectionManager->selectedCount() == 1) {
             QGraphicsItem* item = selectionManager->getSelectedItems().first();
             GraphicItem* graphicItem = dynamic_cast<GraphicItem*>(item);
             if (graphicItem) {
@@ -345,19 +344,15 @@ void EditState::mouseMoveEvent(DrawArea* drawArea, QMouseEvent* event)
         // 确保更新视图
         drawArea->viewport()->update();
     } else if (m_isDragging) {
-        // 移动选中的图形
+        // 拖动过程中只移动选择的代理项，松开鼠标时再提交各图形项的实际位置
         QPoint newPos(static_cast<int>(scenePos.x()), static_cast<int>(scenePos.y()));
-        QPoint delta = newPos - m_dragStartPosition;
+        QPointF delta(newPos - m_dragStartPosition);
         
-        // 只有当移动距离超过阈值时才真正移动对象
-        if (QPointF(delta).manhattanLength() > 3.0) {
-            QPointF deltaF(delta.x(), delta.y());
-            drawArea->moveSelectedGraphics(deltaF);
-            m_dragStartPosition = newPos;
+        // 只有当移动距离超过阈值时才开始拖动
+        if (!selectionManager->isLiveMoving() && delta.manhattanLength() > 3.0) {
+            selectionManager->beginLiveMove();
         }
-        
-        // 确保更新视图
-        drawArea->viewport()->update();
+        selectionManager->updateLiveMove(delta);
     } else {
         // 未按下鼠标时，更新光标样式
         bool cursorSet = false;
@@ -436,21 +431,24 @@ void EditState::mouseReleaseEvent(DrawArea* drawArea, QMouseEvent* event)
         selectionManager->finishSelection();
         m_isAreaSelecting = false;
     } else if (m_isDragging) {
-        // 结束拖动
+        // 结束拖动，恢复图形项的显示
         m_isDragging = false;
-        selectionManager->setDraggingSelection(false);
+        const bool moved = selectionManager->isLiveMoving();
+        selectionManager->finishLiveMove();
         
         // 创建移动命令，只有当移动距离足够大时才执行移动
         QPointF scenePos = drawArea->mapToScene(event->pos());
-        QPointF delta = scenePos - QPointF(m_dragStartPosition);
+        QPoint releasePos(static_cast<int>(scenePos.x()), static_cast<int>(scenePos.y()));
+        QPointF delta(releasePos - m_dragStartPosition);
         
-        // 只有当移动距离足够大时才创建移动命令
-        if (delta.manhattanLength() > 3.0) {  // 设置一个小的阈值，避免意外的微小移动
+        // 各图形项的位置、空间索引和连接线在命令执行时一次性更新，整个拖动对应一条撤销记录
+        if (moved && delta.manhattanLength() > 3.0) {  // 设置一个小的阈值，避免意外的微小移动
             SelectionCommand* moveCommand = createMoveCommand(drawArea, delta);
             if (moveCommand) {
                 CommandManager::getInstance().executeCommand(moveCommand);
             }
         }
+        selectionManager->setDraggingSelection(false);
         
         // 确保所有选中的图形项仍然可移动
         for (QGraphicsItem* item : selectionManager->getSelectedItems()) {
@@ -15,6 +15,9 @@
 #include <QMainWindow>
 #include <QStatusBar>
 #include <QStack>
+#include <QProgressDialog>
+#include <QThreadPool>
+#include <QMetaObject>
 
 FillState::FillState(const QColor& fillColor)
     : m_fillColor(fillColor)
@@ -22,14 +25,24 @@ FillState::FillState(const QColor& fillColor)
     Logger::debug(QString("FillState: 创建填充状态，颜色: %1").arg(fillColor.name(QColor::HexArgb)));
 }
 
+FillState::~FillState()
+{
+    // 状态销毁后仍在进行的填充不能再写入场景，标记取消后由completeRasterFill丢弃结果
+    if (m_activeJob) {
+        m_activeJob->canceled.store(true);
+        if (m_activeJob->progress) {
+            m_activeJob->progress->close();
+            m_activeJob->progress->deleteLater();
+        }
+        m_activeJob.reset();
+    }
+}
+
 void FillState::handleLeftMousePress(DrawArea* drawArea, QPointF scenePos)
 {
     m_isPressed = true;
     m_currentPoint = scenePos;
     
-    // 设置等待光标，表示填充操作正在进行
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    
     Logger::debug(QString("FillState: 开始填充 - 位置: (%1, %2)").arg(scenePos.x()).arg(scenePos.y()));
 }
 
@@ -91,7 +104,12 @@ void FillState::paintEvent(DrawArea* drawArea, QPainter* painter) {
 
 void FillState::keyPressEvent(DrawArea* drawArea, QKeyEvent* event) {
     if (event->key() == Qt::Key_Escape) {
-        exitCurrentState(drawArea);
+        // 有填充正在进行时Esc只取消填充，否则退出填充工具
+        if (isFillRunning()) {
+            cancelFill(drawArea);
+        } else {
+            exitCurrentState(drawArea);
+        }
     }
 }
 
@@ -128,6 +146,11 @@ void FillState::onExitState(DrawArea* drawArea)
 {
     logInfo("FillState: 退出填充状态");
     
+    // 切换工具时放弃正在进行的填充
+    if (isFillRunning()) {
+        cancelFill(drawArea);
+    }
+    
     // 重置鼠标光标
     resetCursor(drawArea);
 }
@@ -153,17 +176,139 @@ void FillState::finishOperation(DrawArea* drawArea)
     // 获取填充点和颜色
     QPointF fillPosition = m_currentPoint;
     QColor fillColor = m_fillColor;
+    
+    // 新的填充请求取代正在进行的填充
+    if (isFillRunning()) {
+        Logger::debug("FillState: 新的填充请求，取消正在进行的填充");
+        cancelFill(drawArea);
+    }
+    
+    // 矢量区域的计算很快，直接在GUI线程完成
+    QPainterPath region = FillCommand::computeVectorRegion(drawArea, fillPosition);
+    if (!region.isEmpty()) {
+        FillCommand* command = new FillCommand(drawArea, fillPosition, fillColor, FillCommand::VectorFill);
+        command->setVectorRegion(region);
+        CommandManager::getInstance().executeCommand(command);
+        
+        Logger::info(QString("FillState: 执行矢量填充命令 - 位置: (%1, %2), 颜色: %3")
+                     .arg(fillPosition.x()).arg(fillPosition.y())
+                     .arg(fillColor.name()));
+        return;
+    }
+    
+    // 位图填充需要渲染整个场景，放到工作线程中进行
+    startRasterFill(drawArea, fillPosition, fillColor);
+}
+
+bool FillState::isFillRunning() const
+{
+    return m_activeJob && !m_activeJob->finished && !m_activeJob->canceled.load();
+}
 
-    // 创建填充命令
-    FillCommand* command = new FillCommand(drawArea, fillPosition, fillColor);
+void FillState::cancelFill(DrawArea* drawArea)
+{
+    if (!m_activeJob) {
+        return;
+    }
     
-    // 执行命令
-    CommandManager::getInstance().executeCommand(command);
+    m_activeJob->canceled.store(true);
+    if (m_activeJob->progress) {
+        m_activeJob->progress->close();
+        m_activeJob->progress->deleteLater();
+    }
+    m_activeJob.reset();
     
-    Logger::info(QString("FillState: 执行填充命令 - 位置: (%1, %2), 颜色: %3")
-                 .arg(fillPosition.x()).arg(fillPosition.y())
-                 .arg(fillColor.name()));
+    updateStatusMessage(drawArea, "填充工具: 填充已取消");
+    Logger::info("FillState: 取消填充");
+}
+
+void FillState::startRasterFill(DrawArea* drawArea, const QPointF& position, const QColor& color)
+{
+    QGraphicsScene* scene = drawArea->scene();
+    if (!scene) {
+        return;
+    }
+    
+    QRectF sceneRect = scene->sceneRect();
+    if (sceneRect.isEmpty()) {
+        sceneRect = QRectF(0, 0, 1, 1);
+    }
+    
+    // QGraphicsScene和场景中的QPixmap只能在GUI线程使用：先在GUI线程栅格化成QImage，
+    // 工作线程只做洪水填充和掩码编码
+    QImage image = GraphicsUtils::renderSceneToImage(scene, true);
+    
+    auto job = std::make_shared<FillJob>();
+    m_activeJob = job;
+    
+    // 进度提示：填充时间较短时不显示对话框，取消按钮与Esc效果相同
+    QProgressDialog* progress = new QProgressDialog("正在填充区域...", "取消", 0, 0, drawArea);
+    progress->setWindowModality(Qt::NonModal);
+    progress->setMinimumDuration(300);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    progress->setValue(0);
+    QObject::connect(progress, &QProgressDialog::canceled, progress, [job, progress]() {
+        if (job->finished) {
+            return;
+        }
+        job->canceled.store(true);
+        progress->deleteLater();
+        Logger::info("FillState: 取消填充");
+    });
+    job->progress = progress;
+    
+    QApplication::setOverrideCursor(Qt::BusyCursor);
+    updateStatusMessage(drawArea, "填充工具: 正在填充，按Esc取消");
+    
+    QPointer<DrawArea> area(drawArea);
+    QThreadPool::globalInstance()->start([job, area, image = std::move(image), sceneRect, position, color]() {
+        FillCommand::RasterResult result;
+        if (!job->canceled.load()) {
+            result = FillCommand::computeRasterFill(image, sceneRect, position, color, &job->canceled);
+        }
+        
+        // 回到GUI线程创建填充项和撤销记录
+        QMetaObject::invokeMethod(qApp, [job, area, position, color, result]() {
+            completeRasterFill(job, area, position, color, result);
+        }, Qt::QueuedConnection);
+    });
     
-    // 恢复光标
+    Logger::info(QString("FillState: 开始异步填充 - 位置: (%1, %2), 颜色: %3")
+                 .arg(position.x()).arg(position.y())
+                 .arg(color.name()));
+}
+
+void FillState::completeRasterFill(const std::shared_ptr<FillJob>& job, QPointer<DrawArea> drawArea,
+                                   const QPointF& position, const QColor& color,
+                                   const FillCommand::RasterResult& result)
+{
+    // 先记录取消状态，关闭进度对话框时会发出canceled信号
+    const bool canceled = job->canceled.load();
+    job->finished = true;
     QApplication::restoreOverrideCursor();
+    if (job->progress) {
+        job->progress->close();
+        job->progress->deleteLater();
+    }
+    
+    // 已被取消或取代的填充直接丢弃
+    if (canceled || !drawArea) {
+        Logger::debug("FillState: 丢弃已取消的填充结果");
+        return;
+    }
+    
+    if (result.filledPixels > 0) {
+        FillCommand* command = new FillCommand(drawArea, position, color, FillCommand::RasterFill);
+        command->setRasterResult(result);
+        CommandManager::getInstance().executeCommand(command);
+    }
+    
+    if (QMainWindow* mainWindow = qobject_cast<QMainWindow*>(drawArea->window())) {
+        mainWindow->statusBar()->showMessage(QString("填充工具: 填充完成，共 %1 个像素").arg(result.filledPixels), 3000);
+    }
+    
+    Logger::info(QString("FillState: 执行填充命令 - 位置: (%1, %2), 颜色: %3, 像素: %4")
+                 .arg(position.x()).arg(position.y())
+                 .arg(color.name()).arg(result.filledPixels));
 }
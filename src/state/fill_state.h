@@ -3,6 +3,7 @@
 
 #include "editor_state.h"
 #include "../utils/logger.h"
+#include "../command/fill_command.h"
 #include <QColor>
 #include <QPoint>
 #include <QPointF>
@@ -13,9 +14,12 @@
 #include <QPixmap>
 #include <QList>
 #include <QMainWindow>
+#include <QPointer>
+#include <atomic>
 
 class DrawArea;
 class QGraphicsPixmapItem;
+class QProgressDialog;
 
 /**
  * @brief 颜色填充工具状态类
@@ -25,7 +29,7 @@ class QGraphicsPixmapItem;
 class FillState : public EditorState {
 public:
     explicit FillState(const QColor& fillColor);
-    ~FillState() override = default;
+    ~FillState() override;
     
     // 处理鼠标和键盘事件
     void mousePressEvent(DrawArea* drawArea, QMouseEvent* event) override;
@@ -47,9 +51,15 @@ public:
     // 填充操作
     void fillRegion(DrawArea* drawArea, const QPointF& startPoint);
     
-    // 完成填充操作，创建并执行命令
+    // 完成填充操作，创建并执行命令（位图填充在工作线程中异步进行）
     void finishOperation(DrawArea* drawArea);
     
+    // 是否有正在进行的异步填充
+    bool isFillRunning() const;
+    
+    // 取消正在进行的异步填充
+    void cancelFill(DrawArea* drawArea);
+    
     // 状态类型和名称
     StateType getStateType() const override { return StateType::FillState; }
     QString getStateName() const override { return "填充工具"; }
@@ -69,11 +79,27 @@ private:
     int fillImageRegion(QImage& image, const QPoint& seedPoint, 
                        const QColor& targetColor, const QColor& fillColor);
     
+    // 异步位图填充任务，由GUI线程和工作线程共享
+    struct FillJob {
+        std::atomic<bool> canceled{false};     // 取消标志，工作线程轮询
+        bool finished = false;                 // 结果已在GUI线程处理（仅GUI线程访问）
+        QPointer<QProgressDialog> progress;    // 进度提示（仅GUI线程访问）
+    };
+    
+    // 在工作线程中执行位图填充，完成后在GUI线程创建命令
+    void startRasterFill(DrawArea* drawArea, const QPointF& position, const QColor& color);
+    
+    // 在GUI线程处理异步填充的结果
+    static void completeRasterFill(const std::shared_ptr<FillJob>& job, QPointer<DrawArea> drawArea,
+                                   const QPointF& position, const QColor& color,
+                                   const FillCommand::RasterResult& result);
+    
     // 属性
     QColor m_fillColor;   // 填充颜色
     QPointF m_lastPoint;  // 上次鼠标位置
     QPointF m_currentPoint;
     bool m_isPressed = false;
+    std::shared_ptr<FillJob> m_activeJob;  // 当前的异步填充任务
 };
 
 #endif // FILL_STATE_H
@@ -22,8 +22,10 @@
 #include "../command/selection_command.h"
 #include "../command/paste_command.h"
 #include "../command/connection_delete_command.h"
+#include "../command/layout_command.h"
 #include "../core/flowchart_connector_item.h"
 #include "../utils/file_format_manager.h"
+#include "../utils/tiff_stream_writer.h"
 
 #include <QPaintEvent>
 #include <QMouseEvent>
@@ -58,6 +60,9 @@
 #include <QGroupBox>
 #include <QGridLayout>
 #include <QSpinBox>
+#include <QThreadPool>
+#include <atomic>
+#include <cstring>
 #include <QCheckBox>
 #include <QDialogButtonBox>
 #include <QFileDialog>
@@ -93,6 +98,7 @@ const QString DrawArea::MIME_GRAPHICITEMS = "application/x-claudegraph-items";
 DrawArea::DrawArea(QWidget *parent)
     : QGraphicsView(parent)
     , m_scene(new QGraphicsScene(this))
+    , m_spatialIndex(std::make_unique<SpatialIndex>(m_scene))
     , m_currentState(nullptr)
     , m_graphicFactory(std::make_unique<DefaultGraphicsItemFactory>())
     , m_selectionManager(std::make_unique<SelectionManager>(m_scene))
@@ -114,6 +120,7 @@ DrawArea::DrawArea(QWidget *parent)
     // 初始化连接点覆盖层
     m_connectionOverlay = new ConnectionPointOverlay(m_connectionManager.get());
     m_scene->addItem(m_connectionOverlay);
+    m_connectionManager->setOverlay(m_connectionOverlay);
     
     // 设置初始编辑状态
     setEditState();
@@ -156,6 +163,7 @@ DrawArea::~DrawArea()
     // 清理连接管理器
     if (m_connectionManager) {
         m_connectionManager->disconnect();
+        m_connectionManager->setOverlay(nullptr);
         m_connectionManager->clearAllConnectionPoints();
     }
     
@@ -353,12 +361,21 @@ void DrawArea::wheelEvent(QWheelEvent *event)
             scaleFactor = 1.0 / scaleFactor;
         }
         scale(scaleFactor, scaleFactor);
+        optimizeVisibleItems();
     } else {
         // 正常滚动
         QGraphicsView::wheelEvent(event);
     }
 }
 
+void DrawArea::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    
+    // 视口移动后刷新可见项目
+    optimizeVisibleItems();
+}
+
 void DrawArea::mousePressEvent(QMouseEvent *event)
 {
     // 检查是否处于平移模式
@@ -578,6 +595,11 @@ void DrawArea::keyReleaseEvent(QKeyEvent *event)
 void DrawArea::clearGraphics()
 {
     SceneUtils::clearScene(m_scene, this, m_connectionManager.get(), m_connectionOverlay, m_selectionManager.get());
+    
+    // 场景已清空，重建空间索引
+    if (m_spatialIndex) {
+        m_spatialIndex->rebuild();
+    }
 }
 
 void DrawArea::setImage(const QImage &image)
@@ -1536,7 +1558,7 @@ void DrawArea::drawForeground(QPainter *painter, const QRectF &rect)
     QGraphicsView::drawForeground(painter, rect);
     
     // 使用SelectionManager绘制选择控制点
-    if (m_selectionManager && !m_selectionManager->getSelectedItems().isEmpty()) {
+    if (m_selectionManager && m_selectionManager->hasSelection()) {
         // 保存当前的转换矩阵
         painter->save();
         
@@ -1718,6 +1740,44 @@ void DrawArea::flipSelectedGraphics(bool horizontal)
     emit selectionChanged();
 }
 
+int DrawArea::autoLayoutFlowchart()
+{
+    if (!m_connectionManager || !m_scene) {
+        return 0;
+    }
+    
+    auto collectFlowchartItems = [](const QList<QGraphicsItem*>& items) {
+        QList<FlowchartBaseItem*> result;
+        for (QGraphicsItem* item : items) {
+            FlowchartBaseItem* flowchartItem = dynamic_cast<FlowchartBaseItem*>(item);
+            if (flowchartItem && !dynamic_cast<FlowchartConnectorItem*>(item)) {
+                result.append(flowchartItem);
+            }
+        }
+        return result;
+    };
+    
+    // 选中了多个流程图元素时只布局选中部分，否则布局整个流程图
+    QList<FlowchartBaseItem*> items;
+    if (m_selectionManager) {
+        items = collectFlowchartItems(m_selectionManager->getSelectedItems());
+    }
+    if (items.size() < 2) {
+        items = collectFlowchartItems(m_scene->items());
+    }
+    
+    LayoutCommand* command = LayoutCommand::createLayeredLayout(m_connectionManager.get(), items);
+    if (!command) {
+        return 0;
+    }
+    CommandManager::getInstance().executeCommand(command);
+    
+    viewport()->update();
+    
+    emit selectionChanged();
+    return items.size();
+}
+
 // 在指定位置粘贴图形项
 void DrawArea::pasteItemsAtPosition(const QPointF& pos) {
     // 检查剪贴板是否为空
@@ -1965,6 +2025,8 @@ void DrawArea::updateGraphicsCaching()
         }
     }
     
+    m_cachedVisibleItems.clear();
+    
     Logger::debug(QString("DrawArea: 已更新 %1 个图形项的缓存状态").arg(count));
 }
 
@@ -1976,16 +2038,11 @@ void DrawArea::enableClippingOptimization(bool enable) {
         // 裁剪优化设置
         setViewportUpdateMode(enable ? QGraphicsView::BoundingRectViewportUpdate : QGraphicsView::FullViewportUpdate);
         
-        // 如果启用了裁剪优化，应用项目可见性优化
+        // 如果启用了裁剪优化，应用项目可见性优化；禁用时恢复全量缓存设置
         if (enable) {
             optimizeVisibleItems();
         } else {
-            // 禁用时，确保所有项目可见
-            if (m_scene) {
-                for (QGraphicsItem* item : m_scene->items()) {
-                    item->setVisible(true);
-                }
-            }
+            updateGraphicsCaching();
         }
         
         emit clippingStatusChanged(enable);
@@ -1996,7 +2053,8 @@ void DrawArea::enableClippingOptimization(bool enable) {
 // 优化可见项目
 void DrawArea::optimizeVisibleItems()
 {
-    if (!m_scene || !m_clippingOptimizationEnabled) return;
+    // 只有启用缓存时才需要按视口调整各项的缓存，滚动时每帧都会调用，没有工作时直接返回
+    if (!m_scene || !m_spatialIndex || !m_clippingOptimizationEnabled || !m_graphicsCachingEnabled) return;
     
     // 获取当前可见区域
     QRectF visibleRect = mapToScene(viewport()->rect()).boundingRect();
@@ -2005,29 +2063,28 @@ void DrawArea::optimizeVisibleItems()
     const qreal margin = 50.0; // 50像素的边距
     visibleRect.adjust(-margin, -margin, margin, margin);
     
-    // 优化项目可见性
-    QList<QGraphicsItem*> allItems = m_scene->items();
-    int hiddenCount = 0;
-    int visibleCount = 0;
+    // 通过空间索引只查询视口内的项目，视口外的项目由QGraphicsView自身跳过绘制，
+    // 不再逐个调用setVisible（那会影响选择、导出等依赖可见性的逻辑）
+    QSet<QGraphicsItem*> visibleItems;
+    for (QGraphicsItem* item : m_spatialIndex->items(visibleRect)) {
+        visibleItems.insert(item);
+    }
     
-    for (QGraphicsItem* item : allItems) {
-        // 计算物体是否在可见区域内
-        bool isVisible = visibleRect.intersects(item->sceneBoundingRect());
-        
-        // 更新可见性
-        if (item->isVisible() != isVisible) {
-            item->setVisible(isVisible);
+    // 只为视口内的项目保留缓存，释放视口外项目的缓存
+    for (QGraphicsItem* item : visibleItems) {
+        if (GraphicItem* graphicItem = dynamic_cast<GraphicItem*>(item)) {
+            graphicItem->enableCaching(true);
         }
-        
-        // 统计
-        if (isVisible) {
-            visibleCount++;
-        } else {
-            hiddenCount++;
+    }
+    for (QGraphicsItem* item : m_cachedVisibleItems) {
+        // 先确认仍在索引中（已删除的项目会被索引移除）
+        if (!visibleItems.contains(item) && m_spatialIndex->contains(item)) {
+            if (GraphicItem* graphicItem = dynamic_cast<GraphicItem*>(item)) {
+                graphicItem->enableCaching(false);
+            }
         }
     }
-    
-    Logger::debug(QString("DrawArea: 可见项目优化 - 可见: %1, 隐藏: %2").arg(visibleCount).arg(hiddenCount));
+    m_cachedVisibleItems = visibleItems;
 }
 
 // 带选项的保存图像
@@ -2037,7 +2094,7 @@ void DrawArea::saveImageWithOptions() {
     // 显示保存对话框
     QString fileName = QFileDialog::getSaveFileName(this, tr("保存图像"),
                                                   QDir::homePath(),
-                                                  tr("图像文件 (*.png *.jpg *.bmp)"));
+                                                  tr("图像文件 (*.png *.jpg *.bmp *.tif *.tiff)"));
     if (fileName.isEmpty()) {
         return;
     }
@@ -2099,9 +2156,20 @@ void DrawArea::saveImageWithOptions() {
     qualityLayout.addWidget(&transparentBg);
     qualityLayout.addWidget(&highQuality);
     
+    // 超过阈值的尺寸使用分块导出，只有TIFF能逐行流式写出，其他格式需要整幅图像常驻内存
+    const int MAX_REGULAR_SIZE = 4000;
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+    const bool isTiff = (suffix == "tif" || suffix == "tiff");
+    
+    QLabel largeExportHint(tr("宽度或高度超过 %1 像素时只能导出为TIFF格式（*.tif, *.tiff）")
+                           .arg(MAX_REGULAR_SIZE), &dialog);
+    largeExportHint.setWordWrap(true);
+    largeExportHint.setStyleSheet("color: #b00020;");
+    
     // 添加组件到主布局
     layout.addWidget(&sizeBox);
     layout.addWidget(&qualityBox);
+    layout.addWidget(&largeExportHint);
     
     // 添加按钮
     QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, 
@@ -2111,6 +2179,16 @@ void DrawArea::saveImageWithOptions() {
     
     layout.addWidget(&buttonBox);
     
+    // 非TIFF格式超出阈值时显示提示并禁用确定按钮
+    auto updateLargeExportHint = [&]() {
+        const bool large = widthSpin.value() > MAX_REGULAR_SIZE || heightSpin.value() > MAX_REGULAR_SIZE;
+        largeExportHint.setVisible(large && !isTiff);
+        buttonBox.button(QDialogButtonBox::Ok)->setEnabled(!large || isTiff);
+    };
+    QObject::connect(&widthSpin, QOverload<int>::of(&QSpinBox::valueChanged), updateLargeExportHint);
+    QObject::connect(&heightSpin, QOverload<int>::of(&QSpinBox::valueChanged), updateLargeExportHint);
+    updateLargeExportHint();
+    
     // 显示对话框
     if (dialog.exec() == QDialog::Accepted) {
         // 获取设置
@@ -2118,8 +2196,7 @@ void DrawArea::saveImageWithOptions() {
         bool transparent = transparentBg.isChecked();
         bool useHighQuality = highQuality.isChecked();
         
-        // 检查导出大小，如果超过特定阈值使用分块导出
-        const int MAX_REGULAR_SIZE = 4000;
+        // 检查导出大小，如果超过特定阈值使用分块导出（仅限TIFF）
         if (size.width() > MAX_REGULAR_SIZE || size.height() > MAX_REGULAR_SIZE) {
             // 使用分块导出
             exportLargeImage(fileName, size, transparent);
@@ -2180,84 +2257,145 @@ void DrawArea::exportLargeImage(const QString& filePath, const QSize& size, bool
 
 // 分块渲染大图像
 bool DrawArea::exportLargeImageTiled(const QString& filePath, const QSize& size, bool transparent) {
-    if (!m_scene) return false;
+    if (!m_scene || size.isEmpty()) return false;
+    
+    // 分块导出只支持TIFF，其他格式需要整幅图像常驻内存
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix != "tif" && suffix != "tiff") {
+        Logger::error(QString("DrawArea::exportLargeImageTiled: 大尺寸导出只支持TIFF格式: %1").arg(filePath));
+        return false;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
     
     // 显示进度对话框
     QProgressDialog progress(tr("正在导出大尺寸图像..."), tr("取消"), 0, 100, this);
     progress.setWindowModality(Qt::WindowModal);
     progress.show();
     
-    // 计算最佳分块大小（根据内存限制）
-    const int MAX_TILE_SIZE = 2000; // 像素
+    // 分块大小：块越小取消越及时，峰值内存也越低
+    const int MAX_TILE_SIZE = 1024; // 像素
     
-    int tilesX = std::ceil(static_cast<double>(size.width()) / MAX_TILE_SIZE);
-    int tilesY = std::ceil(static_cast<double>(size.height()) / MAX_TILE_SIZE);
-    int totalTiles = tilesX * tilesY;
+    const int tilesX = std::ceil(static_cast<double>(size.width()) / MAX_TILE_SIZE);
+    const int tilesY = std::ceil(static_cast<double>(size.height()) / MAX_TILE_SIZE);
+    const int totalTiles = tilesX * tilesY;
     
-    // 创建最终图像
-    QImage finalImage(size, transparent ? QImage::Format_ARGB32 : QImage::Format_RGB32);
-    if (transparent) {
-        finalImage.fill(Qt::transparent);
-    } else {
-        finalImage.fill(Qt::white);
+    // 计算每块大小
+    const int tileWidth = std::ceil(static_cast<double>(size.width()) / tilesX);
+    const int tileHeight = std::ceil(static_cast<double>(size.height()) / tilesY);
+    
+    // 获取场景边界及场景到图像的缩放
+    const QRectF sceneBounds = m_scene->sceneRect();
+    const double scaleX = size.width() / sceneBounds.width();
+    const double scaleY = size.height() / sceneBounds.height();
+    
+    // 分块结果按条带流式写入TIFF，峰值内存只有几行分块；
+    // 其他格式只能由QImageWriter整体编码，会重新分配整幅图像，因此不走这条路径
+    TiffStreamWriter tiffWriter;
+    if (!tiffWriter.open(filePath, size, transparent, 64)) {
+        return false;
     }
     
-    QPainter finalPainter(&finalImage);
-    
-    // 计算每块大小
-    int tileWidth = std::ceil(static_cast<double>(size.width()) / tilesX);
-    int tileHeight = std::ceil(static_cast<double>(size.height()) / tilesY);
+    // 写出一行分块（在写出线程中执行）
+    std::atomic<bool> writeOk{true};
+    auto writeRow = [&tiffWriter, &writeOk, size, transparent](QList<QImage> rowTiles) {
+        if (!writeOk.load()) {
+            return;
+        }
+        
+        // 转换为TIFF写入器所需的字节序（非预乘RGBA或RGB）
+        for (QImage& tile : rowTiles) {
+            tile = tile.convertToFormat(transparent ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
+        }
+        const int bytesPerPixel = tiffWriter.samplesPerPixel();
+        QByteArray scanline(size.width() * bytesPerPixel, Qt::Uninitialized);
+        const int rowHeight = rowTiles.first().height();
+        for (int line = 0; line < rowHeight; ++line) {
+            char* dest = scanline.data();
+            for (const QImage& tile : rowTiles) {
+                const int bytes = tile.width() * bytesPerPixel;
+                memcpy(dest, tile.constScanLine(line), bytes);
+                dest += bytes;
+            }
+            if (!tiffWriter.writeScanline(reinterpret_cast<const uchar*>(scanline.constData()))) {
+                writeOk.store(false);
+                return;
+            }
+        }
+    };
     
-    // 获取场景边界
-    QRectF sceneBounds = m_scene->sceneRect();
+    // QGraphicsScene不是线程安全的，分块只能在GUI线程渲染；
+    // 格式转换和写出交给单独的线程，与下一行的渲染重叠进行
+    QThreadPool writerPool;
+    writerPool.setMaxThreadCount(1);
     
-    // 开始分块渲染
-    int currentTile = 0;
+    int finishedTiles = 0;
+    bool canceled = false;
     
-    for (int y = 0; y < tilesY; ++y) {
+    for (int y = 0; y < tilesY && !canceled && writeOk.load(); ++y) {
+        const int startY = y * tileHeight;
+        const int curTileHeight = std::min(tileHeight, size.height() - startY);
+        
+        QList<QImage> rowTiles;
         for (int x = 0; x < tilesX; ++x) {
-            // 更新进度
-            progress.setValue(static_cast<int>(static_cast<double>(currentTile) / totalTiles * 100));
-            if (progress.wasCanceled()) {
-                return false;
-            }
+            const int startX = x * tileWidth;
+            const int curTileWidth = std::min(tileWidth, size.width() - startX);
             
-            // 计算当前块的位置和大小
-            int startX = x * tileWidth;
-            int startY = y * tileHeight;
-            int curTileWidth = std::min(tileWidth, size.width() - startX);
-            int curTileHeight = std::min(tileHeight, size.height() - startY);
+            // 每块按自己的目标矩形和源矩形直接渲染场景，位图项按导出分辨率采样
+            const QRectF targetRect(0, 0, curTileWidth, curTileHeight);
+            const QRectF sourceRect(sceneBounds.left() + startX / scaleX,
+                                    sceneBounds.top() + startY / scaleY,
+                                    curTileWidth / scaleX,
+                                    curTileHeight / scaleY);
             
-            QRect tileRect(startX, startY, curTileWidth, curTileHeight);
-            
-            // 计算场景中对应的矩形
-            double sceneRatioX = sceneBounds.width() / size.width();
-            double sceneRatioY = sceneBounds.height() / size.height();
-            
-            QRectF sceneRect(
-                sceneBounds.x() + startX * sceneRatioX,
-                sceneBounds.y() + startY * sceneRatioY,
-                curTileWidth * sceneRatioX,
-                curTileHeight * sceneRatioY
-            );
-            
-            // 渲染这一块
-            renderScenePart(&finalPainter, tileRect, sceneRect);
+            QImage tile(curTileWidth, curTileHeight, QImage::Format_ARGB32_Premultiplied);
+            tile.fill(transparent ? Qt::transparent : Qt::white);
+            {
+                QPainter painter(&tile);
+                painter.setRenderHint(QPainter::Antialiasing, true);
+                painter.setRenderHint(QPainter::TextAntialiasing, true);
+                painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+                m_scene->render(&painter, targetRect, sourceRect, Qt::IgnoreAspectRatio);
+            }
+            rowTiles.append(tile);
             
-            // 增加计数
-            currentTile++;
+            // 更新进度，保持进度对话框响应
+            ++finishedTiles;
+            progress.setValue(static_cast<int>(static_cast<double>(finishedTiles) / totalTiles * 100));
+            QCoreApplication::processEvents();
+            if (progress.wasCanceled()) {
+                canceled = true;
+                break;
+            }
         }
+        if (canceled) {
+            break;
+        }
+        
+        // 上一行写出完成后再提交这一行，内存中最多保留两行分块
+        writerPool.waitForDone();
+        writerPool.start([writeRow, rowTiles]() { writeRow(rowTiles); });
     }
     
-    // 完成绘制
-    finalPainter.end();
+    writerPool.waitForDone();
+    
+    if (canceled || !writeOk.load()) {
+        tiffWriter.abort();
+        Logger::info(QString("DrawArea::exportLargeImageTiled: 导出已%1").arg(canceled ? "取消" : "失败"));
+        return false;
+    }
     
-    // 保存最终图像
-    bool success = finalImage.save(filePath);
+    // 完成写出
+    const bool success = tiffWriter.close();
     
     // 完成进度对话框
     progress.setValue(100);
     
+    Logger::debug(QString("DrawArea::exportLargeImageTiled: %1x%2, %3个分块, 耗时 %4 ms")
+                  .arg(size.width()).arg(size.height()).arg(totalTiles)
+                  .arg(timer.elapsed()));
+    
     return success;
 }
 
@@ -2387,6 +2525,12 @@ bool DrawArea::loadFromCustomFormat(const QString& filePath)
             Logger::debug("DrawArea::loadFromCustomFormat: 连接线已恢复");
         }
         
+        // 批量加载后整体重建空间索引，比逐项插入得到更紧凑的R树
+        if (success && m_spatialIndex) {
+            m_spatialIndex->rebuild();
+            optimizeVisibleItems();
+        }
+        
         if (success) {
             Logger::info(QString("成功加载文件: %1").arg(filePath));
             emit statusMessageChanged(tr("文件已加载: %1").arg(filePath), 3000);
@@ -2514,8 +2658,8 @@ void DrawArea::openWithFormatDialog() {
             return;
         }
         
-        // 清空当前场景
-        m_scene->clear();
+        // 清空当前场景（保留连接点覆盖层，并清空引用旧图形项的历史命令）
+        clearGraphics();
         
         // 导入图像到场景中心
         QPointF center = m_scene->sceneRect().center() - QPointF(image.width() / 2, image.height() / 2);
@@ -2785,7 +2929,7 @@ void DrawArea::updateConnectionManager()
             // 检查是否真的需要更新（例如，项目是否正在移动）
             if (item->flags() & QGraphicsItem::ItemIsMovable && 
                 (item->pos() != item->data(0).toPointF())) { // 使用data()存储上次位置
-                m_connectionManager->updateConnections(flowchartItem);
+                m_connectionManager->markItemDirty(flowchartItem);
                 item->setData(0, item->pos()); // 记录当前位置
             }
         }
@@ -9,6 +9,7 @@
 #include "../core/selection_manager.h"
 #include "../core/connection_manager.h"
 #include "../core/connection_point_overlay.h"
+#include "../core/spatial_index.h"
 #include "../state/editor_state.h"
 #include "../utils/scene_utils.h"
 
@@ -28,6 +29,9 @@ public:
     // 场景访问方法
     QGraphicsScene* scene() const { return m_scene; }
     
+    // 获取场景空间索引
+    SpatialIndex* getSpatialIndex() const { return m_spatialIndex.get(); }
+    
     // 性能优化相关方法
     void setHighQualityRendering(bool enable);
     bool isHighQualityRendering() const { return m_highQualityRendering; }
@@ -76,7 +80,7 @@ public:
     // 性能优化相关方法
     void saveImageOptimized();
     void saveImageWithOptions();
-    void exportLargeImage(const QString& filePath, const QSize& size, bool transparent = false);
+    void exportLargeImage(const QString& filePath, const QSize& size, bool transparent = false); // 仅支持TIFF
 
     // 视口交互功能
     void enableGrid(bool enable);
@@ -89,6 +93,9 @@ public:
     void rotateSelectedGraphics(double angle);
     void scaleSelectedGraphics(double factor);
     void flipSelectedGraphics(bool horizontal);
+    
+    // 对选中的流程图元素（少于两个时为全部流程图元素）做分层自动布局，返回参与布局的元素数
+    int autoLayoutFlowchart();
     void deleteSelectedGraphics();
     
     // 选择所有图形
@@ -166,6 +173,7 @@ protected:
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
     void drawBackground(QPainter *painter, const QRectF &rect) override;
     void drawForeground(QPainter *painter, const QRectF &rect) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
@@ -176,6 +184,7 @@ protected:
 
 private:
     QGraphicsScene* m_scene;
+    std::unique_ptr<SpatialIndex> m_spatialIndex;
     std::unique_ptr<DefaultGraphicsItemFactory> m_graphicFactory;
     std::unique_ptr<EditorState> m_currentState;
     std::unique_ptr<SelectionManager> m_selectionManager;
@@ -255,6 +264,7 @@ private:
     // 缓存和裁剪优化属性
     bool m_graphicsCachingEnabled = false;
     bool m_clippingOptimizationEnabled = true;
+    QSet<QGraphicsItem*> m_cachedVisibleItems;  // 上次视口查询中启用了缓存的项目
     
     // 内部辅助方法
     void updateGraphicsCaching();
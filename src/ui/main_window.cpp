@@ -18,6 +18,7 @@
 #include <QDebug>
 #include "../core/graphic_item.h"
 #include "../command/command_manager.h"
+#include "../utils/clip_algorithms.h"
 #include <QApplication>
 #include <QTimer>
 #include <QClipboard>
@@ -203,6 +204,10 @@ void MainWindow::createActions() {
     m_flipVerticalAction = new QAction(QIcon(":/icons/flip_v.png"), tr("垂直翻转"), this);
     m_flipVerticalAction->setShortcut(QKeySequence("Ctrl+J"));
     m_flipVerticalAction->setStatusTip(tr("垂直翻转选中的图形"));
+    
+    m_autoLayoutAction = new QAction(tr("自动布局"), this);
+    m_autoLayoutAction->setShortcut(QKeySequence("Ctrl+L"));
+    m_autoLayoutAction->setStatusTip(tr("按连接关系对流程图元素分层排列"));
 
     // 创建图层工具
     m_bringToFrontAction = new QAction(QIcon(":/icons/front.png"), tr("置顶"), this);
@@ -256,6 +261,15 @@ void MainWindow::createActions() {
     connect(m_deleteAction, &QAction::triggered, this, [this]() { onTransformActionTriggered(m_deleteAction); });
     connect(m_flipHorizontalAction, &QAction::triggered, this, [this]() { onTransformActionTriggered(m_flipHorizontalAction); });
     connect(m_flipVerticalAction, &QAction::triggered, this, [this]() { onTransformActionTriggered(m_flipVerticalAction); });
+    connect(m_autoLayoutAction, &QAction::triggered, this, [this]() {
+        // 不要求选择：没有选中多个流程图元素时布局整个流程图
+        int count = m_drawArea->autoLayoutFlowchart();
+        if (count > 0) {
+            statusBar()->showMessage(tr("已自动布局 %1 个流程图元素").arg(count), 3000);
+        } else {
+            statusBar()->showMessage(tr("没有可布局的流程图元素"), 3000);
+        }
+    });
 
     // 图层工具信号槽
     connect(m_bringToFrontAction, &QAction::triggered, this, [this]() { onLayerActionTriggered(m_bringToFrontAction); });
@@ -327,6 +341,10 @@ void MainWindow::createActions() {
     m_clippingOptimizationAction->setCheckable(true);
     m_clippingOptimizationAction->setChecked(true);
     connect(m_clippingOptimizationAction, &QAction::toggled, this, &MainWindow::onClippingOptimizationToggled);
+    
+    m_booleanBenchmarkAction = new QAction(tr("布尔运算基准测试"), this);
+    m_booleanBenchmarkAction->setStatusTip(tr("对比扫描线交集与QPainterPath::intersected的耗时和结果"));
+    connect(m_booleanBenchmarkAction, &QAction::triggered, this, &MainWindow::onBooleanBenchmark);
 
     // 创建文件操作动作
     m_newAction = new QAction(QIcon(":/icons/new.png"), tr("新建"), this);
@@ -386,6 +404,8 @@ void MainWindow::createMenus() {
     editMenu->addAction(m_cutAction);
     editMenu->addSeparator();
     editMenu->addAction(m_deleteAction);
+    editMenu->addSeparator();
+    editMenu->addAction(m_autoLayoutAction);
 
     // 添加视图菜单，包含性能监控选项
     QMenu* viewMenu = menuBar()->addMenu("视图");
@@ -399,6 +419,7 @@ void MainWindow::createMenus() {
     viewMenu->addAction(m_highQualityRenderingAction);
     viewMenu->addAction(m_cachingAction);
     viewMenu->addAction(m_clippingOptimizationAction);
+    viewMenu->addAction(m_booleanBenchmarkAction);
     viewMenu->addSeparator();
 
     // 创建文件菜单
@@ -1116,6 +1137,17 @@ void MainWindow::onClippingOptimizationToggled(bool checked)
     }
 }
 
+void MainWindow::onBooleanBenchmark()
+{
+    statusBar()->showMessage(tr("正在运行布尔运算基准测试..."));
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const QString report = ClipAlgorithms::runBooleanBenchmarks();
+    QApplication::restoreOverrideCursor();
+    statusBar()->clearMessage();
+    
+    QMessageBox::information(this, tr("布尔运算基准测试"), report);
+}
+
 void MainWindow::onExportImageWithOptions()
 {
     if (m_drawArea) {
@@ -55,6 +55,7 @@ private slots:
     // 性能优化相关槽函数
     void onCachingToggled(bool checked);
     void onClippingOptimizationToggled(bool checked);
+    void onBooleanBenchmark();
     void onExportImageWithOptions();
 
     // 文件操作相关槽
@@ -108,6 +109,7 @@ private:
     QAction* m_deleteAction;
     QAction* m_flipHorizontalAction; // 水平翻转
     QAction* m_flipVerticalAction;   // 垂直翻转
+    QAction* m_autoLayoutAction;     // 流程图自动布局
 
     // 图层工具
     QAction* m_bringToFrontAction;
@@ -161,6 +163,7 @@ private:
     // 性能相关动作
     QAction* m_cachingAction;
     QAction* m_clippingOptimizationAction;
+    QAction* m_booleanBenchmarkAction;
 
     // 文件操作
     QString m_currentFilePath;
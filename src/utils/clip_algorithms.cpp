@@ -9,10 +9,14 @@
 #include <QPainterPath>
 #include <QImage>
 #include <QPainter>
-#include <QBitmap>
 #include <QRegion>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <QString>
 #include <map>
 #include <set>
+#include <iterator>
 
 namespace ClipAlgorithms {
 
@@ -279,6 +283,36 @@ bool validateIntersection(const QPainterPath& result, const QPainterPath& clip)
     return isValid;
 }
 
+// 按行扫描不透明像素段构建区域，只使用QImage/QRegion，可在工作线程调用（QBitmap仅限GUI线程）
+QRegion regionFromAlpha(const QImage& image) {
+    const QImage argb = image.convertToFormat(QImage::Format_ARGB32);
+    QVector<QRect> rects;
+
+    for (int y = 0; y < argb.height(); ++y) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(argb.constScanLine(y));
+        int x = 0;
+        while (x < argb.width()) {
+            while (x < argb.width() && qAlpha(line[x]) == 0) {
+                ++x;
+            }
+            const int runStart = x;
+            while (x < argb.width() && qAlpha(line[x]) > 0) {
+                ++x;
+            }
+            if (x > runStart) {
+                rects.append(QRect(runStart, y, x - runStart, 1));
+            }
+        }
+    }
+
+    // 每行的段互不重叠且按y-x排序，满足setRects的要求
+    QRegion region;
+    if (!rects.isEmpty()) {
+        region.setRects(rects.constData(), rects.size());
+    }
+    return region;
+}
+
 } // namespace Internal
 
 // 使用Sutherland-Hodgman算法裁剪多边形
@@ -606,6 +640,157 @@ bool isPathRectangular(const QPainterPath& path, qreal tolerance) {
     return areaRatio < tolerance;
 }
 
+// 批量判断矩形与多边形的位置关系
+std::vector<RegionRelation> classifyRects(const std::vector<QPointF>& polygon, const std::vector<QRectF>& rects) {
+    const size_t count = rects.size();
+    std::vector<RegionRelation> result(count, RegionRelation::Outside);
+    if (polygon.size() < 3 || count == 0) {
+        return result;
+    }
+    
+    // 矩形按分量分开存储，内层循环只有连续访问的算术和比较
+    std::vector<double> left(count), top(count), right(count), bottom(count);
+    for (size_t k = 0; k < count; ++k) {
+        const QRectF rect = rects[k].normalized();
+        left[k] = rect.left();
+        top[k] = rect.top();
+        right[k] = rect.right();
+        bottom[k] = rect.bottom();
+    }
+    std::vector<unsigned char> inside(count, 0);
+    std::vector<unsigned char> crossed(count, 0);
+    
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const double x0 = polygon[j].x();
+        const double y0 = polygon[j].y();
+        const double x1 = polygon[i].x();
+        const double y1 = polygon[i].y();
+        const double minX = std::min(x0, x1);
+        const double maxX = std::max(x0, x1);
+        const double minY = std::min(y0, y1);
+        const double maxY = std::max(y0, y1);
+        // 边所在直线 a*x + b*y + c = 0
+        const double a = y1 - y0;
+        const double b = x0 - x1;
+        const double c = x1 * y0 - x0 * y1;
+        // 水平边不会与水平射线相交，斜率倒数取0即可
+        const double inverseSlope = (y1 != y0) ? (x1 - x0) / (y1 - y0) : 0.0;
+        
+        for (size_t k = 0; k < count; ++k) {
+            const double l = left[k];
+            const double t = top[k];
+            const double r = right[k];
+            const double btm = bottom[k];
+            
+            // 射线法：左上角向右的射线穿过该边时翻转奇偶性
+            const bool spans = (y0 > t) != (y1 > t);
+            const bool toLeft = l < x0 + (t - y0) * inverseSlope;
+            inside[k] ^= static_cast<unsigned char>(spans & toLeft);
+            
+            // 分离轴：包围盒不重叠或四个角都在直线同一侧时，边与矩形不相交
+            const bool boxesOverlap = (minX <= r) & (maxX >= l) & (minY <= btm) & (maxY >= t);
+            const double f0 = a * l + b * t + c;
+            const double f1 = a * r + b * t + c;
+            const double f2 = a * l + b * btm + c;
+            const double f3 = a * r + b * btm + c;
+            const double fMin = std::min(std::min(f0, f1), std::min(f2, f3));
+            const double fMax = std::max(std::max(f0, f1), std::max(f2, f3));
+            crossed[k] |= static_cast<unsigned char>(boxesOverlap & (fMin <= 0.0) & (fMax >= 0.0));
+        }
+    }
+    
+    for (size_t k = 0; k < count; ++k) {
+        if (crossed[k]) {
+            result[k] = RegionRelation::Partial;
+        } else if (inside[k]) {
+            result[k] = RegionRelation::Inside;
+        }
+    }
+    return result;
+}
+
+// ==================== 流式折线简化 ====================
+
+StreamingSimplifier::StreamingSimplifier(qreal tolerance)
+    : m_tolerance(qMax<qreal>(0.0, tolerance))
+{
+}
+
+void StreamingSimplifier::setTolerance(qreal tolerance)
+{
+    m_tolerance = qMax<qreal>(0.0, tolerance);
+}
+
+void StreamingSimplifier::reset()
+{
+    m_inputCount = 0;
+    m_vertices.clear();
+    m_pending.clear();
+}
+
+bool StreamingSimplifier::pendingFitsSegment(const QPointF& end) const
+{
+    const QPointF start = m_vertices.back();
+    const QPointF d = end - start;
+    const qreal lengthSq = d.x() * d.x() + d.y() * d.y();
+    const qreal toleranceSq = m_tolerance * m_tolerance;
+    
+    for (const QPointF& p : m_pending) {
+        const QPointF v = p - start;
+        qreal distSq;
+        if (lengthSq <= 1e-12) {
+            distSq = v.x() * v.x() + v.y() * v.y();
+        } else {
+            // 点到线段（而非直线）的距离，保证折返的笔画不会被拉直
+            const qreal t = qBound<qreal>(0.0, (v.x() * d.x() + v.y() * d.y()) / lengthSq, 1.0);
+            const QPointF e = v - d * t;
+            distSq = e.x() * e.x() + e.y() * e.y();
+        }
+        if (distSq > toleranceSq) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StreamingSimplifier::addPoint(const QPointF& point)
+{
+    if (m_vertices.empty()) {
+        m_vertices.push_back(point);
+        m_inputCount = 1;
+        return true;
+    }
+    
+    const QPointF& last = m_pending.empty() ? m_vertices.back() : m_pending.back();
+    if (point == last) {
+        return false;
+    }
+    ++m_inputCount;
+    
+    // 新点使候选线段超出容差时，窗口中的最后一个点成为新顶点
+    if (!m_pending.empty() &&
+        (m_pending.size() >= MAX_PENDING_POINTS || !pendingFitsSegment(point))) {
+        m_vertices.push_back(m_pending.back());
+        m_pending.clear();
+        m_pending.push_back(point);
+        return true;
+    }
+    
+    m_pending.push_back(point);
+    return false;
+}
+
+std::vector<QPointF> StreamingSimplifier::points() const
+{
+    std::vector<QPointF> result;
+    result.reserve(m_vertices.size() + 1);
+    result.insert(result.end(), m_vertices.begin(), m_vertices.end());
+    if (!m_pending.empty()) {
+        result.push_back(m_pending.back());
+    }
+    return result;
+}
+
 // 添加自定义的路径交集实现，模仿Qt的intersected方法
 QPainterPath customIntersected(const QPainterPath& subject, const QPainterPath& clip) {
     Logger::debug("customIntersected: 开始计算路径交集");
@@ -616,44 +801,15 @@ QPainterPath customIntersected(const QPainterPath& subject, const QPainterPath&
         return QPainterPath();
     }
     
-    // 转换为点集，用于裁剪算法
-    double flatness = 0.1; // 较小的值能获得更高的精度
-    std::vector<QPointF> subjectPoints = pathToPoints(subject, flatness);
-    std::vector<QPointF> clipPoints = pathToPoints(clip, flatness);
-    
-    Logger::debug(QString("customIntersected: 主体路径提取点数 %1，裁剪路径提取点数 %2")
-                 .arg(subjectPoints.size())
-                 .arg(clipPoints.size()));
-    
-    // 检查点集是否有效
-    if (subjectPoints.size() < 3 || clipPoints.size() < 3) {
-        Logger::warning("customIntersected: 点集合不足，无法计算交集");
-        return QPainterPath();
-    }
-    
-    // 使用Weiler-Atherton裁剪算法计算两个多边形的交集
-    std::vector<QPointF> resultPoints = weilerAthertonClip(subjectPoints, clipPoints);
-    
-    // 创建结果路径
-    QPainterPath resultPath;
-    if (resultPoints.size() >= 3) {
-        // 将点集转换为路径
-        resultPath = pointsToPath(resultPoints);
-        
-        // 使用新的验证方法检查结果
-        if (!Internal::validateIntersection(resultPath, clip)) {
-            Logger::debug("customIntersected: 验证失败，尝试使用栅格化方法");
-            QPainterPath rasterPath = rasterizeIntersection(subject, clip);
-            
-            if (!rasterPath.isEmpty()) {
-                resultPath = rasterPath;
-                Logger::debug(QString("customIntersected: 使用栅格化方法创建的路径包含 %1 个元素")
-                             .arg(resultPath.elementCount()));
-            }
-        }
+    // 默认使用精确的扫描线布尔运算
+    bool ok = false;
+    QPainterPath result = Internal::sweepBooleanPath(subject, clip, BooleanOperation::Intersection, 0.1, &ok);
+    if (ok) {
+        return result;
     }
     
-    return resultPath;
+    Logger::debug("customIntersected: 扫描线算法失败，使用Weiler-Atherton算法");
+    return Internal::weilerAthertonIntersected(subject, clip);
 }
 
 // Weiler-Atherton算法裁剪任意多边形
@@ -925,9 +1081,7 @@ QPainterPath rasterizeIntersection(const QPainterPath& subject, const QPainterPa
     if (startPoint.x() == -1) {
         Logger::warning("rasterizeIntersection: 无法找到起始边界点");
         // 创建路径
-        QBitmap bitmap = QBitmap::fromImage(resultImage.createAlphaMask());
-        QRegion region(bitmap);
-        resultPath.addRegion(region);
+        resultPath.addRegion(Internal::regionFromAlpha(resultImage));
         
         // 应用反向变换
         QTransform inverseTransform = transform.inverted();
@@ -1082,9 +1236,7 @@ QPainterPath rasterizeIntersection(const QPainterPath& subject, const QPainterPa
         Logger::warning("rasterizeIntersection: 轮廓跟踪失败，回退到传统方法");
         
         // 创建路径
-        QBitmap bitmap = QBitmap::fromImage(resultImage.createAlphaMask());
-        QRegion region(bitmap);
-        resultPath.addRegion(region);
+        resultPath.addRegion(Internal::regionFromAlpha(resultImage));
         
         // 应用反向变换
         QTransform inverseTransform = transform.inverted();
@@ -1097,7 +1249,7 @@ QPainterPath rasterizeIntersection(const QPainterPath& subject, const QPainterPa
     return resultPath;
 }
 
-// 修改clipPath函数，增加栅格化备选方案
+// 裁剪路径：默认使用扫描线布尔运算，失败时依次回退到Weiler-Atherton和栅格化方法
 QPainterPath clipPath(const QPainterPath& subject, const QPainterPath& clip) {
     Logger::debug("clipPath: 开始裁剪路径");
     
@@ -1107,9 +1259,15 @@ QPainterPath clipPath(const QPainterPath& subject, const QPainterPath& clip) {
         return QPainterPath();
     }
     
-    // 使用优化后的自定义路径交集算法
-    Logger::debug("clipPath: 使用自定义交集算法计算路径裁剪");
-    QPainterPath result = customIntersected(subject, clip);
+    // 精确算法的空结果表示两者不相交，无需再尝试其他方法
+    bool ok = false;
+    QPainterPath result = Internal::sweepBooleanPath(subject, clip, BooleanOperation::Intersection, 0.1, &ok);
+    if (ok) {
+        return result;
+    }
+    
+    Logger::debug("clipPath: 扫描线算法失败，使用Weiler-Atherton算法");
+    result = Internal::weilerAthertonIntersected(subject, clip);
     
     // 如果自定义算法失败，尝试使用栅格化方法
     if (result.isEmpty()) {
@@ -1120,4 +1278,740 @@ QPainterPath clipPath(const QPainterPath& subject, const QPainterPath& clip) {
     return result;
 }
 
+// ==================== 扫描线多边形布尔运算 ====================
+
+namespace Internal {
+
+// 定点坐标的缩放倍数：坐标取整到1/256像素，方向判定在64位整数上精确进行
+const double BOOLEAN_SCALE = 256.0;
+// 定点坐标的绝对值上限，保证叉积不溢出64位整数
+const qint64 BOOLEAN_COORD_LIMIT = qint64(1) << 26;
+// 求交-分割的最大迭代次数（交点取整后可能产生新的交叉）
+const int BOOLEAN_MAX_SPLIT_PASSES = 8;
+
+// 定点坐标点
+struct FixedPoint {
+    qint64 x = 0;
+    qint64 y = 0;
+    
+    bool operator==(const FixedPoint& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const FixedPoint& other) const { return !(*this == other); }
+    // 字典序：先x后y，即扫描线的推进顺序
+    bool operator<(const FixedPoint& other) const {
+        return x < other.x || (x == other.x && y < other.y);
+    }
+};
+
+// 布尔运算的边：p按字典序小于q，windSubject/windClip为跨过该边时两个多边形环绕数的变化
+struct BooleanEdge {
+    FixedPoint p;
+    FixedPoint q;
+    int windSubject = 0;
+    int windClip = 0;
+    bool fresh = true;  // 上一轮分割中新产生的边，需要重新求交
+};
+
+// 叉积 (b - a) x (c - a)，正值表示c在a->b的左侧
+qint64 orient(const FixedPoint& a, const FixedPoint& b, const FixedPoint& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+int sign(qint64 value) {
+    return (value > 0) - (value < 0);
+}
+
+bool toFixedPoint(const QPointF& point, FixedPoint& fixed) {
+    const double x = std::round(point.x() * BOOLEAN_SCALE);
+    const double y = std::round(point.y() * BOOLEAN_SCALE);
+    if (!(std::fabs(x) <= BOOLEAN_COORD_LIMIT && std::fabs(y) <= BOOLEAN_COORD_LIMIT)) {
+        return false;
+    }
+    fixed.x = static_cast<qint64>(x);
+    fixed.y = static_cast<qint64>(y);
+    return true;
+}
+
+QPointF fromFixedPoint(const FixedPoint& fixed) {
+    return QPointF(fixed.x / BOOLEAN_SCALE, fixed.y / BOOLEAN_SCALE);
+}
+
+// 将多边形的各条边加入边表，isClip决定计入哪个多边形的环绕数
+bool appendPolygonEdges(const std::vector<std::vector<QPointF>>& contours, bool isClip,
+                        std::vector<BooleanEdge>& edges) {
+    for (const std::vector<QPointF>& contour : contours) {
+        if (contour.size() < 3) {
+            continue;
+        }
+        FixedPoint first;
+        if (!toFixedPoint(contour.front(), first)) {
+            return false;
+        }
+        FixedPoint previous = first;
+        for (size_t i = 1; i <= contour.size(); ++i) {
+            FixedPoint current = first;
+            if (i < contour.size() && !toFixedPoint(contour[i], current)) {
+                return false;
+            }
+            if (current != previous) {
+                BooleanEdge edge;
+                const bool forward = previous < current;
+                edge.p = forward ? previous : current;
+                edge.q = forward ? current : previous;
+                (isClip ? edge.windClip : edge.windSubject) = forward ? 1 : -1;
+                edges.push_back(edge);
+            }
+            previous = current;
+        }
+    }
+    return true;
+}
+
+// 点是否严格位于共线线段的内部（不含端点）
+bool strictlyInsideCollinear(const FixedPoint& point, const BooleanEdge& edge) {
+    return edge.p < point && point < edge.q;
+}
+
+// 点是否严格位于线段内部（不含端点）
+bool strictlyInsideSegment(const FixedPoint& point, const BooleanEdge& edge) {
+    return orient(edge.p, edge.q, point) == 0 && strictlyInsideCollinear(point, edge);
+}
+
+// 检查一对边并记录需要的分割点
+void collectSplitPoints(const std::vector<BooleanEdge>& edges, size_t a, size_t b,
+                        std::vector<std::vector<FixedPoint>>& splits) {
+    const BooleanEdge& ea = edges[a];
+    const BooleanEdge& eb = edges[b];
+    
+    // y方向包围盒不重叠时直接跳过（x方向已由扫描保证重叠）
+    if (std::max(ea.p.y, ea.q.y) < std::min(eb.p.y, eb.q.y) ||
+        std::max(eb.p.y, eb.q.y) < std::min(ea.p.y, ea.q.y)) {
+        return;
+    }
+    
+    const qint64 o1 = orient(ea.p, ea.q, eb.p);
+    const qint64 o2 = orient(ea.p, ea.q, eb.q);
+    const qint64 o3 = orient(eb.p, eb.q, ea.p);
+    const qint64 o4 = orient(eb.p, eb.q, ea.q);
+    
+    // 端点落在另一条边内部（T形交点或共线重叠），在该端点处分割
+    if (o1 == 0 && strictlyInsideCollinear(eb.p, ea)) splits[a].push_back(eb.p);
+    if (o2 == 0 && strictlyInsideCollinear(eb.q, ea)) splits[a].push_back(eb.q);
+    if (o3 == 0 && strictlyInsideCollinear(ea.p, eb)) splits[b].push_back(ea.p);
+    if (o4 == 0 && strictlyInsideCollinear(ea.q, eb)) splits[b].push_back(ea.q);
+    
+    // 真正的交叉：交点取整到定点网格后分割两条边
+    if (sign(o1) * sign(o2) < 0 && sign(o3) * sign(o4) < 0) {
+        const double t = static_cast<double>(o3) / static_cast<double>(o3 - o4);
+        FixedPoint crossing;
+        crossing.x = static_cast<qint64>(std::llround(ea.p.x + t * (ea.q.x - ea.p.x)));
+        crossing.y = static_cast<qint64>(std::llround(ea.p.y + t * (ea.q.y - ea.p.y)));
+        if (crossing != ea.p && crossing != ea.q) splits[a].push_back(crossing);
+        if (crossing != eb.p && crossing != eb.q) splits[b].push_back(crossing);
+    }
+}
+
+// 合并重复的边（共线重叠的部分分割后成为相同的边），环绕数变化相加
+void mergeDuplicateEdges(std::vector<BooleanEdge>& edges) {
+    std::sort(edges.begin(), edges.end(), [](const BooleanEdge& a, const BooleanEdge& b) {
+        if (a.p != b.p) return a.p < b.p;
+        return a.q < b.q;
+    });
+    std::vector<BooleanEdge> merged;
+    merged.reserve(edges.size());
+    for (const BooleanEdge& edge : edges) {
+        if (!merged.empty() && merged.back().p == edge.p && merged.back().q == edge.q) {
+            merged.back().windSubject += edge.windSubject;
+            merged.back().windClip += edge.windClip;
+            merged.back().fresh = merged.back().fresh || edge.fresh;
+        } else {
+            merged.push_back(edge);
+        }
+    }
+    // 两个多边形的环绕数都不变的边不影响结果
+    merged.erase(std::remove_if(merged.begin(), merged.end(), [](const BooleanEdge& edge) {
+        return edge.windSubject == 0 && edge.windClip == 0;
+    }), merged.end());
+    edges.swap(merged);
+}
+
+// 扫描一遍找出所有交点并分割边，返回是否发生了分割
+bool splitEdgesAtIntersections(std::vector<BooleanEdge>& edges) {
+    std::vector<size_t> order(edges.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&edges](size_t a, size_t b) {
+        return edges[a].p.x < edges[b].p.x;
+    });
+    
+    // 扫描线按x推进，活动表中只保留与扫描线相交的边。
+    // 未变化的边之间上一轮已经检查过，只需检查涉及新边的边对
+    std::vector<std::vector<FixedPoint>> splits(edges.size());
+    std::vector<size_t> active;
+    std::vector<size_t> activeFresh;
+    for (size_t index : order) {
+        const qint64 sweepX = edges[index].p.x;
+        auto expired = [&edges, sweepX](size_t other) {
+            return edges[other].q.x < sweepX;
+        };
+        active.erase(std::remove_if(active.begin(), active.end(), expired), active.end());
+        activeFresh.erase(std::remove_if(activeFresh.begin(), activeFresh.end(), expired), activeFresh.end());
+        for (size_t other : edges[index].fresh ? active : activeFresh) {
+            collectSplitPoints(edges, index, other, splits);
+        }
+        active.push_back(index);
+        if (edges[index].fresh) {
+            activeFresh.push_back(index);
+        }
+    }
+    
+    bool changed = false;
+    std::vector<BooleanEdge> result;
+    result.reserve(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const BooleanEdge& edge = edges[i];
+        std::vector<FixedPoint>& points = splits[i];
+        if (points.empty()) {
+            result.push_back(edge);
+            result.back().fresh = false;
+            continue;
+        }
+        changed = true;
+        
+        // 按沿边的投影参数排序（取整后的交点不一定严格位于边上）
+        const qint64 dx = edge.q.x - edge.p.x;
+        const qint64 dy = edge.q.y - edge.p.y;
+        std::sort(points.begin(), points.end(), [&edge, dx, dy](const FixedPoint& a, const FixedPoint& b) {
+            return (a.x - edge.p.x) * dx + (a.y - edge.p.y) * dy
+                 < (b.x - edge.p.x) * dx + (b.y - edge.p.y) * dy;
+        });
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+        points.push_back(edge.q);
+        
+        FixedPoint start = edge.p;
+        for (const FixedPoint& end : points) {
+            if (end == start) {
+                continue;
+            }
+            BooleanEdge piece = edge;
+            piece.fresh = true;
+            const bool forward = start < end;
+            piece.p = forward ? start : end;
+            piece.q = forward ? end : start;
+            if (!forward) {
+                piece.windSubject = -piece.windSubject;
+                piece.windClip = -piece.windClip;
+            }
+            result.push_back(piece);
+            start = end;
+        }
+    }
+    
+    edges.swap(result);
+    return changed;
+}
+
+// 扫描线状态中边的上下顺序：a在b下方时返回true（边之间已无交叉）
+struct SweepEdgeBelow {
+    const std::vector<BooleanEdge>* edges;
+    
+    bool operator()(size_t ia, size_t ib) const {
+        if (ia == ib) {
+            return false;
+        }
+        const BooleanEdge& a = (*edges)[ia];
+        const BooleanEdge& b = (*edges)[ib];
+        
+        if (a.p == b.p) {
+            const qint64 o = orient(a.p, a.q, b.q);
+            return o != 0 ? o > 0 : ia < ib;
+        }
+        // 以先开始的边为参照，判断另一条边的起点在其哪一侧
+        if (a.p < b.p) {
+            qint64 o = orient(a.p, a.q, b.p);
+            if (o == 0) o = orient(a.p, a.q, b.q);
+            return o != 0 ? o > 0 : ia < ib;
+        }
+        qint64 o = orient(b.p, b.q, a.p);
+        if (o == 0) o = orient(b.p, b.q, a.q);
+        return o != 0 ? o < 0 : ia < ib;
+    }
+};
+
+bool isInsideByRule(int winding, Qt::FillRule rule) {
+    return rule == Qt::OddEvenFill ? (winding & 1) != 0 : winding != 0;
+}
+
+bool applyBooleanOperation(bool inSubject, bool inClip, BooleanOperation op) {
+    switch (op) {
+        case BooleanOperation::Intersection: return inSubject && inClip;
+        case BooleanOperation::Union:        return inSubject || inClip;
+        case BooleanOperation::Difference:   return inSubject && !inClip;
+    }
+    return false;
+}
+
+// 将有向边首尾相连组成闭合轮廓，并去掉共线的中间顶点
+std::vector<std::vector<QPointF>> assembleContours(const std::vector<std::pair<FixedPoint, FixedPoint>>& segments,
+                                                   bool* ok) {
+    std::map<FixedPoint, std::vector<size_t>> outgoing;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        outgoing[segments[i].first].push_back(i);
+    }
+    
+    std::vector<std::vector<QPointF>> contours;
+    std::vector<bool> used(segments.size(), false);
+    for (size_t startIndex = 0; startIndex < segments.size(); ++startIndex) {
+        if (used[startIndex]) {
+            continue;
+        }
+        
+        std::vector<FixedPoint> ring;
+        size_t current = startIndex;
+        while (true) {
+            used[current] = true;
+            ring.push_back(segments[current].first);
+            const FixedPoint next = segments[current].second;
+            if (next == segments[startIndex].first) {
+                break;
+            }
+            
+            // 结果边界上每个顶点的入边数等于出边数，总能找到未使用的出边
+            std::vector<size_t>& candidates = outgoing[next];
+            while (!candidates.empty() && used[candidates.back()]) {
+                candidates.pop_back();
+            }
+            if (candidates.empty()) {
+                if (ok) *ok = false;
+                return {};
+            }
+            current = candidates.back();
+            candidates.pop_back();
+        }
+        
+        // 去掉共线的中间顶点（由分割产生）
+        std::vector<FixedPoint> simplified;
+        for (size_t i = 0; i < ring.size(); ++i) {
+            const FixedPoint& prev = simplified.empty() ? ring[(i + ring.size() - 1) % ring.size()] : simplified.back();
+            const FixedPoint& next = ring[(i + 1) % ring.size()];
+            if (orient(prev, ring[i], next) != 0) {
+                simplified.push_back(ring[i]);
+            }
+        }
+        if (simplified.size() < 3) {
+            continue;
+        }
+        
+        std::vector<QPointF> contour;
+        contour.reserve(simplified.size());
+        for (const FixedPoint& point : simplified) {
+            contour.push_back(fromFixedPoint(point));
+        }
+        contours.push_back(contour);
+    }
+    return contours;
+}
+
+// 三次贝塞尔曲线的自适应细分：控制点到弦的距离都不超过容差时视为直线
+void flattenCubic(const QPointF& p0, const QPointF& p1, const QPointF& p2, const QPointF& p3,
+                  qreal tolerance, int depth, std::vector<QPointF>& out) {
+    const QPointF chord = p3 - p0;
+    const qreal chordLength = std::sqrt(QPointF::dotProduct(chord, chord));
+    qreal d1, d2;
+    if (chordLength < 1e-9) {
+        d1 = std::sqrt(QPointF::dotProduct(p1 - p0, p1 - p0));
+        d2 = std::sqrt(QPointF::dotProduct(p2 - p0, p2 - p0));
+    } else {
+        d1 = std::fabs((p1.x() - p0.x()) * chord.y() - (p1.y() - p0.y()) * chord.x()) / chordLength;
+        d2 = std::fabs((p2.x() - p0.x()) * chord.y() - (p2.y() - p0.y()) * chord.x()) / chordLength;
+    }
+    
+    if (depth >= 16 || std::max(d1, d2) <= tolerance) {
+        out.push_back(p3);
+        return;
+    }
+    
+    // de Casteljau在t=0.5处细分
+    const QPointF p01 = (p0 + p1) * 0.5;
+    const QPointF p12 = (p1 + p2) * 0.5;
+    const QPointF p23 = (p2 + p3) * 0.5;
+    const QPointF p012 = (p01 + p12) * 0.5;
+    const QPointF p123 = (p12 + p23) * 0.5;
+    const QPointF mid = (p012 + p123) * 0.5;
+    flattenCubic(p0, p01, p012, mid, tolerance, depth + 1, out);
+    flattenCubic(mid, p123, p23, p3, tolerance, depth + 1, out);
+}
+
+} // namespace Internal
+
+std::vector<std::vector<QPointF>> flattenPath(const QPainterPath& path, qreal tolerance) {
+    std::vector<std::vector<QPointF>> contours;
+    std::vector<QPointF> current;
+    tolerance = qMax(tolerance, qreal(0.001));
+    
+    const int count = path.elementCount();
+    for (int i = 0; i < count; ++i) {
+        const QPainterPath::Element element = path.elementAt(i);
+        switch (element.type) {
+            case QPainterPath::MoveToElement:
+                if (current.size() >= 3) {
+                    contours.push_back(current);
+                }
+                current.clear();
+                current.push_back(QPointF(element.x, element.y));
+                break;
+                
+            case QPainterPath::LineToElement:
+                current.push_back(QPointF(element.x, element.y));
+                break;
+                
+            case QPainterPath::CurveToElement:
+                if (i + 2 < count && !current.empty()) {
+                    const QPainterPath::Element c2 = path.elementAt(i + 1);
+                    const QPainterPath::Element end = path.elementAt(i + 2);
+                    Internal::flattenCubic(current.back(), QPointF(element.x, element.y),
+                                           QPointF(c2.x, c2.y), QPointF(end.x, end.y),
+                                           tolerance, 0, current);
+                    i += 2;
+                }
+                break;
+                
+            case QPainterPath::CurveToDataElement:
+                break;
+        }
+    }
+    if (current.size() >= 3) {
+        contours.push_back(current);
+    }
+    
+    // 去掉与起点重合的闭合点
+    for (std::vector<QPointF>& contour : contours) {
+        if (contour.size() > 3 && contour.front() == contour.back()) {
+            contour.pop_back();
+        }
+    }
+    return contours;
+}
+
+std::vector<std::vector<QPointF>> polygonBoolean(const std::vector<std::vector<QPointF>>& subject,
+                                                 Qt::FillRule subjectRule,
+                                                 const std::vector<std::vector<QPointF>>& clip,
+                                                 Qt::FillRule clipRule,
+                                                 BooleanOperation op,
+                                                 bool* ok) {
+    if (ok) *ok = true;
+    
+    std::vector<Internal::BooleanEdge> edges;
+    if (!Internal::appendPolygonEdges(subject, false, edges) ||
+        !Internal::appendPolygonEdges(clip, true, edges)) {
+        Logger::warning("polygonBoolean: 坐标超出定点范围");
+        if (ok) *ok = false;
+        return {};
+    }
+    
+    // 第一步：分割所有交叉、T形交点和共线重叠，直到边之间只在端点处相交
+    Internal::mergeDuplicateEdges(edges);
+    int pass = 0;
+    while (Internal::splitEdgesAtIntersections(edges)) {
+        Internal::mergeDuplicateEdges(edges);
+        if (++pass >= Internal::BOOLEAN_MAX_SPLIT_PASSES) {
+            Logger::warning("polygonBoolean: 交点分割未收敛");
+            if (ok) *ok = false;
+            return {};
+        }
+    }
+    
+    // 第二步：扫描线按字典序推进，由下方相邻边推出每条边上下两侧的环绕数
+    struct SweepEvent {
+        Internal::FixedPoint point;
+        bool isLeft;
+        size_t edge;
+    };
+    std::vector<SweepEvent> events;
+    events.reserve(edges.size() * 2);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        events.push_back({edges[i].p, true, i});
+        events.push_back({edges[i].q, false, i});
+    }
+    // 同一点上先移除结束的边，再自下而上插入开始的边（保证插入时下方相邻边已就位）
+    std::sort(events.begin(), events.end(), [&edges](const SweepEvent& a, const SweepEvent& b) {
+        if (a.point != b.point) return a.point < b.point;
+        if (a.isLeft != b.isLeft) return !a.isLeft;
+        if (!a.isLeft) return a.edge < b.edge;
+        const qint64 o = Internal::orient(a.point, edges[a.edge].q, edges[b.edge].q);
+        return o != 0 ? o > 0 : a.edge < b.edge;
+    });
+    
+    typedef std::set<size_t, Internal::SweepEdgeBelow> SweepStatus;
+    SweepStatus status(Internal::SweepEdgeBelow{&edges});
+    std::vector<SweepStatus::iterator> positions(edges.size(), status.end());
+    std::vector<int> aboveSubject(edges.size(), 0);
+    std::vector<int> aboveClip(edges.size(), 0);
+    std::vector<std::pair<Internal::FixedPoint, Internal::FixedPoint>> resultSegments;
+    
+    for (const SweepEvent& event : events) {
+        const size_t index = event.edge;
+        if (!event.isLeft) {
+            status.erase(positions[index]);
+            continue;
+        }
+        
+        SweepStatus::iterator it = status.insert(index).first;
+        positions[index] = it;
+        
+        int belowSubject = 0;
+        int belowClip = 0;
+        if (it != status.begin()) {
+            const size_t below = *std::prev(it);
+            belowSubject = aboveSubject[below];
+            belowClip = aboveClip[below];
+        }
+        aboveSubject[index] = belowSubject + edges[index].windSubject;
+        aboveClip[index] = belowClip + edges[index].windClip;
+        
+        const bool insideBelow = Internal::applyBooleanOperation(
+            Internal::isInsideByRule(belowSubject, subjectRule),
+            Internal::isInsideByRule(belowClip, clipRule), op);
+        const bool insideAbove = Internal::applyBooleanOperation(
+            Internal::isInsideByRule(aboveSubject[index], subjectRule),
+            Internal::isInsideByRule(aboveClip[index], clipRule), op);
+        
+        // 两侧结果不同的边属于结果边界，定向为内部在左侧
+        if (insideBelow != insideAbove) {
+            if (insideAbove) {
+                resultSegments.push_back(std::make_pair(edges[index].p, edges[index].q));
+            } else {
+                resultSegments.push_back(std::make_pair(edges[index].q, edges[index].p));
+            }
+        }
+    }
+    
+    return Internal::assembleContours(resultSegments, ok);
+}
+
+namespace Internal {
+
+// 扫描线布尔运算的路径版本，失败时ok为false
+QPainterPath sweepBooleanPath(const QPainterPath& subject, const QPainterPath& clip,
+                              BooleanOperation op, qreal tolerance, bool* ok) {
+    bool success = false;
+    const std::vector<std::vector<QPointF>> contours = polygonBoolean(
+        flattenPath(subject, tolerance), subject.fillRule(),
+        flattenPath(clip, tolerance), clip.fillRule(), op, &success);
+    if (ok) *ok = success;
+    
+    // 轮廓已按内部在左侧定向，孔洞方向相反，使用非零环绕规则即可
+    QPainterPath result;
+    result.setFillRule(Qt::WindingFill);
+    for (const std::vector<QPointF>& contour : contours) {
+        result.moveTo(contour.front());
+        for (size_t i = 1; i < contour.size(); ++i) {
+            result.lineTo(contour[i]);
+        }
+        result.closeSubpath();
+    }
+    return result;
+}
+
+} // namespace Internal
+
+QPainterPath booleanOperation(const QPainterPath& subject, const QPainterPath& clip,
+                              BooleanOperation op, qreal tolerance) {
+    bool ok = false;
+    QPainterPath result = Internal::sweepBooleanPath(subject, clip, op, tolerance, &ok);
+    if (ok) {
+        return result;
+    }
+    
+    // 超出定点范围等极端情况回退到Qt的实现
+    Logger::warning("booleanOperation: 扫描线算法失败，回退到QPainterPath布尔运算");
+    switch (op) {
+        case BooleanOperation::Intersection: return subject.intersected(clip);
+        case BooleanOperation::Union:        return subject.united(clip);
+        case BooleanOperation::Difference:   return subject.subtracted(clip);
+    }
+    return QPainterPath();
+}
+
+namespace Internal {
+
+// 将路径栅格化为覆盖掩码，用于比较两种算法的结果
+QImage rasterizeCoverage(const QPainterPath& path, const QRectF& bounds, qreal scale) {
+    const QSize size(qMax(1, qCeil(bounds.width() * scale)), qMax(1, qCeil(bounds.height() * scale)));
+    QImage image(size, QImage::Format_Grayscale8);
+    image.fill(0);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, false);
+    painter.scale(scale, scale);
+    painter.translate(-bounds.topLeft());
+    painter.fillPath(path, Qt::white);
+    return image;
+}
+
+// 生成n个尖角的星形
+QPainterPath makeStar(const QPointF& center, qreal outerRadius, qreal innerRadius, int points) {
+    QPolygonF polygon;
+    for (int i = 0; i < points * 2; ++i) {
+        const qreal radius = (i % 2 == 0) ? outerRadius : innerRadius;
+        const qreal angle = M_PI * i / points;
+        polygon << center + QPointF(radius * std::cos(angle), radius * std::sin(angle));
+    }
+    QPainterPath path;
+    path.addPolygon(polygon);
+    path.closeSubpath();
+    return path;
+}
+
+} // namespace Internal
+
+BooleanBenchmarkResult benchmarkIntersection(const QPainterPath& subject, const QPainterPath& clip,
+                                             int iterations) {
+    BooleanBenchmarkResult result;
+    iterations = qMax(1, iterations);
+    
+    QElapsedTimer timer;
+    QPainterPath sweepResult;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        sweepResult = booleanOperation(subject, clip, BooleanOperation::Intersection);
+    }
+    result.sweepMs = timer.nsecsElapsed() / 1e6 / iterations;
+    
+    QPainterPath qtResult;
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        qtResult = subject.intersected(clip);
+    }
+    result.qtMs = timer.nsecsElapsed() / 1e6 / iterations;
+    
+    result.sweepElements = sweepResult.elementCount();
+    result.qtElements = qtResult.elementCount();
+    
+    // 栅格化两种结果逐像素比较，长边约1000像素
+    const QRectF bounds = subject.boundingRect().united(clip.boundingRect());
+    if (!bounds.isEmpty()) {
+        const qreal scale = 1000.0 / qMax(bounds.width(), bounds.height());
+        const QImage a = Internal::rasterizeCoverage(sweepResult, bounds, scale);
+        const QImage b = Internal::rasterizeCoverage(qtResult, bounds, scale);
+        qint64 mismatched = 0;
+        qint64 covered = 0;
+        for (int y = 0; y < a.height(); ++y) {
+            const uchar* rowA = a.constScanLine(y);
+            const uchar* rowB = b.constScanLine(y);
+            for (int x = 0; x < a.width(); ++x) {
+                mismatched += (rowA[x] != rowB[x]);
+                covered += (rowB[x] != 0);
+            }
+        }
+        result.mismatchRatio = covered > 0 ? static_cast<double>(mismatched) / covered : 0.0;
+    }
+    
+    return result;
+}
+
+QString runBooleanBenchmarks(int iterations) {
+    struct BenchmarkCase {
+        QString name;
+        QPainterPath subject;
+        QPainterPath clip;
+    };
+    std::vector<BenchmarkCase> cases;
+    
+    // 两个相交的矩形
+    {
+        QPainterPath subject;
+        subject.addRect(0, 0, 400, 300);
+        QPainterPath clip;
+        clip.addRect(200, 150, 400, 300);
+        cases.push_back({QStringLiteral("矩形 ∩ 矩形"), subject, clip});
+    }
+    
+    // 带孔洞的圆角矩形与椭圆（曲线需要展平）
+    {
+        QPainterPath subject;
+        subject.addRoundedRect(0, 0, 600, 400, 60, 60);
+        subject.addEllipse(QPointF(300, 200), 120, 80);
+        QPainterPath clip;
+        clip.addEllipse(QPointF(450, 250), 250, 180);
+        cases.push_back({QStringLiteral("带孔圆角矩形 ∩ 椭圆"), subject, clip});
+    }
+    
+    // 高顶点数的星形，交点很多
+    {
+        const QPainterPath subject = Internal::makeStar(QPointF(300, 300), 300, 120, 500);
+        QPainterPath clip = Internal::makeStar(QPointF(360, 330), 280, 140, 377);
+        clip.setFillRule(Qt::WindingFill);
+        cases.push_back({QStringLiteral("500角星 ∩ 377角星"), subject, clip});
+    }
+    
+    QString report = QStringLiteral("用例\t扫描线(ms)\tQt(ms)\t元素数(扫描线/Qt)\t像素差异\n");
+    for (const BenchmarkCase& benchmarkCase : cases) {
+        const BooleanBenchmarkResult r = benchmarkIntersection(benchmarkCase.subject, benchmarkCase.clip, iterations);
+        const QString line = QString("%1\t%2\t%3\t%4/%5\t%6%")
+            .arg(benchmarkCase.name)
+            .arg(r.sweepMs, 0, 'f', 3)
+            .arg(r.qtMs, 0, 'f', 3)
+            .arg(r.sweepElements)
+            .arg(r.qtElements)
+            .arg(r.mismatchRatio * 100.0, 0, 'f', 3);
+        Logger::info(QString("runBooleanBenchmarks: %1").arg(line));
+        report += line + QStringLiteral("\n");
+    }
+    return report;
+}
+
+namespace Internal {
+
+// 基于Weiler-Atherton算法的路径交集，扫描线算法失败时使用
+QPainterPath weilerAthertonIntersected(const QPainterPath& subject, const QPainterPath& clip) {
+    Logger::debug("weilerAthertonIntersected: 开始计算路径交集");
+    
+    // 快速检查：如果路径为空，返回空路径
+    if (subject.isEmpty() || clip.isEmpty()) {
+        Logger::debug("weilerAthertonIntersected: 主体或裁剪路径为空，返回空路径");
+        return QPainterPath();
+    }
+    
+    // 转换为点集，用于裁剪算法
+    double flatness = 0.1; // 较小的值能获得更高的精度
+    std::vector<QPointF> subjectPoints = pathToPoints(subject, flatness);
+    std::vector<QPointF> clipPoints = pathToPoints(clip, flatness);
+    
+    Logger::debug(QString("weilerAthertonIntersected: 主体路径提取点数 %1，裁剪路径提取点数 %2")
+                 .arg(subjectPoints.size())
+                 .arg(clipPoints.size()));
+    
+    // 检查点集是否有效
+    if (subjectPoints.size() < 3 || clipPoints.size() < 3) {
+        Logger::warning("weilerAthertonIntersected: 点集合不足，无法计算交集");
+        return QPainterPath();
+    }
+    
+    // 使用Weiler-Atherton裁剪算法计算两个多边形的交集
+    std::vector<QPointF> resultPoints = weilerAthertonClip(subjectPoints, clipPoints);
+    
+    // 创建结果路径
+    QPainterPath resultPath;
+    if (resultPoints.size() >= 3) {
+        // 将点集转换为路径
+        resultPath = pointsToPath(resultPoints);
+        
+        // 使用新的验证方法检查结果
+        if (!Internal::validateIntersection(resultPath, clip)) {
+            Logger::debug("weilerAthertonIntersected: 验证失败，尝试使用栅格化方法");
+            QPainterPath rasterPath = rasterizeIntersection(subject, clip);
+            
+            if (!rasterPath.isEmpty()) {
+                resultPath = rasterPath;
+                Logger::debug(QString("weilerAthertonIntersected: 使用栅格化方法创建的路径包含 %1 个元素")
+                             .arg(resultPath.elementCount()));
+            }
+        }
+    }
+    
+    return resultPath;
+}
+
+} // namespace Internal
+
 } // namespace ClipAlgorithms 
\ No newline at end of file
@@ -82,6 +82,77 @@ QPainterPath pointsToPath(const std::vector<QPointF>& points, bool closed = true
  */
 bool isPathRectangular(const QPainterPath& path, qreal tolerance = 0.05);
 
+/**
+ * @brief 矩形与多边形的位置关系
+ */
+enum class RegionRelation {
+    Outside,  // 完全在多边形外
+    Inside,   // 完全在多边形内
+    Partial   // 与多边形的边相交，需要进一步精确判断
+};
+
+/**
+ * @brief 批量判断矩形与多边形（奇偶填充规则）的位置关系
+ * 
+ * 外层遍历多边形的边，内层以无分支的算术处理所有矩形，便于编译器向量化。
+ * 与任一条边相交（含边完全落在矩形内）的矩形为Partial；其余矩形整体位于
+ * 多边形边界的同一侧，由左上角按pointInPolygon相同的射线法判断内外。
+ * 
+ * @param polygon 多边形顶点（不含重复的闭合点）
+ * @param rects 要判断的矩形
+ * @return 与rects一一对应的位置关系
+ */
+std::vector<RegionRelation> classifyRects(const std::vector<QPointF>& polygon, const std::vector<QRectF>& rects);
+
+/**
+ * @brief 流式折线简化器
+ * 
+ * 点逐个到达时增量简化：保留上一个输出顶点到当前点的"候选线段"，
+ * 只要候选线段之间的所有输入点到该线段的距离都不超过容差就继续延长，
+ * 否则把上一个输入点固定为输出顶点并从它重新开始。
+ * 这是Douglas-Peucker距离判据的滑动窗口形式，每个被丢弃的点到输出折线的距离都不超过容差，
+ * 拐角会被保留，共线的点会被完全去除。
+ */
+class StreamingSimplifier {
+public:
+    explicit StreamingSimplifier(qreal tolerance = 1.0);
+    
+    // 设置容差（与输入点同一坐标系），只影响之后到达的点
+    void setTolerance(qreal tolerance);
+    qreal tolerance() const { return m_tolerance; }
+    
+    // 清空所有点
+    void reset();
+    
+    /**
+     * @brief 添加一个输入点
+     * @param point 新的输入点
+     * @return 是否有新的顶点被固定
+     */
+    bool addPoint(const QPointF& point);
+    
+    // 当前的简化结果：已固定的顶点加上最后一个输入点
+    std::vector<QPointF> points() const;
+    
+    // 已固定的顶点数
+    size_t vertexCount() const { return m_vertices.size(); }
+    
+    // 已接收的输入点数
+    size_t inputCount() const { return m_inputCount; }
+    
+private:
+    // 候选窗口过长时强制固定顶点，限制单点的最坏开销
+    static const size_t MAX_PENDING_POINTS = 256;
+    
+    qreal m_tolerance;
+    size_t m_inputCount = 0;
+    std::vector<QPointF> m_vertices;   // 已固定的输出顶点
+    std::vector<QPointF> m_pending;    // 最后一个顶点之后尚未决定的输入点
+    
+    // 判断窗口内所有点是否都在从最后一个顶点到end的线段容差范围内
+    bool pendingFitsSegment(const QPointF& end) const;
+};
+
 /**
  * @brief 裁剪线段
  * 
@@ -100,6 +171,87 @@ enum class ClipEdge {
     Top = 3
 };
 
+/**
+ * @brief 多边形布尔运算类型
+ */
+enum class BooleanOperation {
+    Intersection,  // 交集
+    Union,         // 并集
+    Difference     // 差集（主体减去裁剪）
+};
+
+/**
+ * @brief 将路径展平为多边形轮廓，曲线按容差自适应细分
+ * 
+ * @param path 要展平的路径
+ * @param tolerance 曲线到折线的最大允许偏差
+ * @return 各子路径对应的轮廓（不含重复的闭合点）
+ */
+std::vector<std::vector<QPointF>> flattenPath(const QPainterPath& path, qreal tolerance = 0.1);
+
+/**
+ * @brief 精确的扫描线多边形布尔运算（支持多轮廓和孔洞）
+ * 
+ * 坐标取整到1/256像素的定点网格后，先用扫描线找出并分割所有交点，
+ * 再按字典序扫描推出每条边两侧的环绕数，保留两侧结果不同的边并连接成轮廓。
+ * 
+ * @param subject 主体多边形轮廓
+ * @param subjectRule 主体的填充规则
+ * @param clip 裁剪多边形轮廓
+ * @param clipRule 裁剪多边形的填充规则
+ * @param op 布尔运算类型
+ * @param ok 输出是否成功（坐标超出定点范围时失败）
+ * @return 结果轮廓，内部位于边的左侧，孔洞与外轮廓方向相反
+ */
+std::vector<std::vector<QPointF>> polygonBoolean(const std::vector<std::vector<QPointF>>& subject,
+                                                 Qt::FillRule subjectRule,
+                                                 const std::vector<std::vector<QPointF>>& clip,
+                                                 Qt::FillRule clipRule,
+                                                 BooleanOperation op,
+                                                 bool* ok = nullptr);
+
+/**
+ * @brief 对两个路径做布尔运算，扫描线算法失败时回退到QPainterPath的实现
+ * 
+ * @param subject 主体路径
+ * @param clip 裁剪路径
+ * @param op 布尔运算类型
+ * @param tolerance 曲线展平容差
+ * @return 运算结果路径（非零环绕填充规则）
+ */
+QPainterPath booleanOperation(const QPainterPath& subject, const QPainterPath& clip,
+                              BooleanOperation op, qreal tolerance = 0.1);
+
+/**
+ * @brief 交集运算基准测试的结果
+ */
+struct BooleanBenchmarkResult {
+    double sweepMs = 0.0;         // 扫描线算法单次运算的平均耗时（毫秒）
+    double qtMs = 0.0;            // QPainterPath::intersected单次运算的平均耗时（毫秒）
+    int sweepElements = 0;        // 扫描线结果路径的元素数量
+    int qtElements = 0;           // Qt结果路径的元素数量
+    double mismatchRatio = 0.0;   // 两种结果栅格化后不一致的像素占Qt结果像素的比例
+};
+
+/**
+ * @brief 对比扫描线交集与QPainterPath::intersected的耗时和结果
+ * 
+ * @param subject 主体路径
+ * @param clip 裁剪路径
+ * @param iterations 每种算法的重复次数
+ * @return 基准测试结果
+ */
+BooleanBenchmarkResult benchmarkIntersection(const QPainterPath& subject, const QPainterPath& clip,
+                                             int iterations = 20);
+
+/**
+ * @brief 在一组典型路径上运行交集基准测试（多边形、带孔洞的曲线路径、高顶点数星形）
+ * 
+ * @param iterations 每个用例的重复次数
+ * @return 可读的测试报告，同时写入日志
+ */
+QString runBooleanBenchmarks(int iterations = 20);
+
 // 内部使用的辅助函数
 namespace Internal {
     // Sutherland-Hodgman算法中处理单条边的裁剪
@@ -121,6 +273,13 @@ namespace Internal {
     
     // 检查点是否在多边形内部
     bool pointInPolygon(const QPointF& point, const std::vector<QPointF>& polygon);
+    
+    // 扫描线布尔运算的路径版本，失败时ok为false
+    QPainterPath sweepBooleanPath(const QPainterPath& subject, const QPainterPath& clip,
+                                  BooleanOperation op, qreal tolerance, bool* ok);
+    
+    // 基于Weiler-Atherton算法的路径交集，扫描线算法失败时使用
+    QPainterPath weilerAthertonIntersected(const QPainterPath& subject, const QPainterPath& clip);
 }
 
 }
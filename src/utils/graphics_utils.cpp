@@ -2,6 +2,14 @@
 #include "logger.h"
 #include <QPainter>
 #include <QRect>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 QImage GraphicsUtils::renderSceneToImage(QGraphicsScene* scene, bool disableAntialiasing) {
     if (!scene) return QImage();
@@ -81,58 +89,99 @@ QImage GraphicsUtils::renderSceneRectToImage(QGraphicsScene* scene, const QRectF
     return image;
 }
 
+// 将颜色转换为指定32位图像格式下的像素值
+static quint32 colorToPixel(const QColor& color, QImage::Format format) {
+    switch (format) {
+        case QImage::Format_ARGB32_Premultiplied:
+            return qPremultiply(color.rgba());
+        case QImage::Format_RGB32:
+            return 0xff000000u | color.rgb();
+        default:
+            return color.rgba();
+    }
+}
+
 int GraphicsUtils::fillImageRegion(QImage& image, const QPoint& seedPoint, 
-                                 const QColor& targetColor, const QColor& fillColor) {
+                                 const QColor& targetColor, const QColor& fillColor,
+                                 const std::atomic<bool>* cancelFlag,
+                                 QRect* filledBounds) {
     if (image.isNull() || !isPointInImageBounds(seedPoint, image.width(), image.height())) {
         qDebug() << "GraphicsUtils: 填充点不在有效图像范围内";
         return 0;
     }
     
+    // 扫描线直接按32位像素访问
+    if (image.format() != QImage::Format_ARGB32 &&
+        image.format() != QImage::Format_ARGB32_Premultiplied &&
+        image.format() != QImage::Format_RGB32) {
+        image = image.convertToFormat(QImage::Format_ARGB32);
+    }
+    
+    const quint32 target = colorToPixel(targetColor, image.format());
+    const quint32 fill = colorToPixel(fillColor, image.format());
+    
     // 如果目标颜色和填充颜色相同，则无需填充
-    if (targetColor == fillColor) {
+    if (target == fill) {
         qDebug() << "GraphicsUtils: 目标颜色与填充颜色相同，无需填充";
         return 0;
     }
     
     // 确保种子点的颜色与目标颜色匹配
-    QColor seedColor = image.pixelColor(seedPoint);
-    if (seedColor != targetColor) {
+    if (reinterpret_cast<const quint32*>(image.constScanLine(seedPoint.y()))[seedPoint.x()] != target) {
         qDebug() << "GraphicsUtils: 种子点颜色与目标颜色不匹配";
         return 0;
     }
     
-    // 使用扫描线算法优化填充
-    QStack<QPoint> stack;
-    stack.push(seedPoint);
-    
-    int width = image.width();
-    int height = image.height();
-    QVector<QVector<bool>> visited(width, QVector<bool>(height, false));
+    const int width = image.width();
+    const int height = image.height();
+    
+    // 按位压缩的访问标记，每个像素1位
+    const qsizetype bitCount = static_cast<qsizetype>(width) * height;
+    std::vector<quint64> visited(static_cast<size_t>((bitCount + 63) / 64), 0);
+    auto isVisited = [&visited, width](int x, int y) {
+        const qsizetype bit = static_cast<qsizetype>(y) * width + x;
+        return ((visited[bit >> 6] >> (bit & 63)) & 1u) != 0;
+    };
+    auto markVisited = [&visited, width](int x, int y) {
+        const qsizetype bit = static_cast<qsizetype>(y) * width + x;
+        visited[bit >> 6] |= quint64(1) << (bit & 63);
+    };
+    
+    // 种子栈：每个种子代表相邻行中一段待填充区间的起点
+    std::vector<QPoint> stack;
+    stack.push_back(seedPoint);
     
     int filledPixels = 0;
+    int spanCount = 0;
     
     // 记录填充区域的边界
     int minX = width, maxX = 0, minY = height, maxY = 0;
     
-    while (!stack.isEmpty()) {
-        QPoint current = stack.pop();
-        int x = current.x();
-        int y = current.y();
+    while (!stack.empty()) {
+        const QPoint current = stack.back();
+        stack.pop_back();
         
-        // 如果已访问或不是目标颜色，则跳过
-        if (visited[x][y] || image.pixelColor(x, y) != targetColor) {
+        // 每处理一批区间检查一次取消标志
+        if (cancelFlag && (++spanCount & 1023) == 0 && cancelFlag->load(std::memory_order_relaxed)) {
+            qDebug() << "GraphicsUtils: 填充已取消";
+            return 0;
+        }
+        
+        const int x = current.x();
+        const int y = current.y();
+        
+        quint32* row = reinterpret_cast<quint32*>(image.scanLine(y));
+        if (row[x] != target || isVisited(x, y)) {
             continue;
         }
         
-        // 查找当前扫描线的最左边界
+        // 向左右扩展出整段区间
         int left = x;
-        while (left > 0 && image.pixelColor(left - 1, y) == targetColor && !visited[left - 1][y]) {
+        while (left > 0 && row[left - 1] == target && !isVisited(left - 1, y)) {
             left--;
         }
-        
-        // 查找当前扫描线的最右边界
         int right = x;
-        while (right < width - 1 && image.pixelColor(right + 1, y) == targetColor && !visited[right + 1][y]) {
+        while (right < width - 1 && row[right + 1] == target && !isVisited(right + 1, y)) {
             right++;
         }
         
@@ -142,39 +191,26 @@ int GraphicsUtils::fillImageRegion(QImage& image, const QPoint& seedPoint,
         minY = qMin(minY, y);
         maxY = qMax(maxY, y);
         
-        // 填充当前扫描线
-        bool spanAbove = false;
-        bool spanBelow = false;
-        
+        // 填充当前区间
         for (int i = left; i <= right; i++) {
-            visited[i][y] = true;
-            image.setPixelColor(i, y, fillColor);
-            filledPixels++;
-            
-            // 检查上一行
-            if (y > 0) {
-                QColor aboveColor = image.pixelColor(i, y - 1);
-                bool aboveMatch = aboveColor == targetColor && !visited[i][y-1];
-                
-                if (!spanAbove && aboveMatch) {
-                    stack.push(QPoint(i, y - 1));
-                    spanAbove = true;
-                } else if (spanAbove && !aboveMatch) {
-                    spanAbove = false;
-                }
+            row[i] = fill;
+            markVisited(i, y);
+        }
+        filledPixels += right - left + 1;
+        
+        // 在上下两行的同一区间内，每段连续的可填充像素压入一个种子
+        for (int ny : {y - 1, y + 1}) {
+            if (ny < 0 || ny >= height) {
+                continue;
             }
-            
-            // 检查下一行
-            if (y < height - 1) {
-                QColor belowColor = image.pixelColor(i, y + 1);
-                bool belowMatch = belowColor == targetColor && !visited[i][y+1];
-                
-                if (!spanBelow && belowMatch) {
-                    stack.push(QPoint(i, y + 1));
-                    spanBelow = true;
-                } else if (spanBelow && !belowMatch) {
-                    spanBelow = false;
+            const quint32* neighbor = reinterpret_cast<const quint32*>(image.constScanLine(ny));
+            bool inSpan = false;
+            for (int i = left; i <= right; i++) {
+                const bool match = neighbor[i] == target && !isVisited(i, ny);
+                if (match && !inSpan) {
+                    stack.push_back(QPoint(i, ny));
                 }
+                inSpan = match;
             }
         }
     }
@@ -182,6 +218,9 @@ int GraphicsUtils::fillImageRegion(QImage& image, const QPoint& seedPoint,
     if (filledPixels > 0) {
         // 记录填充区域大小
         logFillAreaStats(filledPixels, minX, minY, maxX, maxY);
+        if (filledBounds) {
+            *filledBounds = QRect(QPoint(minX, minY), QPoint(maxX, maxY));
+        }
     }
     
     qDebug() << "GraphicsUtils: 填充完成 - 已填充" << filledPixels << "个像素";
@@ -193,28 +232,54 @@ double GraphicsUtils::calculateFillRatio(int filledPixels, int width, int height
     return static_cast<double>(filledPixels) / (width * height);
 }
 
-QImage GraphicsUtils::createFillResultLayer(const QImage& originalImage, 
-                                         const QImage& filledImage, 
-                                         const QColor& fillColor) {
-    if (originalImage.isNull() || filledImage.isNull() || 
-        originalImage.size() != filledImage.size()) {
-        return QImage();
+// 从from开始查找第一个“两行像素是否相等”与wantEqual一致的位置，找不到时返回count
+// 先按4/8个像素一组比较，跳过整组一致的像素，再逐个定位组内的准确位置
+static int findRunBoundary(const quint32* a, const quint32* b, int from, int count, bool wantEqual) {
+    int i = from;
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8) {
+        const __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        const unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        if (wantEqual ? bits != 0u : bits != 0xFFFFFFFFu) {
+            break;
+        }
     }
-    
-    QImage resultImage(originalImage.size(), QImage::Format_ARGB32);
-    resultImage.fill(Qt::transparent);
-    
-    // 只复制被填充的像素
-    for (int y = 0; y < originalImage.height(); y++) {
-        for (int x = 0; x < originalImage.width(); x++) {
-            if (filledImage.pixelColor(x, y) == fillColor &&
-                originalImage.pixelColor(x, y) != fillColor) {
-                resultImage.setPixelColor(x, y, fillColor);
-            }
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    for (; i + 4 <= count; i += 4) {
+        const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        const int bits = _mm_movemask_epi8(eq);
+        if (wantEqual ? bits != 0 : bits != 0xFFFF) {
+            break;
         }
     }
-    
-    return resultImage;
+#endif
+    // 标量定位组内的位置，并处理剩余像素（或不支持SIMD的平台）
+    for (; i < count; ++i) {
+        if ((a[i] == b[i]) == wantEqual) {
+            return i;
+        }
+    }
+    return count;
+}
+
+int GraphicsUtils::appendDiffRuns(const quint32* a, const quint32* b, int count, std::vector<qint32>& runs) {
+    int pixels = 0;
+    int x = 0;
+    while (x < count) {
+        const int start = findRunBoundary(a, b, x, count, false);
+        if (start >= count) {
+            break;
+        }
+        const int end = findRunBoundary(a, b, start + 1, count, true);
+        runs.push_back(start);
+        runs.push_back(end - start);
+        pixels += end - start;
+        x = end;
+    }
+    return pixels;
 }
 
 bool GraphicsUtils::isPointInImageBounds(const QPoint& point, int width, int height) {
@@ -11,6 +11,8 @@
 #include <QDebug>
 #include <QStack>
 #include <QVector>
+#include <atomic>
+#include <vector>
 
 /**
  * @brief 提供通用图形和图像处理工具的静态类
@@ -56,10 +58,14 @@ public:
      * @param seedPoint 种子点（开始填充的位置）
      * @param targetColor 目标颜色（要替换的颜色）
      * @param fillColor 填充颜色
+     * @param cancelFlag 取消标志（可选），置位后中止填充并返回0
+     * @param filledBounds 输出填充区域的包围盒（可选）
      * @return 填充的像素数量
      */
     static int fillImageRegion(QImage& image, const QPoint& seedPoint, 
-                             const QColor& targetColor, const QColor& fillColor);
+                             const QColor& targetColor, const QColor& fillColor,
+                             const std::atomic<bool>* cancelFlag = nullptr,
+                             QRect* filledBounds = nullptr);
     
     /**
      * @brief 计算图像中填充区域占总图像的比例
@@ -71,15 +77,14 @@ public:
     static double calculateFillRatio(int filledPixels, int width, int height);
     
     /**
-     * @brief 从填充后的图像创建填充结果图层
-     * @param originalImage 原始图像
-     * @param filledImage 填充后的图像
-     * @param fillColor 填充颜色
-     * @return 只包含填充部分的图像
+     * @brief 比较两行32位像素，将不同像素组成的连续段以(起点, 长度)追加到runs
+     * @param a 第一行像素
+     * @param b 第二行像素
+     * @param count 像素数量
+     * @param runs 输出的行程，起点相对于行首
+     * @return 不同像素的数量
      */
-    static QImage createFillResultLayer(const QImage& originalImage, 
-                                      const QImage& filledImage, 
-                                      const QColor& fillColor);
+    static int appendDiffRuns(const quint32* a, const quint32* b, int count, std::vector<qint32>& runs);
     
     /**
      * @brief 检查点是否在图像有效范围内
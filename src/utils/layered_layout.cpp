@@ -0,0 +1,507 @@
+#include "layered_layout.h"
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <random>
+
+namespace {
+
+// 分层图：原始节点在前，虚拟节点在后；边只连接相邻两层
+struct LayeredGraph {
+    int nodeCount = 0;                  // 原始节点数
+    std::vector<int> layer;
+    std::vector<qreal> width;
+    std::vector<qreal> height;
+    std::vector<char> dummy;
+    std::vector<int> upStart, up;       // 上一层的邻居（CSR）
+    std::vector<int> downStart, down;   // 下一层的邻居（CSR）
+    std::vector<std::vector<int>> layers;
+
+    int size() const { return static_cast<int>(layer.size()); }
+};
+
+struct Ordering {
+    std::vector<std::vector<int>> layers;
+    qint64 crossings = std::numeric_limits<qint64>::max();
+};
+
+// 由边表构造CSR邻接表
+void buildAdjacency(int count, const std::vector<std::pair<int, int>>& links,
+                    bool reverse, std::vector<int>& start, std::vector<int>& targets)
+{
+    start.assign(count + 1, 0);
+    for (const auto& link : links) {
+        ++start[(reverse ? link.second : link.first) + 1];
+    }
+    for (int i = 0; i < count; ++i) {
+        start[i + 1] += start[i];
+    }
+    targets.resize(links.size());
+    std::vector<int> fill(start.begin(), start.end() - 1);
+    for (const auto& link : links) {
+        const int from = reverse ? link.second : link.first;
+        targets[fill[from]++] = reverse ? link.first : link.second;
+    }
+}
+
+// 在全局线程池中并行执行fn(0)..fn(count - 1)，调用线程也参与执行；线程池繁忙时退化为串行
+template<typename Fn>
+void parallelFor(int count, Fn fn)
+{
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    QThreadPool* pool = QThreadPool::globalInstance();
+    QSemaphore finished;
+    int started = 0;
+    for (int t = 1; t < count; ++t) {
+        if (!pool->tryStart([&]() { worker(); finished.release(); })) {
+            break;
+        }
+        ++started;
+    }
+    worker();
+    finished.acquire(started);
+}
+
+// 迭代DFS，把指向栈中节点的回边反转，得到无环的边集
+std::vector<std::pair<int, int>> breakCycles(int count, const std::vector<std::pair<int, int>>& edges,
+                                             int& reversedCount)
+{
+    std::vector<int> start, targets;
+    buildAdjacency(count, edges, false, start, targets);
+
+    // 按CSR中的顺序记录每条出边是否为回边
+    std::vector<char> reversed(targets.size(), 0);
+    std::vector<char> state(count, 0);  // 0 未访问，1 在栈中，2 已完成
+    std::vector<std::pair<int, int>> stack;  // （节点，下一条出边）
+    for (int root = 0; root < count; ++root) {
+        if (state[root]) {
+            continue;
+        }
+        state[root] = 1;
+        stack.push_back({root, start[root]});
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            const int node = top.first;
+            if (top.second == start[node + 1]) {
+                state[node] = 2;
+                stack.pop_back();
+                continue;
+            }
+            const int e = top.second++;
+            const int target = targets[e];
+            if (state[target] == 1) {
+                reversed[e] = 1;
+            } else if (state[target] == 0) {
+                state[target] = 1;
+                stack.push_back({target, start[target]});
+            }
+        }
+    }
+
+    std::vector<std::pair<int, int>> dag;
+    dag.reserve(targets.size());
+    reversedCount = 0;
+    for (int node = 0; node < count; ++node) {
+        for (int e = start[node]; e < start[node + 1]; ++e) {
+            if (reversed[e]) {
+                dag.push_back({targets[e], node});
+                ++reversedCount;
+            } else {
+                dag.push_back({node, targets[e]});
+            }
+        }
+    }
+    return dag;
+}
+
+// 最长路径分层，再把只有出边的源节点下拉到紧贴其后继的层
+std::vector<int> assignLayers(int count, const std::vector<std::pair<int, int>>& dag)
+{
+    std::vector<int> start, targets;
+    buildAdjacency(count, dag, false, start, targets);
+
+    std::vector<int> indegree(count, 0);
+    for (const auto& edge : dag) {
+        ++indegree[edge.second];
+    }
+    const std::vector<int> originalIndegree = indegree;
+
+    std::vector<int> order;
+    order.reserve(count);
+    for (int node = 0; node < count; ++node) {
+        if (indegree[node] == 0) {
+            order.push_back(node);
+        }
+    }
+    std::vector<int> layer(count, 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        const int node = order[i];
+        for (int e = start[node]; e < start[node + 1]; ++e) {
+            const int target = targets[e];
+            layer[target] = std::max(layer[target], layer[node] + 1);
+            if (--indegree[target] == 0) {
+                order.push_back(target);
+            }
+        }
+    }
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const int node = *it;
+        if (originalIndegree[node] != 0 || start[node] == start[node + 1]) {
+            continue;
+        }
+        int nearest = std::numeric_limits<int>::max();
+        for (int e = start[node]; e < start[node + 1]; ++e) {
+            nearest = std::min(nearest, layer[targets[e]]);
+        }
+        layer[node] = nearest - 1;
+    }
+
+    const int minLayer = count > 0 ? *std::min_element(layer.begin(), layer.end()) : 0;
+    for (int& l : layer) {
+        l -= minLayer;
+    }
+    return layer;
+}
+
+// 为跨越多层的边插入虚拟节点，建立只连接相邻层的分层图
+LayeredGraph buildLayeredGraph(const std::vector<QSizeF>& sizes, const std::vector<std::pair<int, int>>& dag,
+                               const std::vector<int>& layer)
+{
+    LayeredGraph graph;
+    graph.nodeCount = static_cast<int>(sizes.size());
+    graph.layer = layer;
+    graph.dummy.assign(graph.nodeCount, 0);
+    graph.width.reserve(sizes.size());
+    graph.height.reserve(sizes.size());
+    for (const QSizeF& size : sizes) {
+        graph.width.push_back(size.width());
+        graph.height.push_back(size.height());
+    }
+
+    std::vector<std::pair<int, int>> links;
+    links.reserve(dag.size());
+    for (const auto& edge : dag) {
+        int previous = edge.first;
+        for (int l = layer[edge.first] + 1; l < layer[edge.second]; ++l) {
+            const int dummy = graph.size();
+            graph.layer.push_back(l);
+            graph.width.push_back(0.0);
+            graph.height.push_back(0.0);
+            graph.dummy.push_back(1);
+            links.push_back({previous, dummy});
+            previous = dummy;
+        }
+        links.push_back({previous, edge.second});
+    }
+
+    buildAdjacency(graph.size(), links, false, graph.downStart, graph.down);
+    buildAdjacency(graph.size(), links, true, graph.upStart, graph.up);
+
+    const int layerCount = graph.size() > 0 ? *std::max_element(graph.layer.begin(), graph.layer.end()) + 1 : 0;
+    graph.layers.resize(layerCount);
+    for (int node = 0; node < graph.size(); ++node) {
+        graph.layers[graph.layer[node]].push_back(node);
+    }
+    return graph;
+}
+
+// 两层之间的交叉数：按上层顺序依次插入下层端点位置，用树状数组统计位置更靠右的已插入端点
+qint64 countCrossings(const LayeredGraph& graph, const std::vector<int>& upper, int lowerSize,
+                      const std::vector<int>& pos, std::vector<int>& tree, std::vector<int>& scratch)
+{
+    tree.assign(lowerSize + 1, 0);
+    qint64 crossings = 0;
+    qint64 inserted = 0;
+    for (int node : upper) {
+        scratch.assign(graph.down.begin() + graph.downStart[node], graph.down.begin() + graph.downStart[node + 1]);
+        for (int& target : scratch) {
+            target = pos[target];
+        }
+        std::sort(scratch.begin(), scratch.end());
+        for (int p : scratch) {
+            qint64 notGreater = 0;
+            for (int i = p + 1; i > 0; i -= i & -i) {
+                notGreater += tree[i];
+            }
+            crossings += inserted - notGreater;
+            for (int i = p + 1; i <= lowerSize; i += i & -i) {
+                ++tree[i];
+            }
+            ++inserted;
+        }
+    }
+    return crossings;
+}
+
+// 从一组初始顺序出发，交替向下/向上按邻居平均位置（重心）排序各层
+Ordering minimizeCrossings(const LayeredGraph& graph, int variant, int sweeps)
+{
+    Ordering ordering;
+    ordering.layers = graph.layers;
+    std::vector<std::vector<int>>& layers = ordering.layers;
+    const int layerCount = static_cast<int>(layers.size());
+
+    // 前两组保留输入顺序，分别先向下和先向上扫描；其余各组打乱初始顺序
+    if (variant >= 2) {
+        std::mt19937 random(static_cast<unsigned>(variant));
+        for (auto& layer : layers) {
+            std::shuffle(layer.begin(), layer.end(), random);
+        }
+    }
+
+    std::vector<int> pos(graph.size(), 0);
+    auto updatePositions = [&](const std::vector<int>& layer) {
+        for (int i = 0; i < static_cast<int>(layer.size()); ++i) {
+            pos[layer[i]] = i;
+        }
+    };
+    for (const auto& layer : layers) {
+        updatePositions(layer);
+    }
+
+    std::vector<int> tree, scratch;
+    auto totalCrossings = [&]() {
+        qint64 total = 0;
+        for (int l = 0; l + 1 < layerCount; ++l) {
+            total += countCrossings(graph, layers[l], static_cast<int>(layers[l + 1].size()), pos, tree, scratch);
+        }
+        return total;
+    };
+
+    std::vector<std::pair<double, int>> keys;
+    auto sortLayer = [&](std::vector<int>& layer, bool useUpper) {
+        const std::vector<int>& start = useUpper ? graph.upStart : graph.downStart;
+        const std::vector<int>& neighbors = useUpper ? graph.up : graph.down;
+        keys.clear();
+        for (int node : layer) {
+            const int first = start[node];
+            const int last = start[node + 1];
+            // 没有邻居的节点保持原位
+            double key = pos[node];
+            if (first < last) {
+                double sum = 0.0;
+                for (int e = first; e < last; ++e) {
+                    sum += pos[neighbors[e]];
+                }
+                key = sum / (last - first);
+            }
+            keys.push_back({key, node});
+        }
+        std::stable_sort(keys.begin(), keys.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (size_t i = 0; i < keys.size(); ++i) {
+            layer[i] = keys[i].second;
+        }
+        updatePositions(layer);
+    };
+
+    ordering.crossings = totalCrossings();
+    std::vector<std::vector<int>> best = layers;
+    int staleSweeps = 0;
+    for (int sweep = 0; sweep < sweeps && ordering.crossings > 0; ++sweep) {
+        if ((sweep + variant) % 2 == 0) {
+            for (int l = 1; l < layerCount; ++l) {
+                sortLayer(layers[l], true);
+            }
+        } else {
+            for (int l = layerCount - 2; l >= 0; --l) {
+                sortLayer(layers[l], false);
+            }
+        }
+
+        const qint64 crossings = totalCrossings();
+        if (crossings < ordering.crossings) {
+            ordering.crossings = crossings;
+            best = layers;
+            staleSweeps = 0;
+        } else if (++staleSweeps >= 3) {
+            break;
+        }
+    }
+
+    layers.swap(best);
+    return ordering;
+}
+
+// 在x[i + 1] - x[i] >= gaps[i]的约束下最小化Σ(x[i] - desired[i])²：
+// 令x[i] = y[i] + offset[i]后约束变为y单调不减，用相邻违例合并（PAV）求解
+void placeLayer(const std::vector<qreal>& desired, const std::vector<qreal>& gaps, std::vector<qreal>& result)
+{
+    const size_t count = desired.size();
+    std::vector<qreal> offsets(count, 0.0);
+    for (size_t i = 1; i < count; ++i) {
+        offsets[i] = offsets[i - 1] + gaps[i - 1];
+    }
+
+    struct Block {
+        qreal sum;
+        int count;
+    };
+    std::vector<Block> blocks;
+    blocks.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        blocks.push_back({desired[i] - offsets[i], 1});
+        while (blocks.size() >= 2) {
+            const Block& last = blocks[blocks.size() - 1];
+            const Block& previous = blocks[blocks.size() - 2];
+            if (previous.sum * last.count <= last.sum * previous.count) {
+                break;
+            }
+            const Block merged{previous.sum + last.sum, previous.count + last.count};
+            blocks.pop_back();
+            blocks.back() = merged;
+        }
+    }
+
+    result.resize(count);
+    size_t index = 0;
+    for (const Block& block : blocks) {
+        const qreal mean = block.sum / block.count;
+        for (int i = 0; i < block.count; ++i, ++index) {
+            result[index] = mean + offsets[index];
+        }
+    }
+}
+
+// 横坐标：先紧凑排列并居中，再交替按上一层/下一层邻居的中位数对齐
+std::vector<qreal> assignX(const LayeredGraph& graph, const std::vector<std::vector<int>>& layers,
+                           const LayeredLayout::Options& options)
+{
+    std::vector<qreal> x(graph.size(), 0.0);
+    std::vector<std::vector<qreal>> gaps(layers.size());
+    for (size_t l = 0; l < layers.size(); ++l) {
+        const std::vector<int>& layer = layers[l];
+        for (size_t i = 1; i < layer.size(); ++i) {
+            const int a = layer[i - 1];
+            const int b = layer[i];
+            // 虚拟节点之间只保留一半间距，长边可以靠得更近
+            const qreal spacing = (graph.dummy[a] || graph.dummy[b]) ? options.nodeSpacing / 2 : options.nodeSpacing;
+            gaps[l].push_back((graph.width[a] + graph.width[b]) / 2 + spacing);
+        }
+        qreal position = 0.0;
+        for (size_t i = 0; i < layer.size(); ++i) {
+            if (i > 0) {
+                position += gaps[l][i - 1];
+            }
+            x[layer[i]] = position;
+        }
+        const qreal shift = layer.empty() ? 0.0 : position / 2;
+        for (int node : layer) {
+            x[node] -= shift;
+        }
+    }
+
+    std::vector<qreal> desired, placed, values;
+    auto alignLayer = [&](size_t l, bool useUpper) {
+        const std::vector<int>& layer = layers[l];
+        const std::vector<int>& start = useUpper ? graph.upStart : graph.downStart;
+        const std::vector<int>& neighbors = useUpper ? graph.up : graph.down;
+        desired.clear();
+        for (int node : layer) {
+            values.clear();
+            for (int e = start[node]; e < start[node + 1]; ++e) {
+                values.push_back(x[neighbors[e]]);
+            }
+            if (values.empty()) {
+                desired.push_back(x[node]);
+                continue;
+            }
+            std::sort(values.begin(), values.end());
+            const size_t mid = values.size() / 2;
+            desired.push_back(values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2);
+        }
+        placeLayer(desired, gaps[l], placed);
+        for (size_t i = 0; i < layer.size(); ++i) {
+            x[layer[i]] = placed[i];
+        }
+    };
+
+    for (int pass = 0; pass < options.alignPasses; ++pass) {
+        if (pass % 2 == 0) {
+            for (size_t l = 1; l < layers.size(); ++l) {
+                alignLayer(l, true);
+            }
+        } else {
+            for (size_t l = layers.size() - 1; l-- > 0;) {
+                alignLayer(l, false);
+            }
+        }
+    }
+    return x;
+}
+
+} // namespace
+
+LayeredLayout::Result LayeredLayout::compute(const std::vector<QSizeF>& sizes,
+                                             const std::vector<std::pair<int, int>>& edges,
+                                             const Options& options)
+{
+    Result result;
+    const int count = static_cast<int>(sizes.size());
+    if (count == 0) {
+        return result;
+    }
+
+    std::vector<std::pair<int, int>> validEdges;
+    validEdges.reserve(edges.size());
+    for (const auto& edge : edges) {
+        if (edge.first != edge.second && edge.first >= 0 && edge.first < count &&
+            edge.second >= 0 && edge.second < count) {
+            validEdges.push_back(edge);
+        }
+    }
+
+    // 1. 消除环  2. 分层  3. 插入虚拟节点
+    const std::vector<std::pair<int, int>> dag = breakCycles(count, validEdges, result.reversedEdges);
+    const LayeredGraph graph = buildLayeredGraph(sizes, dag, assignLayers(count, dag));
+    result.layerCount = static_cast<int>(graph.layers.size());
+    result.dummyNodes = graph.size() - count;
+
+    // 4. 多组初始顺序并行排序，取交叉最少的一组（交叉数相同时取编号小的，结果与线程调度无关）
+    const int orderingCount = options.orderings > 0 ? options.orderings
+                                                    : qBound(2, QThread::idealThreadCount(), 8);
+    std::vector<Ordering> orderings(orderingCount);
+    parallelFor(orderingCount, [&](int variant) {
+        orderings[variant] = minimizeCrossings(graph, variant, options.sweeps);
+    });
+    int bestVariant = 0;
+    for (int variant = 1; variant < orderingCount; ++variant) {
+        if (orderings[variant].crossings < orderings[bestVariant].crossings) {
+            bestVariant = variant;
+        }
+    }
+    const std::vector<std::vector<int>>& layers = orderings[bestVariant].layers;
+    result.crossings = orderings[bestVariant].crossings;
+
+    // 5. 坐标：每层的高度取该层最高的节点，节点在层内垂直居中
+    const std::vector<qreal> x = assignX(graph, layers, options);
+    std::vector<qreal> layerCenter(layers.size(), 0.0);
+    qreal top = 0.0;
+    for (size_t l = 0; l < layers.size(); ++l) {
+        qreal layerHeight = 0.0;
+        for (int node : layers[l]) {
+            layerHeight = std::max(layerHeight, graph.height[node]);
+        }
+        layerCenter[l] = top + layerHeight / 2;
+        top += layerHeight + options.layerSpacing;
+    }
+
+    qreal left = std::numeric_limits<qreal>::max();
+    for (int node = 0; node < count; ++node) {
+        left = std::min(left, x[node] - graph.width[node] / 2);
+    }
+    result.centers.reserve(count);
+    for (int node = 0; node < count; ++node) {
+        result.centers.push_back(QPointF(x[node] - left, layerCenter[graph.layer[node]]));
+    }
+    return result;
+}
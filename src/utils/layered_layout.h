@@ -0,0 +1,48 @@
+#ifndef LAYERED_LAYOUT_H
+#define LAYERED_LAYOUT_H
+
+#include <QPointF>
+#include <QSizeF>
+#include <QtGlobal>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 分层（Sugiyama）图布局
+ *
+ * 依次执行：反转DFS回边消除环、最长路径分层、为跨层边插入虚拟节点、
+ * 重心法逐层排序减少交叉（多组初始顺序在全局线程池中并行计算，取交叉最少的结果）、
+ * 按层确定纵坐标，并在保持层内顺序和间距的约束下用保序回归求横坐标，使边尽量竖直。
+ * 只处理节点尺寸和边的索引，不访问场景，可在任意线程调用。
+ */
+class LayeredLayout {
+public:
+    struct Options {
+        qreal layerSpacing = 60.0;   // 相邻两层之间的垂直间距
+        qreal nodeSpacing = 40.0;    // 同层相邻节点之间的水平间距
+        int sweeps = 16;             // 每组排序最多进行的上下扫描次数
+        int orderings = 0;           // 并行尝试的初始顺序数，0表示按CPU核数确定
+        int alignPasses = 8;         // 横坐标对齐的迭代次数
+    };
+
+    struct Result {
+        std::vector<QPointF> centers;  // 各节点中心，布局左上角为原点
+        int layerCount = 0;
+        qint64 crossings = 0;          // 相邻层之间的边交叉数（含虚拟节点拆分后的边）
+        int reversedEdges = 0;         // 为消除环而反转的边数
+        int dummyNodes = 0;            // 跨层边插入的虚拟节点数
+    };
+
+    /**
+     * @brief 计算分层布局
+     * @param sizes 各节点的尺寸
+     * @param edges 有向边（起点索引，终点索引），自环和越界的边会被忽略
+     * @param options 布局参数
+     * @return 各节点的中心位置及统计信息
+     */
+    static Result compute(const std::vector<QSizeF>& sizes,
+                          const std::vector<std::pair<int, int>>& edges,
+                          const Options& options);
+};
+
+#endif // LAYERED_LAYOUT_H
@@ -1,4 +1,5 @@
 #include "scene_utils.h"
+#include "../command/command_manager.h"
 
 void SceneUtils::clearScene(QGraphicsScene* scene,
                           QGraphicsView* view,
@@ -32,6 +33,9 @@ void SceneUtils::clearScene(QGraphicsScene* scene,
         connectionOverlay->clearHighlight();
     }
 
+    // 命令栈中的命令持有场景图形项的指针，清空场景后这些命令都无法再撤销/重做
+    CommandManager::getInstance().clear();
+
     // 清空场景中的所有其他图形项
     if (scene) {
         int itemCount = scene->items().count();
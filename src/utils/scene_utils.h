@@ -11,7 +11,7 @@
 class SceneUtils {
 public:
     /**
-     * @brief 清空场景中的所有图形项，同时保持连接点覆盖层的状态
+     * @brief 清空场景中的所有图形项，同时保持连接点覆盖层的状态，并清空撤销/重做历史
      * @param scene 要清空的场景
      * @param view 关联的视图
      * @param connectionManager 连接管理器
@@ -0,0 +1,308 @@
+#include "tiff_stream_writer.h"
+#include "logger.h"
+
+// TIFF字段类型
+static const quint16 TIFF_SHORT = 3;
+static const quint16 TIFF_LONG = 4;
+static const quint16 TIFF_LONG8 = 16;
+
+// 小端序写入辅助函数
+static void appendLE16(QByteArray& out, quint16 value)
+{
+    out.append(static_cast<char>(value & 0xFF));
+    out.append(static_cast<char>((value >> 8) & 0xFF));
+}
+
+static void appendLE32(QByteArray& out, quint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static void appendLE64(QByteArray& out, quint64 value)
+{
+    for (int i = 0; i < 8; ++i) {
+        out.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+TiffStreamWriter::TiffStreamWriter()
+{
+}
+
+TiffStreamWriter::~TiffStreamWriter()
+{
+    if (m_file.isOpen()) {
+        abort();
+    }
+}
+
+bool TiffStreamWriter::open(const QString& filePath, const QSize& size, bool hasAlpha, int rowsPerStrip)
+{
+    if (size.isEmpty()) {
+        return fail("图像尺寸无效");
+    }
+
+    m_size = size;
+    m_samplesPerPixel = hasAlpha ? 4 : 3;
+    m_rowsPerStrip = qMax(1, qMin(rowsPerStrip, size.height()));
+    m_currentRow = 0;
+    m_stripBuffer.clear();
+    m_stripOffsets.clear();
+    m_stripByteCounts.clear();
+    m_errorString.clear();
+
+    // 按PackBits最坏情况（每128字节多1字节）估算文件大小，超过经典TIFF的4GB上限时使用BigTIFF
+    const quint64 rowBytes = static_cast<quint64>(size.width()) * m_samplesPerPixel;
+    const quint64 worstCase = (rowBytes + rowBytes / 128 + 1) * static_cast<quint64>(size.height());
+    m_bigTiff = worstCase > 0xF0000000ULL;
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail(QString("无法打开文件 %1: %2").arg(filePath, m_file.errorString()));
+    }
+
+    // 文件头，IFD偏移在close()时回填
+    QByteArray header;
+    header.append("II", 2);
+    if (m_bigTiff) {
+        appendLE16(header, 43);
+        appendLE16(header, 8);
+        appendLE16(header, 0);
+        appendLE64(header, 0);
+    } else {
+        appendLE16(header, 42);
+        appendLE32(header, 0);
+    }
+    if (m_file.write(header) != header.size()) {
+        return fail("写入文件头失败");
+    }
+
+    Logger::debug(QString("TiffStreamWriter::open: %1 (%2x%3, %4通道, %5)")
+                  .arg(filePath).arg(size.width()).arg(size.height())
+                  .arg(m_samplesPerPixel).arg(m_bigTiff ? "BigTIFF" : "TIFF"));
+    return true;
+}
+
+bool TiffStreamWriter::writeScanline(const uchar* data)
+{
+    if (!m_file.isOpen() || !data) {
+        return false;
+    }
+    if (m_currentRow >= m_size.height()) {
+        return fail("写入的行数超过图像高度");
+    }
+
+    packBits(data, m_size.width() * m_samplesPerPixel, m_stripBuffer);
+    ++m_currentRow;
+
+    // 条带已满或到达最后一行时写出
+    if (m_currentRow % m_rowsPerStrip == 0 || m_currentRow == m_size.height()) {
+        return flushStrip();
+    }
+    return true;
+}
+
+bool TiffStreamWriter::close()
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    if (m_currentRow != m_size.height()) {
+        fail(QString("图像数据不完整: %1/%2 行").arg(m_currentRow).arg(m_size.height()));
+        abort();
+        return false;
+    }
+    if (!writeDirectory()) {
+        abort();
+        return false;
+    }
+    m_file.close();
+    return true;
+}
+
+void TiffStreamWriter::abort()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_file.remove();
+    m_stripBuffer.clear();
+}
+
+bool TiffStreamWriter::flushStrip()
+{
+    const quint64 offset = static_cast<quint64>(m_file.pos());
+    if (m_file.write(m_stripBuffer) != m_stripBuffer.size()) {
+        return fail("写入条带数据失败");
+    }
+    m_stripOffsets.push_back(offset);
+    m_stripByteCounts.push_back(static_cast<quint64>(m_stripBuffer.size()));
+    m_stripBuffer.clear();
+    return true;
+}
+
+bool TiffStreamWriter::writeDirectory()
+{
+    struct Field {
+        quint16 tag;
+        quint16 type;
+        quint64 count;
+        QByteArray data;
+    };
+
+    auto shortField = [](quint16 tag, const std::vector<quint16>& values) {
+        Field field{tag, TIFF_SHORT, values.size(), QByteArray()};
+        for (quint16 v : values) {
+            appendLE16(field.data, v);
+        }
+        return field;
+    };
+    auto longField = [](quint16 tag, quint32 value) {
+        Field field{tag, TIFF_LONG, 1, QByteArray()};
+        appendLE32(field.data, value);
+        return field;
+    };
+    auto offsetsField = [this](quint16 tag, const std::vector<quint64>& values) {
+        Field field{tag, m_bigTiff ? TIFF_LONG8 : TIFF_LONG, values.size(), QByteArray()};
+        for (quint64 v : values) {
+            if (m_bigTiff) {
+                appendLE64(field.data, v);
+            } else {
+                appendLE32(field.data, static_cast<quint32>(v));
+            }
+        }
+        return field;
+    };
+
+    // 字段必须按标签号升序排列
+    std::vector<Field> fields;
+    fields.push_back(longField(256, static_cast<quint32>(m_size.width())));          // ImageWidth
+    fields.push_back(longField(257, static_cast<quint32>(m_size.height())));         // ImageLength
+    fields.push_back(shortField(258, std::vector<quint16>(m_samplesPerPixel, 8)));  // BitsPerSample
+    fields.push_back(shortField(259, {32773}));                                      // Compression = PackBits
+    fields.push_back(shortField(262, {2}));                                          // Photometric = RGB
+    fields.push_back(offsetsField(273, m_stripOffsets));                             // StripOffsets
+    fields.push_back(shortField(277, {static_cast<quint16>(m_samplesPerPixel)}));    // SamplesPerPixel
+    fields.push_back(longField(278, static_cast<quint32>(m_rowsPerStrip)));          // RowsPerStrip
+    fields.push_back(offsetsField(279, m_stripByteCounts));                          // StripByteCounts
+    fields.push_back(shortField(284, {1}));                                          // PlanarConfig = 连续存储
+    if (m_samplesPerPixel == 4) {
+        fields.push_back(shortField(338, {2}));                                      // ExtraSamples = 非预乘Alpha
+    }
+
+    const int inlineSize = m_bigTiff ? 8 : 4;
+
+    // 先写放不进IFD条目的字段数据，记录其偏移
+    quint64 pos = static_cast<quint64>(m_file.pos());
+    if (pos % 2 != 0) {
+        m_file.write("\0", 1);
+        ++pos;
+    }
+    std::vector<quint64> dataOffsets(fields.size(), 0);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (fields[i].data.size() > inlineSize) {
+            dataOffsets[i] = pos;
+            if (m_file.write(fields[i].data) != fields[i].data.size()) {
+                return fail("写入IFD字段数据失败");
+            }
+            pos += fields[i].data.size();
+            if (pos % 2 != 0) {
+                m_file.write("\0", 1);
+                ++pos;
+            }
+        }
+    }
+
+    // 写入IFD
+    const quint64 ifdOffset = pos;
+    QByteArray ifd;
+    if (m_bigTiff) {
+        appendLE64(ifd, fields.size());
+    } else {
+        appendLE16(ifd, static_cast<quint16>(fields.size()));
+    }
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const Field& field = fields[i];
+        appendLE16(ifd, field.tag);
+        appendLE16(ifd, field.type);
+        if (m_bigTiff) {
+            appendLE64(ifd, field.count);
+        } else {
+            appendLE32(ifd, static_cast<quint32>(field.count));
+        }
+        if (field.data.size() > inlineSize) {
+            if (m_bigTiff) {
+                appendLE64(ifd, dataOffsets[i]);
+            } else {
+                appendLE32(ifd, static_cast<quint32>(dataOffsets[i]));
+            }
+        } else {
+            QByteArray value = field.data;
+            value.append(QByteArray(inlineSize - value.size(), '\0'));
+            ifd.append(value);
+        }
+    }
+    // 下一个IFD偏移为0，表示只有一个图像
+    if (m_bigTiff) {
+        appendLE64(ifd, 0);
+    } else {
+        appendLE32(ifd, 0);
+    }
+    if (m_file.write(ifd) != ifd.size()) {
+        return fail("写入IFD失败");
+    }
+
+    // 回填文件头中的IFD偏移
+    QByteArray offsetBytes;
+    if (m_bigTiff) {
+        appendLE64(offsetBytes, ifdOffset);
+        m_file.seek(8);
+    } else {
+        appendLE32(offsetBytes, static_cast<quint32>(ifdOffset));
+        m_file.seek(4);
+    }
+    if (m_file.write(offsetBytes) != offsetBytes.size()) {
+        return fail("回填IFD偏移失败");
+    }
+    return true;
+}
+
+bool TiffStreamWriter::fail(const QString& message)
+{
+    m_errorString = message;
+    Logger::error(QString("TiffStreamWriter: %1").arg(message));
+    return false;
+}
+
+void TiffStreamWriter::packBits(const uchar* data, int length, QByteArray& out)
+{
+    int i = 0;
+    while (i < length) {
+        // 重复串：最多128个相同字节编码为 (1-n, 值)
+        int run = 1;
+        while (i + run < length && run < 128 && data[i + run] == data[i]) {
+            ++run;
+        }
+        if (run >= 2) {
+            out.append(static_cast<char>(1 - run));
+            out.append(static_cast<char>(data[i]));
+            i += run;
+            continue;
+        }
+
+        // 字面串：直到遇到至少3个相同字节为止，最多128个字节编码为 (n-1, 数据...)
+        const int start = i;
+        int literal = 0;
+        while (i < length && literal < 128) {
+            if (i + 2 < length && data[i] == data[i + 1] && data[i] == data[i + 2]) {
+                break;
+            }
+            ++i;
+            ++literal;
+        }
+        out.append(static_cast<char>(literal - 1));
+        out.append(reinterpret_cast<const char*>(data + start), literal);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef TIFF_STREAM_WRITER_H
+#define TIFF_STREAM_WRITER_H
+
+#include <QFile>
+#include <QSize>
+#include <QString>
+#include <QByteArray>
+#include <vector>
+
+/**
+ * @brief 流式TIFF写入器
+ *
+ * 按扫描线顺序逐行写入8位RGB/RGBA图像，每满一个条带(strip)即以PackBits压缩后落盘，
+ * 关闭时再写入IFD目录。内存占用只有一个条带，适合导出无法整体放入内存的超大图像。
+ * 文件可能超过4GB时自动使用BigTIFF格式。
+ */
+class TiffStreamWriter {
+public:
+    TiffStreamWriter();
+    ~TiffStreamWriter();
+
+    TiffStreamWriter(const TiffStreamWriter&) = delete;
+    TiffStreamWriter& operator=(const TiffStreamWriter&) = delete;
+
+    /**
+     * @brief 打开文件并写入文件头
+     * @param filePath 输出路径
+     * @param size 图像尺寸
+     * @param hasAlpha 为true时写入RGBA（非预乘Alpha），否则写入RGB
+     * @param rowsPerStrip 每个条带的行数
+     * @return 是否成功
+     */
+    bool open(const QString& filePath, const QSize& size, bool hasAlpha, int rowsPerStrip = 64);
+
+    /**
+     * @brief 写入一条扫描线
+     * @param data 长度为 width * samplesPerPixel() 字节的像素数据（RGB888或RGBA8888字节序）
+     * @return 是否成功
+     */
+    bool writeScanline(const uchar* data);
+
+    /**
+     * @brief 写入剩余条带和IFD目录并关闭文件
+     * @return 是否成功（行数不足时返回false）
+     */
+    bool close();
+
+    /**
+     * @brief 放弃写入并删除未完成的文件
+     */
+    void abort();
+
+    // 每个像素的字节数（RGB为3，RGBA为4）
+    int samplesPerPixel() const { return m_samplesPerPixel; }
+
+    // 已写入的行数
+    int rowsWritten() const { return m_currentRow; }
+
+    QString errorString() const { return m_errorString; }
+
+private:
+    QFile m_file;
+    QSize m_size;
+    int m_samplesPerPixel = 3;
+    int m_rowsPerStrip = 64;
+    int m_currentRow = 0;
+    bool m_bigTiff = false;
+    QString m_errorString;
+
+    QByteArray m_stripBuffer;                // 当前条带的压缩数据
+    std::vector<quint64> m_stripOffsets;     // 各条带在文件中的偏移
+    std::vector<quint64> m_stripByteCounts;  // 各条带的压缩后字节数
+
+    bool flushStrip();
+    bool writeDirectory();
+    bool fail(const QString& message);
+
+    // PackBits压缩一行数据并追加到out
+    static void packBits(const uchar* data, int length, QByteArray& out);
+};
+
+#endif // TIFF_STREAM_WRITER_H